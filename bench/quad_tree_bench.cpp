@@ -0,0 +1,272 @@
+// times quad tree builds and queries against the node per allocation layout quad_tree.h used to have, and checks
+// that both trees return the same objects in the same order. build it with `make bench_quad_tree`
+
+#include "quad_tree.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct BenchObject_t{
+     S16 x;
+     S16 y;
+};
+
+S16 get_object_x(BenchObject_t* object){ return object->x; }
+S16 get_object_y(BenchObject_t* object){ return object->y; }
+
+// the old layout, every node calloc'd on its own with pointers to its children
+struct LegacyNode_t{
+     BenchObject_t* entries[QUAD_TREE_NODE_ENTRY_COUNT];
+     S8 entry_count;
+
+     Rect_t bounds;
+
+     LegacyNode_t* bottom_left;
+     LegacyNode_t* bottom_right;
+     LegacyNode_t* top_left;
+     LegacyNode_t* top_right;
+};
+
+bool legacy_insert(LegacyNode_t* node, BenchObject_t* object);
+
+bool legacy_subdivide(LegacyNode_t* node){
+     if(node->bounds.left == node->bounds.right && node->bounds.bottom == node->bounds.top) return false;
+
+     node->bottom_left = (LegacyNode_t*)(calloc(1, sizeof(*node)));
+     node->bottom_right = (LegacyNode_t*)(calloc(1, sizeof(*node)));
+     node->top_left = (LegacyNode_t*)(calloc(1, sizeof(*node)));
+     node->top_right = (LegacyNode_t*)(calloc(1, sizeof(*node)));
+     if(!node->bottom_left || !node->bottom_right || !node->top_left || !node->top_right) return false;
+
+     S16 half_width = (node->bounds.right - node->bounds.left) / (S16)(2);
+     S16 half_height = (node->bounds.top - node->bounds.bottom) / (S16)(2);
+
+     node->bottom_left->bounds = Rect_t{node->bounds.left, node->bounds.bottom,
+                                        (S16)(node->bounds.left + half_width), (S16)(node->bounds.bottom + half_height)};
+     node->bottom_right->bounds = Rect_t{(S16)(node->bottom_left->bounds.right + 1), node->bounds.bottom,
+                                         node->bounds.right, (S16)(node->bounds.bottom + half_height)};
+     node->top_left->bounds = Rect_t{node->bounds.left, (S16)(node->bottom_left->bounds.top + 1),
+                                     (S16)(node->bounds.left + half_width), node->bounds.top};
+     node->top_right->bounds = Rect_t{node->bottom_right->bounds.left, (S16)(node->bottom_left->bounds.top + 1),
+                                      node->bottom_right->bounds.right, node->bounds.top};
+
+     for(S8 i = 0; i < node->entry_count; i++){
+          if(legacy_insert(node->bottom_left, node->entries[i])) continue;
+          if(legacy_insert(node->bottom_right, node->entries[i])) continue;
+          if(legacy_insert(node->top_left, node->entries[i])) continue;
+          if(legacy_insert(node->top_right, node->entries[i])) continue;
+     }
+
+     node->entry_count = 0;
+     return true;
+}
+
+bool legacy_insert(LegacyNode_t* node, BenchObject_t* object){
+     if(!xy_in_rect(node->bounds, object->x, object->y)) return false;
+
+     if(!(node->entry_count == 0 && node->bottom_left) && node->entry_count < QUAD_TREE_NODE_ENTRY_COUNT){
+          node->entries[node->entry_count] = object;
+          node->entry_count++;
+          return true;
+     }
+
+     if(!node->bottom_left){
+          if(!legacy_subdivide(node)) return false;
+     }
+
+     if(legacy_insert(node->bottom_left, object)) return true;
+     if(legacy_insert(node->bottom_right, object)) return true;
+     if(legacy_insert(node->top_left, object)) return true;
+     if(legacy_insert(node->top_right, object)) return true;
+
+     return true;
+}
+
+LegacyNode_t* legacy_build(ObjectArray_t<BenchObject_t>* array){
+     auto* root = (LegacyNode_t*)(calloc(1, sizeof(LegacyNode_t)));
+     root->bounds = Rect_t{array->elements[0].x, array->elements[0].y, array->elements[0].x, array->elements[0].y};
+
+     for(int i = 0; i < array->count; i++){
+          auto* object = array->elements + i;
+          if(root->bounds.left > object->x) root->bounds.left = object->x;
+          if(root->bounds.right < object->x) root->bounds.right = object->x;
+          if(root->bounds.bottom > object->y) root->bounds.bottom = object->y;
+          if(root->bounds.top < object->y) root->bounds.top = object->y;
+     }
+
+     for(int i = 0; i < array->count; i++){
+          if(!legacy_insert(root, array->elements + i)) break;
+     }
+
+     return root;
+}
+
+void legacy_find_in(LegacyNode_t* node, Rect_t rect, BenchObject_t** results, S32* result_count){
+     if(!rect_in_rect(rect, node->bounds) && !rect_in_rect(node->bounds, rect)) return;
+
+     for(S8 i = 0; i < node->entry_count; i++){
+          if(xy_in_rect(rect, node->entries[i]->x, node->entries[i]->y)) results[(*result_count)++] = node->entries[i];
+     }
+
+     if(node->bottom_left){
+          legacy_find_in(node->bottom_left, rect, results, result_count);
+          legacy_find_in(node->bottom_right, rect, results, result_count);
+          legacy_find_in(node->top_left, rect, results, result_count);
+          legacy_find_in(node->top_right, rect, results, result_count);
+     }
+}
+
+BenchObject_t* legacy_find_at(LegacyNode_t* node, S16 x, S16 y){
+     if(!xy_in_rect(node->bounds, x, y)) return nullptr;
+
+     for(S8 i = 0; i < node->entry_count; i++){
+          if(node->entries[i]->x == x && node->entries[i]->y == y) return node->entries[i];
+     }
+
+     if(node->bottom_left){
+          BenchObject_t* result = legacy_find_at(node->bottom_left, x, y);
+          if(result) return result;
+          result = legacy_find_at(node->bottom_right, x, y);
+          if(result) return result;
+          result = legacy_find_at(node->top_left, x, y);
+          if(result) return result;
+          return legacy_find_at(node->top_right, x, y);
+     }
+
+     return nullptr;
+}
+
+void legacy_free(LegacyNode_t* node){
+     if(!node) return;
+     legacy_free(node->bottom_left);
+     legacy_free(node->bottom_right);
+     legacy_free(node->top_left);
+     legacy_free(node->top_right);
+     free(node);
+}
+
+#define BENCH_MAP_SIZE 1024 // in pixels
+#define BENCH_QUERY_COUNT 200000
+#define BENCH_QUERY_MAX_SIZE 64
+#define BENCH_BUILD_COUNT 200
+
+static double now_seconds(){
+     timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return (double)(ts.tv_sec) + (double)(ts.tv_nsec) / 1000000000.0;
+}
+
+static Rect_t random_query_rect(){
+     S16 left = (S16)(rand() % BENCH_MAP_SIZE);
+     S16 bottom = (S16)(rand() % BENCH_MAP_SIZE);
+     return Rect_t{left, bottom, (S16)(left + rand() % BENCH_QUERY_MAX_SIZE), (S16)(bottom + rand() % BENCH_QUERY_MAX_SIZE)};
+}
+
+static bool bench(S32 object_count){
+     ObjectArray_t<BenchObject_t> objects;
+     if(!init(&objects, object_count)) return false;
+
+     srand(object_count);
+     for(S32 i = 0; i < objects.count; i++){
+          objects.elements[i].x = (S16)(rand() % BENCH_MAP_SIZE);
+          objects.elements[i].y = (S16)(rand() % BENCH_MAP_SIZE);
+     }
+
+     double start = now_seconds();
+     for(S32 i = 0; i < BENCH_BUILD_COUNT; i++) legacy_free(legacy_build(&objects));
+     double legacy_build_time = now_seconds() - start;
+
+     start = now_seconds();
+     for(S32 i = 0; i < BENCH_BUILD_COUNT; i++) quad_tree_free(quad_tree_build(&objects));
+     double pooled_build_time = now_seconds() - start;
+
+     LegacyNode_t* legacy = legacy_build(&objects);
+     QuadTreeNode_t<BenchObject_t>* pooled = quad_tree_build(&objects);
+
+     auto** legacy_results = (BenchObject_t**)(malloc(object_count * sizeof(BenchObject_t*)));
+     Rect_t* rects = (Rect_t*)(malloc(BENCH_QUERY_COUNT * sizeof(Rect_t)));
+     for(S32 i = 0; i < BENCH_QUERY_COUNT; i++) rects[i] = random_query_rect();
+
+     // the results have to match, in order, before the timings mean anything
+     S32 mismatches = 0;
+     for(S32 i = 0; i < BENCH_QUERY_COUNT; i += 100){
+          S32 legacy_count = 0;
+          legacy_find_in(legacy, rects[i], legacy_results, &legacy_count);
+
+          S32 pooled_count = 0;
+          auto query = quad_tree_query(pooled, rects[i]);
+          while(BenchObject_t* object = quad_tree_query_next(&query)){
+               if(pooled_count >= legacy_count || legacy_results[pooled_count] != object) mismatches++;
+               pooled_count++;
+          }
+          if(pooled_count != legacy_count) mismatches++;
+
+          if(legacy_find_at(legacy, rects[i].left, rects[i].bottom) !=
+             quad_tree_find_at(pooled, rects[i].left, rects[i].bottom)) mismatches++;
+     }
+
+     S64 legacy_found = 0;
+     start = now_seconds();
+     for(S32 i = 0; i < BENCH_QUERY_COUNT; i++){
+          S32 legacy_count = 0;
+          legacy_find_in(legacy, rects[i], legacy_results, &legacy_count);
+          legacy_found += legacy_count;
+     }
+     double legacy_query_time = now_seconds() - start;
+
+     S64 pooled_found = 0;
+     start = now_seconds();
+     for(S32 i = 0; i < BENCH_QUERY_COUNT; i++){
+          auto query = quad_tree_query(pooled, rects[i]);
+          while(quad_tree_query_next(&query)) pooled_found++;
+     }
+     double pooled_query_time = now_seconds() - start;
+
+     S64 legacy_hits = 0;
+     start = now_seconds();
+     for(S32 i = 0; i < BENCH_QUERY_COUNT; i++){
+          if(legacy_find_at(legacy, rects[i].left, rects[i].bottom)) legacy_hits++;
+     }
+     double legacy_find_at_time = now_seconds() - start;
+
+     S64 pooled_hits = 0;
+     start = now_seconds();
+     for(S32 i = 0; i < BENCH_QUERY_COUNT; i++){
+          if(quad_tree_find_at(pooled, rects[i].left, rects[i].bottom)) pooled_hits++;
+     }
+     double pooled_find_at_time = now_seconds() - start;
+
+     if(legacy_found != pooled_found || legacy_hits != pooled_hits) mismatches++;
+
+     printf("%6d objects: build %7.3fms -> %7.3fms, find in %7.3fms -> %7.3fms, find at %7.3fms -> %7.3fms%s\n",
+            object_count,
+            legacy_build_time * 1000.0 / BENCH_BUILD_COUNT, pooled_build_time * 1000.0 / BENCH_BUILD_COUNT,
+            legacy_query_time * 1000.0, pooled_query_time * 1000.0,
+            legacy_find_at_time * 1000.0, pooled_find_at_time * 1000.0,
+            mismatches ? " RESULTS DIFFER" : "");
+
+     free(rects);
+     free(legacy_results);
+     quad_tree_free(pooled);
+     legacy_free(legacy);
+     destroy(&objects);
+     return mismatches == 0;
+}
+
+int main(){
+     Log_t::create("quad_tree_bench.log");
+
+     printf("legacy -> pooled, %d queries of up to %dx%d pixels\n", BENCH_QUERY_COUNT, BENCH_QUERY_MAX_SIZE,
+            BENCH_QUERY_MAX_SIZE);
+
+     bool same = true;
+     S32 object_counts[] = {64, 256, 1024, 4096, 16384};
+     for(S32 object_count : object_counts){
+          if(!bench(object_count)) same = false;
+     }
+
+     Log_t::destroy();
+     return same ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+// times world snapshot captures and restores, and checks that stepping a restored world gives exactly the state the
+// original steps gave. build it with `make bench_world_snapshot`
+
+#include "world.h"
+#include "world_step.h"
+#include "world_snapshot.h"
+#include "block_utils.h"
+#include "conversion.h"
+#include "defines.h"
+#include "tags.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MAP_SIZE 64
+#define BENCH_BLOCK_SPACING 3
+#define BENCH_STEP_COUNT 120
+#define BENCH_ITERATIONS 20000
+
+static double now_seconds(){
+     timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return (double)(ts.tv_sec) + (double)(ts.tv_nsec) / 1000000000.0;
+}
+
+static bool build_world(World_t* world, Undo_t* undo, Camera_t* camera){
+     if(!init(&world->tilemap, BENCH_MAP_SIZE, BENCH_MAP_SIZE)) return false;
+     for(S16 y = 0; y < BENCH_MAP_SIZE; y++){
+          for(S16 x = 0; x < BENCH_MAP_SIZE; x++){
+               Tile_t* tile = world->tilemap.tiles[y] + x;
+               tile->light = BASE_LIGHT;
+               if(x == 0 || y == 0 || x == BENCH_MAP_SIZE - 1 || y == BENCH_MAP_SIZE - 1) tile->id = TILE_ID_SOLID_START;
+          }
+     }
+
+     // a grid of blocks with a pressure plate between every few of them
+     S16 per_row = (BENCH_MAP_SIZE - 4) / BENCH_BLOCK_SPACING;
+     if(!init(&world->blocks, per_row * per_row)) return false;
+     if(!init(&world->interactives, per_row)) return false;
+
+     for(S16 i = 0; i < world->blocks.count; i++){
+          Block_t* block = world->blocks.elements + i;
+          *block = Block_t{};
+          block->pos = coord_to_pos(Coord_t{(S16)(3 + (i % per_row) * BENCH_BLOCK_SPACING), (S16)(3 + (i / per_row) * BENCH_BLOCK_SPACING)});
+          block->element = (i % 5 == 0) ? ELEMENT_ICE : ELEMENT_NONE;
+          block->entangle_index = -1;
+     }
+
+     for(S16 i = 0; i < world->interactives.count; i++){
+          Interactive_t* interactive = world->interactives.elements + i;
+          interactive->type = INTERACTIVE_TYPE_PRESSURE_PLATE;
+          interactive->coord = Coord_t{(S16)(4 + i * BENCH_BLOCK_SPACING), 4};
+     }
+
+     reset_map(Coord_t{2, 2}, world, undo, camera);
+     return true;
+}
+
+static void step_world(World_t* world, FrameContext_t* context, S32 step_count){
+     PlayerAction_t player_action {};
+     for(S32 f = 0; f < step_count; f++){
+          quad_tree_free(world->block_qt);
+          world->block_qt = quad_tree_build(&world->blocks);
+
+          // walk right into the first block, then up along the column
+          player_action.last_activate = player_action.activate;
+          player_action.move[DIRECTION_RIGHT] = f < step_count / 2;
+          player_action.move[DIRECTION_UP] = f >= step_count / 2;
+
+          world_step(world, &player_action, context);
+     }
+}
+
+static bool snapshots_match(WorldSnapshot_t* a, WorldSnapshot_t* b){
+     return a->size == b->size && memcmp(a->buffer, b->buffer, a->size) == 0;
+}
+
+int main(){
+     Log_t::create("world_snapshot_bench.log");
+
+     World_t world {};
+     Undo_t undo {};
+     Camera_t camera {};
+     if(!build_world(&world, &undo, &camera)) return 1;
+
+     FrameContext_t context {};
+     context.undo = &undo;
+
+     WorldSnapshot_t start {};
+     WorldSnapshot_t stepped {};
+     WorldSnapshot_t check {};
+
+     if(!world_snapshot_capture(&start, &world)) return 1;
+
+     step_world(&world, &context, BENCH_STEP_COUNT);
+     world_snapshot_capture(&stepped, &world);
+
+     bool same = true;
+
+     world_snapshot_restore(&start, &world);
+     world_snapshot_capture(&check, &world);
+     if(!snapshots_match(&start, &check)){
+          printf("restoring then capturing doesn't give back the captured state\n");
+          same = false;
+     }
+
+     // the restored world steps to the same place, which needs the quad trees the restore threw out
+     step_world(&world, &context, BENCH_STEP_COUNT);
+     world_snapshot_capture(&check, &world);
+     if(!snapshots_match(&stepped, &check)){
+          printf("stepping a restored world ends up somewhere else\n");
+          same = false;
+     }
+
+     double start_time = now_seconds();
+     for(S32 i = 0; i < BENCH_ITERATIONS; i++) world_snapshot_capture(&check, &world);
+     double capture_time = now_seconds() - start_time;
+
+     start_time = now_seconds();
+     for(S32 i = 0; i < BENCH_ITERATIONS; i++) world_snapshot_restore(&start, &world);
+     double restore_time = now_seconds() - start_time;
+
+     double kilobytes = (double)(start.size) / 1024.0;
+     printf("%d blocks, %d interactives, %dx%d tiles: %.1fKB per snapshot\n", world.blocks.count,
+            world.interactives.count, world.tilemap.width, world.tilemap.height, kilobytes);
+     printf("capture %.3fus (%.3fus per KB), restore %.3fus (%.3fus per KB)%s\n",
+            capture_time * 1000000.0 / BENCH_ITERATIONS, capture_time * 1000000.0 / BENCH_ITERATIONS / kilobytes,
+            restore_time * 1000000.0 / BENCH_ITERATIONS, restore_time * 1000000.0 / BENCH_ITERATIONS / kilobytes,
+            same ? "" : " STATE DIFFERS");
+
+     destroy(&start);
+     destroy(&stepped);
+     destroy(&check);
+
+     destroy(&world);
+     block_portal_cache_free();
+     destroy(&undo);
+
+     Log_t::destroy();
+     return same ? 0 : 1;
+}
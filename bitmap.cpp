@@ -73,6 +73,47 @@ Bitmap_t bitmap_load_from_file(const char* filepath){
      return bitmap;
 }
 
+Bitmap_t bitmap_create(S32 width, S32 height){
+     Bitmap_t bitmap;
+     memset(&bitmap, 0, sizeof(bitmap));
+
+     U32 pixel_size = (U32)(width * height) * sizeof(BitmapPixel_t);
+     U32 pixel_offset = sizeof(BitmapFileHeader_t) + sizeof(BitmapInfoHeader_t);
+
+     bitmap.raw.byte_count = pixel_offset + pixel_size;
+     bitmap.raw.bytes = (U8*)(malloc(bitmap.raw.byte_count));
+     if(!bitmap.raw.bytes){
+          LOG("%s() failed: failed to allocate %" PRIu64 " bytes for bitmap\n", __FUNCTION__, bitmap.raw.byte_count);
+          bitmap.raw.byte_count = 0;
+          return bitmap;
+     }
+
+     bitmap.header = (BitmapFileHeader_t*)(bitmap.raw.bytes);
+     bitmap.info = (BitmapInfoHeader_t*)(bitmap.raw.bytes + sizeof(BitmapFileHeader_t));
+     bitmap.pixels = (BitmapPixel_t*)(bitmap.raw.bytes + pixel_offset);
+
+     bitmap.header->file_type[0] = 'B';
+     bitmap.header->file_type[1] = 'M';
+     bitmap.header->file_size = pixel_size + pixel_offset;
+     bitmap.header->reserved_1 = 0;
+     bitmap.header->reserved_2 = 0;
+     bitmap.header->bitmap_offset = pixel_offset;
+
+     bitmap.info->size = BITMAP_SUPPORTED_SIZE;
+     bitmap.info->width = width;
+     bitmap.info->height = height;
+     bitmap.info->planes = 1;
+     bitmap.info->bit_count = 24;
+     bitmap.info->compression = 0;
+     bitmap.info->size_image = pixel_size;
+     bitmap.info->x_pels_per_meter = 2835;
+     bitmap.info->y_pels_per_meter = 2835;
+     bitmap.info->clr_used = 0;
+     bitmap.info->clr_important = 0;
+
+     return bitmap;
+}
+
 AlphaBitmap_t bitmap_to_alpha_bitmap(const Bitmap_t* bitmap, BitmapPixel_t color_key){
      AlphaBitmap_t alpha_bitmap {};
 
@@ -107,3 +148,36 @@ AlphaBitmap_t bitmap_to_alpha_bitmap(const Bitmap_t* bitmap, BitmapPixel_t color
 
      return alpha_bitmap;
 }
+
+static U32 bitmap_swap_red_blue(U32 rgba){
+     return ((rgba & 0xFF) << 16) | (rgba & 0xFF00) | ((rgba >> 16) & 0xFF);
+}
+
+void bitmap_swizzle_rgba_to_file_order(const U8* rgba, BitmapPixel_t* pixels, S32 pixel_count){
+     U8* dst = (U8*)(pixels);
+
+     // 4 rgba pixels pack into 3 words of blue, green, red, this loop has no dependencies between iterations so the
+     // compiler turns it into simd in optimized builds. assumes a little endian machine.
+     S32 block_count = pixel_count / 4;
+     for(S32 i = 0; i < block_count; i++){
+          U32 src_words[4];
+          memcpy(src_words, rgba + i * 16, sizeof(src_words));
+
+          U32 bgr_0 = bitmap_swap_red_blue(src_words[0]);
+          U32 bgr_1 = bitmap_swap_red_blue(src_words[1]);
+          U32 bgr_2 = bitmap_swap_red_blue(src_words[2]);
+          U32 bgr_3 = bitmap_swap_red_blue(src_words[3]);
+
+          U32 dst_words[3];
+          dst_words[0] = bgr_0 | (bgr_1 << 24);
+          dst_words[1] = (bgr_1 >> 8) | (bgr_2 << 16);
+          dst_words[2] = (bgr_2 >> 16) | (bgr_3 << 8);
+          memcpy(dst + i * 12, dst_words, sizeof(dst_words));
+     }
+
+     for(S32 i = block_count * 4; i < pixel_count; i++){
+          pixels[i].red = rgba[i * 4 + 2];
+          pixels[i].green = rgba[i * 4 + 1];
+          pixels[i].blue = rgba[i * 4 + 0];
+     }
+}
@@ -54,6 +54,10 @@ struct Bitmap_t{
 Bitmap_t bitmap_load_raw(const U8* bytes, U64 byte_count);
 Bitmap_t bitmap_load_from_file(const char* filepath);
 
+// allocates a 24 bit bitmap file in raw with the headers filled out, the caller fills in the pixels which
+// are in file order (blue, green, red) rather than the swapped order we use after loading
+Bitmap_t bitmap_create(S32 width, S32 height);
+
 struct AlphaBitmap_t{
      AlphaBitmapPixel_t* pixels = nullptr;
      S32 width = 0;
@@ -61,3 +65,6 @@ struct AlphaBitmap_t{
 };
 
 AlphaBitmap_t bitmap_to_alpha_bitmap(const Bitmap_t* bitmap, BitmapPixel_t color_key);
+
+// converts tightly packed rgba bytes to the blue, green, red order that bitmap files store
+void bitmap_swizzle_rgba_to_file_order(const U8* rgba, BitmapPixel_t* pixels, S32 pixel_count);
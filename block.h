@@ -39,6 +39,7 @@ struct Block_t : public GridMotion_t{
      Element_t       element;
      F32             fall_time;
      S16             entangle_index; // -1 means not entangled, 0 - N = entangled with that block
+     S16             entangle_group = -1; // set by entangle_table_build(), blocks in the same ring share it
      U8              rotation; // one day we will use this !
 
      Coord_t         clone_start; // the portal where the clone started
@@ -76,6 +77,10 @@ struct Block_t : public GridMotion_t{
 
      S16 previous_mass;
 
+     // see block_sleep.h
+     bool at_rest = false;
+     bool asleep = false;
+
      ConnectedTeleport_t connected_teleport;
 };
 
@@ -0,0 +1,95 @@
+#include "block_sleep.h"
+#include "world.h"
+#include "utils.h"
+
+#include <math.h>
+
+// -0.0f compares equal to 0.0f, but the movement passes would turn it into 0.0f, so only a positive zero is resting
+static bool is_resting_zero(F32 value){
+     return value == 0.0f && !signbit(value);
+}
+
+static bool is_resting_zero(Vec_t vec){
+     return is_resting_zero(vec.x) && is_resting_zero(vec.y);
+}
+
+// true when running the movement passes on the block would leave it exactly as it is
+static bool block_resting(World_t* world, Block_t* block){
+     if(block->pos.z != 0) return false;
+     if(!is_resting_zero(block->vel) || !is_resting_zero(block->prev_vel) || !is_resting_zero(block->accel) ||
+        !is_resting_zero(block->pos_delta)) return false;
+     if(block->horizontal_move.state != MOVE_STATE_IDLING || block->vertical_move.state != MOVE_STATE_IDLING) return false;
+     if(block->held_up != BLOCK_HELD_BY_NONE) return false;
+     if(block->coast_horizontal != BLOCK_COAST_NONE || block->coast_vertical != BLOCK_COAST_NONE) return false;
+     if(block->teleport || block->teleport_split) return false;
+     if(block->cur_push_mask != DIRECTION_MASK_NONE || block->prev_push_mask != DIRECTION_MASK_NONE) return false;
+     if(block->stop_on_pixel_x != 0 || block->stop_on_pixel_y != 0) return false;
+     if(block->entangle_index >= 0 || block->entangle_group >= 0 || block->clone_start.x != 0) return false;
+
+     // anything stacked on top changes the stack mass the first pass tracks
+     if(block->previous_mass != block_get_mass(block)) return false;
+
+     // popups, pits and portals all act on blocks sitting over them and ice sends them coasting
+     Coord_t rect_coords[4];
+     get_rect_coords(block_get_inclusive_rect(block), rect_coords);
+     for(S8 c = 0; c < 4; c++){
+          if(quad_tree_interactive_find_at(world->interactive_qt, rect_coords[c])) return false;
+          if(tilemap_is_iced(&world->tilemap, rect_coords[c])) return false;
+     }
+
+     return true;
+}
+
+void block_sleep_update(World_t* world){
+     auto* sleep = &world->block_sleep;
+     sleep->asleep_count = 0;
+
+     // a portal turning on or off changes where things teleport to, which we don't track per block
+     if(sleep->portal_exit_generation != world->tilemap.portal_exit_generation){
+          sleep->portal_exit_generation = world->tilemap.portal_exit_generation;
+          block_sleep_wake_all(world);
+          return;
+     }
+
+     for(S16 i = 0; i < world->blocks.count; i++){
+          auto* block = world->blocks.elements + i;
+          if(block->asleep){
+               sleep->asleep_count++;
+               continue;
+          }
+
+          // only sleep if the last time the passes ran on the block it was already resting
+          bool resting = block_resting(world, block);
+          block->asleep = resting && block->at_rest;
+          block->at_rest = resting;
+          if(block->asleep) sleep->asleep_count++;
+     }
+}
+
+// it still counts as having rested, the passes run on it from here on and it sleeps again next update if they leave it
+// resting
+void block_sleep_wake(Block_t* block){
+     block->asleep = false;
+}
+
+void block_sleep_wake_around(World_t* world, Block_t* block){
+     block_sleep_wake(block);
+     block_sleep_wake_at(world, block_get_coord(block));
+}
+
+// sleeping blocks never move, so the tree always has them where they are
+void block_sleep_wake_at(World_t* world, Coord_t coord){
+     auto query = quad_tree_query(world->block_qt, rect_surrounding_adjacent_coords(coord));
+     while(Block_t* block = quad_tree_query_next(&query)){
+          block_sleep_wake(block);
+     }
+}
+
+void block_sleep_wake_all(World_t* world){
+     for(S16 i = 0; i < world->blocks.count; i++){
+          world->blocks.elements[i].asleep = false;
+          world->blocks.elements[i].at_rest = false;
+     }
+
+     world->block_sleep.asleep_count = 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "types.h"
+
+struct World_t;
+
+// blocks sitting still on the floor, away from anything that could change that, are put to sleep and skipped by the
+// movement passes, which would only compute the same values they computed last frame. a block has to have rested
+// through one frame of those passes before it can sleep. nothing goes looking for reasons to wake it back up, whatever
+// changes a block or a tile wakes the sleeping blocks it could affect right then, so the passes still to run that
+// frame see them: pushing a block wakes it, a block moving, falling, being raised or changing element wakes the blocks
+// around it and a tile or interactive changing wakes the blocks on and around it
+
+struct BlockSleep_t{
+     U32 portal_exit_generation = 0;
+
+     S16 asleep_count = 0;
+};
+
+struct Block_t;
+struct Coord_t;
+
+// call once per update before the block movement passes, puts blocks that rested through the last one to sleep
+void block_sleep_update(World_t* world);
+
+void block_sleep_wake(Block_t* block);
+
+// call where a block's position, element or cut changes
+void block_sleep_wake_around(World_t* world, Block_t* block);
+
+// call where a tile or the interactive on it changes
+void block_sleep_wake_at(World_t* world, Coord_t coord);
+
+// call after anything rewrites blocks wholesale (loading, undo), every block has to rest again before it sleeps
+void block_sleep_wake_all(World_t* world);
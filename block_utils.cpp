@@ -4,10 +4,12 @@
 #include "conversion.h"
 #include "portal_exit.h"
 #include "tags.h"
+#include "log.h"
 
 #include <float.h>
 #include <math.h>
 #include <string.h>
+#include <stdlib.h>
 
 void add_block_held(BlockHeldResult_t* result, Block_t* block, Rect_t rect){
      if(result->count < MAX_HELD_BLOCKS){
@@ -187,16 +189,6 @@ bool block_against_block(Position_t pos, BlockCut_t cut, Block_t* check_block, B
      return false;
 }
 
-Block_t* block_against_block_in_list(Position_t pos, BlockCut_t cut, Block_t** blocks, S16 block_count, Direction_t direction, Position_t* portal_offsets){
-     for(S16 i = 0; i < block_count; i++){
-          if(block_against_block(pos, cut, blocks[i], blocks[i]->cut, direction, portal_offsets[i])){
-              return blocks[i];
-          }
-     }
-
-     return nullptr;
-}
-
 BlockAgainstOthersResult_t block_against_other_blocks(Position_t pos, BlockCut_t cut, Direction_t direction, QuadTreeNode_t<Block_t>* block_qt,
                                                       QuadTreeNode_t<Interactive_t>* interactive_qt, TileMap_t* tilemap){
      BlockAgainstOthersResult_t result;
@@ -204,31 +196,26 @@ BlockAgainstOthersResult_t block_against_other_blocks(Position_t pos, BlockCut_t
      auto block_center = block_get_center(pos, cut);
      Rect_t surrounding_rect = rect_to_check_surrounding_blocks(block_center.pixel);
 
-     Position_t portal_offsets[MAX_BLOCKS_FOUND_THROUGH_PORTALS];
-     memset(portal_offsets, 0, sizeof(portal_offsets));
-
-     S16 block_count = 0;
-     Block_t* blocks[MAX_BLOCKS_FOUND_THROUGH_PORTALS];
-     quad_tree_find_in(block_qt, surrounding_rect, blocks, &block_count, MAX_BLOCKS_FOUND_THROUGH_PORTALS);
+     Position_t no_portal_offset;
+     memset(&no_portal_offset, 0, sizeof(no_portal_offset));
 
-     for(S16 i = 0; i < block_count; i++){
-          // lol at me misusing this function, but watevs
-          if(block_against_block_in_list(pos, cut, blocks + i, 1, direction, portal_offsets)){
+     auto query = quad_tree_query(block_qt, surrounding_rect);
+     while(Block_t* block = quad_tree_query_next(&query)){
+          if(block_against_block(pos, cut, block, block->cut, direction, no_portal_offset)){
                BlockAgainstOther_t against_other;
-               against_other.block = blocks[i];
+               against_other.block = block;
                result.add(against_other);
           }
      }
 
-     auto found_blocks = find_blocks_through_portals(pos_to_coord(pos), tilemap, interactive_qt, block_qt);
-     for(S16 i = 0; i < found_blocks.count; i++){
-         auto* found_block = found_blocks.blocks + i;
-         blocks[i] = found_block->block;
-         portal_offsets[i] = found_block->position - found_block->block->pos;
+     auto* found_blocks = find_blocks_through_portals(pos_to_coord(pos), tilemap, interactive_qt, block_qt);
+     for(S16 i = 0; i < found_blocks->count; i++){
+         auto* found_block = found_blocks->blocks + i;
+         auto portal_offset = found_block->position - found_block->block->pos;
 
-         if(block_against_block(pos, cut, blocks[i], found_block->rotated_cut, direction, portal_offsets[i])){
+         if(block_against_block(pos, cut, found_block->block, found_block->rotated_cut, direction, portal_offset)){
               BlockAgainstOther_t against_other;
-              against_other.block = blocks[i];
+              against_other.block = found_block->block;
               against_other.rotations_through_portal = found_block->rotations_between_portals;
               result.add(against_other);
          }
@@ -242,27 +229,26 @@ Block_t* block_against_another_block(Position_t pos, BlockCut_t cut, Direction_t
      auto block_center = block_get_center(pos, cut);
      Rect_t rect = rect_to_check_surrounding_blocks(block_center.pixel);
 
-     S16 block_count = 0;
-     Block_t* blocks[BLOCK_QUAD_TREE_MAX_QUERY];
-     quad_tree_find_in(block_qt, rect, blocks, &block_count, BLOCK_QUAD_TREE_MAX_QUERY);
+     Position_t no_portal_offset;
+     memset(&no_portal_offset, 0, sizeof(no_portal_offset));
 
-     Position_t portal_offsets[BLOCK_QUAD_TREE_MAX_QUERY];
-     memset(portal_offsets, 0, sizeof(portal_offsets));
-
-     Block_t* collided_block = block_against_block_in_list(pos, cut, blocks, block_count, direction, portal_offsets);
-     if(collided_block){
-          *push_dir = direction;
-          return collided_block;
+     auto query = quad_tree_query(block_qt, rect);
+     while(Block_t* block = quad_tree_query_next(&query)){
+          if(block_against_block(pos, cut, block, block->cut, direction, no_portal_offset)){
+               *push_dir = direction;
+               return block;
+          }
      }
 
-     auto found_blocks = find_blocks_through_portals(pos_to_coord(pos), tilemap, interactive_qt, block_qt);
-     for(S16 i = 0; i < found_blocks.count; i++){
-         auto* found_block = found_blocks.blocks + i;
-         blocks[i] = found_block->block;
+     Block_t* collided_block = nullptr;
+
+     auto* found_blocks = find_blocks_through_portals(pos_to_coord(pos), tilemap, interactive_qt, block_qt);
+     for(S16 i = 0; i < found_blocks->count; i++){
+         auto* found_block = found_blocks->blocks + i;
          auto block_pos = found_block->block->teleport ? found_block->block->teleport_pos + found_block->block->teleport_pos_delta : found_block->block->pos + found_block->block->pos_delta;
-         portal_offsets[i] = found_block->position - block_pos;
+         auto portal_offset = found_block->position - block_pos;
 
-         if(block_against_block(pos, cut, blocks[i], found_block->rotated_cut, direction, portal_offsets[i])){
+         if(block_against_block(pos, cut, found_block->block, found_block->rotated_cut, direction, portal_offset)){
               *push_dir = direction_rotate_clockwise(direction, found_block->rotations_between_portals);
               return collided_block;
          }
@@ -321,9 +307,6 @@ Pixel_t get_check_pixel_against_centroid(Pixel_t block_pixel, BlockCut_t cut, Di
 Block_t* check_portal_for_centroid_with_block(PortalExit_t* portal_exits, Coord_t portal_coord, Direction_t portal_direction,
                                               Direction_t block_move_dir, Block_t* block, QuadTreeNode_t<Block_t>* block_qt,
                                               ObjectArray_t<Block_t>* blocks_array){
-     S16 block_count = 0;
-     Block_t* blocks[BLOCK_QUAD_TREE_MAX_QUERY];
-
      auto portal_coord_center_pixel = coord_to_pixel_at_center(portal_coord);
 
      for(S8 d = 0; d < DIRECTION_COUNT; d++){
@@ -337,10 +320,8 @@ Block_t* check_portal_for_centroid_with_block(PortalExit_t* portal_exits, Coord_
 
                auto rect = rect_surrounding_adjacent_coords(portal_exit.coords[p]);
 
-               quad_tree_find_in(block_qt, rect, blocks, &block_count, BLOCK_QUAD_TREE_MAX_QUERY);
-
-               for(S16 i = 0; i < block_count; i++){
-                    Block_t* check_block = blocks[i];
+               auto query = quad_tree_query(block_qt, rect);
+               while(Block_t* check_block = quad_tree_query_next(&query)){
                     if(!blocks_are_entangled(block, check_block, blocks_array)) continue;
 
                     auto check_block_center = block_get_center(check_block);
@@ -372,13 +353,9 @@ Block_t* rotated_entangled_blocks_against_centroid(Block_t* block, Direction_t d
      auto block_center = block_get_center(block);
      Rect_t rect = rect_to_check_surrounding_blocks(block_center.pixel);
 
-     S16 block_count = 0;
-     Block_t* blocks[BLOCK_QUAD_TREE_MAX_QUERY];
-     quad_tree_find_in(block_qt, rect, blocks, &block_count, BLOCK_QUAD_TREE_MAX_QUERY);
-
      // TODO: compress this with below code that deals with portals
-     for(S16 i = 0; i < block_count; i++){
-          Block_t* check_block = blocks[i];
+     auto query = quad_tree_query(block_qt, rect);
+     while(Block_t* check_block = quad_tree_query_next(&query)){
           if(!blocks_are_entangled(block, check_block, blocks_array)) continue;
 
           auto check_block_rect = block_get_inclusive_rect(check_block);
@@ -443,16 +420,9 @@ Interactive_t* block_against_solid_interactive(Block_t* block_to_check, Directio
      return nullptr;
 }
 
-bool blocks_are_entangled(Block_t* a, Block_t* b, ObjectArray_t<Block_t>* blocks_array)
+bool blocks_are_entangled(Block_t* a, Block_t* b, ObjectArray_t<Block_t>*)
 {
-     S16 a_index = a - blocks_array->elements;
-     S16 entangle_index = a->entangle_index;
-     while(entangle_index != a_index && entangle_index >= 0){
-          Block_t* entangled_block = blocks_array->elements + entangle_index;
-          if(entangled_block == b) return true;
-          entangle_index = entangled_block->entangle_index;
-     }
-     return false;
+     return a != b && a->entangle_group >= 0 && a->entangle_group == b->entangle_group;
 }
 
 bool blocks_are_entangled(S16 a_index, S16 b_index, ObjectArray_t<Block_t>* blocks_array){
@@ -555,13 +525,10 @@ Block_t* pixel_inside_block(Pixel_t pixel, S8 z, TileMap_t* tilemap, QuadTreeNod
      search_rect.bottom = pixel.y - HALF_TILE_SIZE_IN_PIXELS;
      search_rect.top = pixel.y + HALF_TILE_SIZE_IN_PIXELS;
 
-     S16 block_count = 0;
-     Block_t* blocks[BLOCK_QUAD_TREE_MAX_QUERY];
-     quad_tree_find_in(block_qt, search_rect, blocks, &block_count, BLOCK_QUAD_TREE_MAX_QUERY);
-
-     for(S8 i = 0; i < block_count; i++){
-          if(blocks_at_collidable_height(z, blocks[i]->pos.z) && pixel_in_rect(pixel, block_get_inclusive_rect(blocks[i]))){
-               return blocks[i];
+     auto query = quad_tree_query(block_qt, search_rect);
+     while(Block_t* block = quad_tree_query_next(&query)){
+          if(blocks_at_collidable_height(z, block->pos.z) && pixel_in_rect(pixel, block_get_inclusive_rect(block))){
+               return block;
           }
      }
 
@@ -581,43 +548,46 @@ BlockInsideOthersResult_t block_inside_others(Position_t block_to_check_pos, Vec
 
      // TODO: need more complicated function to detect this
      Rect_t surrounding_rect = rect_to_check_surrounding_blocks(block_to_check_center_pixel);
-     S16 block_count = 0;
-     Block_t* blocks[BLOCK_QUAD_TREE_MAX_QUERY];
-     quad_tree_find_in(block_qt, surrounding_rect, blocks, &block_count, BLOCK_QUAD_TREE_MAX_QUERY);
 
-     Position_t portal_offsets[BLOCK_QUAD_TREE_MAX_QUERY];
+     Position_t portal_offsets[MAX_BLOCKS_FOUND_THROUGH_PORTALS];
      memset(portal_offsets, 0, sizeof(portal_offsets));
 
-     BlockCut_t cuts[BLOCK_QUAD_TREE_MAX_QUERY];
-     for(S16 i = 0; i < block_count; i++) cuts[i] = blocks[i]->teleport ? blocks[i]->teleport_cut : blocks[i]->cut;
-
-     auto inside_list_result = block_inside_block_list(block_to_check_pos, block_to_check_pos_delta,
-                                                       cut, block_to_check_index,
-                                                       block_to_check_cloning, blocks, block_count,
-                                                       block_array, cuts, portal_offsets);
-     for(S8 i = 0; i < inside_list_result.count; i++){
-          result.add(inside_list_result.entries[i].block, inside_list_result.entries[i].collided_pos,
-                     inside_list_result.entries[i].collided_pos_delta, inside_list_result.entries[i].collided_overlap,
-                     0, Coord_t{-1, -1}, Coord_t{-1, -1});
+     // blocks are checked one at a time as the query finds them, the list is only needed for the portal results below
+     auto query = quad_tree_query(block_qt, surrounding_rect);
+     while(Block_t* block = quad_tree_query_next(&query)){
+          BlockCut_t block_cut = block->teleport ? block->teleport_cut : block->cut;
+
+          auto inside_list_result = block_inside_block_list(block_to_check_pos, block_to_check_pos_delta,
+                                                            cut, block_to_check_index,
+                                                            block_to_check_cloning, &block, 1,
+                                                            block_array, &block_cut, portal_offsets);
+          for(S8 i = 0; i < inside_list_result.count; i++){
+               result.add(inside_list_result.entries[i].block, inside_list_result.entries[i].collided_pos,
+                          inside_list_result.entries[i].collided_pos_delta, inside_list_result.entries[i].collided_overlap,
+                          0, Coord_t{-1, -1}, Coord_t{-1, -1});
+          }
      }
 
      auto block_coord = pixel_to_coord(block_to_check_center_pixel);
 
-     auto found_blocks = find_blocks_through_portals(block_coord, tilemap, interactive_qt, block_qt);
-     for(S16 i = 0; i < found_blocks.count; i++){
-         auto* found_block = found_blocks.blocks + i;
+     Block_t* blocks[MAX_BLOCKS_FOUND_THROUGH_PORTALS];
+     BlockCut_t cuts[MAX_BLOCKS_FOUND_THROUGH_PORTALS];
+
+     auto* found_blocks = find_blocks_through_portals(block_coord, tilemap, interactive_qt, block_qt);
+     for(S16 i = 0; i < found_blocks->count; i++){
+         auto* found_block = found_blocks->blocks + i;
          blocks[i] = found_block->block;
          auto block_pos = found_block->block->teleport ? found_block->block->teleport_pos + found_block->block->teleport_pos_delta : found_block->block->pos + found_block->block->pos_delta;
          portal_offsets[i] = found_block->position - block_pos;
          cuts[i] = found_block->rotated_cut;
      }
 
-     inside_list_result = block_inside_block_list(block_to_check_pos, block_to_check_pos_delta,
+     auto inside_list_result = block_inside_block_list(block_to_check_pos, block_to_check_pos_delta,
                                                   cut, block_to_check_index, block_to_check_cloning,
-                                                  blocks, found_blocks.count, block_array, cuts, portal_offsets);
+                                                  blocks, found_blocks->count, block_array, cuts, portal_offsets);
 
      for(S8 i = 0; i < inside_list_result.count; i++){
-         BlockThroughPortal_t* associated_found_block = found_blocks.blocks + inside_list_result.entries[i].entry_index;
+         const BlockThroughPortal_t* associated_found_block = found_blocks->blocks + inside_list_result.entries[i].entry_index;
 
          if(block_to_check_index == (inside_list_result.entries[i].block - block_array->elements) &&
             direction_in_mask(vec_direction_mask(block_to_check_pos_delta), associated_found_block->dst_portal_dir)){
@@ -744,12 +714,8 @@ static BlockHeldResult_t block_at_height_in_block_rect(Pixel_t block_to_check_pi
      Rect_t check_rect = block_get_inclusive_rect(block_to_check_pixel, cut);
      Rect_t surrounding_rect = rect_to_check_surrounding_blocks(block_to_check_center);
 
-     S16 block_count = 0;
-     Block_t* blocks[BLOCK_QUAD_TREE_MAX_QUERY];
-     quad_tree_find_in(block_qt, surrounding_rect, blocks, &block_count, BLOCK_QUAD_TREE_MAX_QUERY);
-
-     for(S16 i = 0; i < block_count; i++){
-          Block_t* block = blocks[i];
+     auto query = quad_tree_query(block_qt, surrounding_rect);
+     while(Block_t* block = quad_tree_query_next(&query)){
           if(block->pos.z != expected_height) continue;
           auto block_pos = block->pos;
           if(include_pos_delta) block_pos += block->pos_delta;
@@ -768,9 +734,9 @@ static BlockHeldResult_t block_at_height_in_block_rect(Pixel_t block_to_check_pi
 
      auto block_to_check_coord = pixel_to_coord(block_to_check_center);
 
-     auto found_blocks = find_blocks_through_portals(block_to_check_coord, tilemap, interactive_qt, block_qt);
-     for(S16 i = 0; i < found_blocks.count; i++){
-         auto* found_block = found_blocks.blocks + i;
+     auto* found_blocks = find_blocks_through_portals(block_to_check_coord, tilemap, interactive_qt, block_qt);
+     for(S16 i = 0; i < found_blocks->count; i++){
+         auto* found_block = found_blocks->blocks + i;
 
          if(found_block->position.z != expected_height) continue;
 
@@ -853,12 +819,8 @@ bool block_on_ice(Position_t pos, Vec_t pos_delta, BlockCut_t cut, TileMap_t* ti
 
      auto rect_to_check = rect_surrounding_adjacent_coords(coord_to_check);
 
-     S16 block_count = 0;
-     Block_t* blocks[BLOCK_QUAD_TREE_MAX_QUERY];
-     quad_tree_find_in(block_qt, rect_to_check, blocks, &block_count, BLOCK_QUAD_TREE_MAX_QUERY);
-
-     for(S16 i = 0; i < block_count; i++){
-          auto block = blocks[i];
+     auto query = quad_tree_query(block_qt, rect_to_check);
+     while(Block_t* block = quad_tree_query_next(&query)){
           auto block_rect = block_get_inclusive_rect(block);
 
           if(block->pos.z + HEIGHT_INTERVAL != pos.z) continue;
@@ -1644,7 +1606,7 @@ DealWithPushResult_t deal_with_push_result(Block_t* pusher, Direction_t directio
 
 
 void push_entangled_block(Block_t* block, World_t* world, Direction_t push_dir, bool pushed_by_ice, F32 force, TransferMomentum_t* instant_momentum){
-     if(block->entangle_index < 0) return;
+     if(block->entangle_group < 0) return;
 
      PushFromEntangler_t from_entangler;
 
@@ -1661,9 +1623,9 @@ void push_entangled_block(Block_t* block, World_t* world, Direction_t push_dir,
 
      S16 block_mass = block_get_mass(block);
      S16 block_index = block - world->blocks.elements;
-     S16 entangle_index = block->entangle_index;
-     while(entangle_index != block_index && entangle_index >= 0){
-          Block_t* entangled_block = world->blocks.elements + entangle_index;
+     S16 entangle_count = entangle_group_size(&world->block_entangle, block_index);
+     for(S16 member = 1; member < entangle_count; member++){
+          Block_t* entangled_block = world->blocks.elements + entangle_member_after(&world->block_entangle, block_index, member);
           bool held_down = block_held_down_by_another_block(entangled_block, world->block_qt, world->interactive_qt, &world->tilemap).held();
           bool on_ice = block_on_ice(entangled_block->pos, entangled_block->pos_delta, entangled_block->cut,
                                      &world->tilemap, world->interactive_qt, world->block_qt);
@@ -1705,19 +1667,18 @@ void push_entangled_block(Block_t* block, World_t* world, Direction_t push_dir,
                     }
                }
           }
-          entangle_index = entangled_block->entangle_index;
      }
 }
 
 BlockPushes_t<MAX_BLOCK_PUSHES> push_entangled_block_pushes(Block_t* block, World_t* world, Direction_t push_dir, Block_t* pusher, S16 collided_with_block_count, TransferMomentum_t* instant_momentum){
      BlockPushes_t<MAX_BLOCK_PUSHES> result;
-     if(block->entangle_index < 0) return result;
+     if(block->entangle_group < 0) return result;
 
      S16 block_mass = block_get_mass(block);
      S16 block_index = block - world->blocks.elements;
-     S16 entangle_index = block->entangle_index;
-     while(entangle_index != block_index && entangle_index >= 0){
-          Block_t* entangled_block = world->blocks.elements + entangle_index;
+     S16 entangle_count = entangle_group_size(&world->block_entangle, block_index);
+     for(S16 member = 1; member < entangle_count; member++){
+          Block_t* entangled_block = world->blocks.elements + entangle_member_after(&world->block_entangle, block_index, member);
           bool held_down = block_held_down_by_another_block(entangled_block, world->block_qt, world->interactive_qt, &world->tilemap).held();
           bool on_ice = block_on_ice(entangled_block->pos, entangled_block->pos_delta, entangled_block->cut,
                                      &world->tilemap, world->interactive_qt, world->block_qt);
@@ -1760,8 +1721,6 @@ BlockPushes_t<MAX_BLOCK_PUSHES> push_entangled_block_pushes(Block_t* block, Worl
                     result.add(&push);
                }
           }
-
-          entangle_index = entangled_block->entangle_index;
      }
 
      return result;
@@ -1943,11 +1902,121 @@ BlockCollisionPushResult_t block_collision_push(BlockPush_t* push, World_t* worl
      return result;
 }
 
-FindBlocksThroughPortalResult_t find_blocks_through_portals(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_qt, QuadTreeNode_t<Block_t>* block_qt){
-    FindBlocksThroughPortalResult_t result;
+struct BlockPortalCache_t{
+     // per tile, a result is only reused while its generation matches the cache's
+     const FindBlocksThroughPortalResult_t** results = nullptr;
+     U32* generations = nullptr;
+     S16 width = 0;
+     S16 height = 0;
+     U32 generation = 0;
+     bool in_pass = false;
+
+     // frame arena, chunks are never moved so results stay put until the frame is reset
+     FindBlocksThroughPortalResult_t** chunks = nullptr;
+     S32 chunk_count = 0;
+     S32 chunk_allocated = 0;
+     S32 used = 0;
+
+     BlockPortalCacheStats_t stats;
+};
+
+static thread_local BlockPortalCache_t block_portal_cache;
+static const FindBlocksThroughPortalResult_t no_blocks_through_portals {};
+
+static FindBlocksThroughPortalResult_t* block_portal_arena_push(BlockPortalCache_t* cache){
+     S32 chunk_index = cache->used / BLOCK_PORTAL_ARENA_CHUNK_SIZE;
+     if(chunk_index >= cache->chunk_count){
+          if(cache->chunk_count >= cache->chunk_allocated){
+               S32 new_allocated = cache->chunk_allocated ? cache->chunk_allocated * 2 : 8;
+               auto* new_chunks = (FindBlocksThroughPortalResult_t**)(realloc(cache->chunks, new_allocated * sizeof(*cache->chunks)));
+               if(!new_chunks){
+                    LOG("%s() failed to realloc %d arena chunks\n", __FUNCTION__, new_allocated);
+                    return nullptr;
+               }
+               cache->chunks = new_chunks;
+               cache->chunk_allocated = new_allocated;
+          }
+
+          auto* chunk = (FindBlocksThroughPortalResult_t*)(malloc(BLOCK_PORTAL_ARENA_CHUNK_SIZE * sizeof(FindBlocksThroughPortalResult_t)));
+          if(!chunk){
+               LOG("%s() failed to malloc arena chunk\n", __FUNCTION__);
+               return nullptr;
+          }
+          cache->chunks[cache->chunk_count] = chunk;
+          cache->chunk_count++;
+     }
+
+     auto* result = cache->chunks[chunk_index] + (cache->used % BLOCK_PORTAL_ARENA_CHUNK_SIZE);
+     cache->used++;
+     result->count = 0;
+     return result;
+}
+
+static void block_portal_cache_next_generation(BlockPortalCache_t* cache){
+     cache->generation++;
+     if(cache->generation == 0){
+          memset(cache->generations, 0, (size_t)(cache->width * cache->height) * sizeof(*cache->generations));
+          cache->generation = 1;
+     }
+}
+
+void block_portal_cache_begin_pass(TileMap_t* tilemap){
+     BlockPortalCache_t* cache = &block_portal_cache;
+     if(cache->width != tilemap->width || cache->height != tilemap->height){
+          free(cache->results);
+          free(cache->generations);
+          S32 tile_count = tilemap->width * tilemap->height;
+          cache->results = (const FindBlocksThroughPortalResult_t**)(calloc((size_t)(tile_count), sizeof(*cache->results)));
+          cache->generations = (U32*)(calloc((size_t)(tile_count), sizeof(*cache->generations)));
+          if(!cache->results || !cache->generations){
+               LOG("%s() failed to calloc %dx%d cache tiles\n", __FUNCTION__, tilemap->width, tilemap->height);
+               free(cache->results);
+               free(cache->generations);
+               cache->results = nullptr;
+               cache->generations = nullptr;
+               cache->width = 0;
+               cache->height = 0;
+               return;
+          }
+          cache->width = tilemap->width;
+          cache->height = tilemap->height;
+     }
+
+     block_portal_cache_next_generation(cache);
+     cache->in_pass = true;
+}
+
+void block_portal_cache_invalidate(){
+     BlockPortalCache_t* cache = &block_portal_cache;
+     if(cache->in_pass) block_portal_cache_next_generation(cache);
+}
+
+void block_portal_cache_end_pass(){
+     block_portal_cache.in_pass = false;
+}
+
+void block_portal_cache_reset_frame(){
+     block_portal_cache.used = 0;
+}
+
+BlockPortalCacheStats_t block_portal_cache_stats(){
+     BlockPortalCacheStats_t stats = block_portal_cache.stats;
+     stats.arena_results = block_portal_cache.used;
+     return stats;
+}
 
-     S16 block_count = 0;
-     Block_t* blocks[BLOCK_QUAD_TREE_MAX_QUERY];
+void block_portal_cache_free(){
+     BlockPortalCache_t* cache = &block_portal_cache;
+     for(S32 i = 0; i < cache->chunk_count; i++) free(cache->chunks[i]);
+     free(cache->chunks);
+     free(cache->results);
+     free(cache->generations);
+     *cache = BlockPortalCache_t{};
+}
+
+static void find_blocks_through_portals_uncached(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_qt,
+                                                 QuadTreeNode_t<Block_t>* block_qt, FindBlocksThroughPortalResult_t* result){
+     QuadTreeResults_t<Block_t> blocks;
 
      Coord_t surrounding_coords[SURROUNDING_COORD_COUNT];
      coords_surrounding(surrounding_coords, SURROUNDING_COORD_COUNT, coord);
@@ -1972,16 +2041,16 @@ FindBlocksThroughPortalResult_t find_blocks_through_portals(Coord_t coord, TileM
                     Coord_t portal_dst_output_coord = portal_dst_coord + direction_opposite(current_portal_dir);
 
                     auto check_portal_rect = rect_surrounding_adjacent_coords(portal_dst_coord);
-                    quad_tree_find_in(block_qt, check_portal_rect, blocks, &block_count, BLOCK_QUAD_TREE_MAX_QUERY);
+                    quad_tree_find_in(block_qt, check_portal_rect, &blocks);
 
                     auto portal_dst_output_center = pixel_to_pos(coord_to_pixel_at_center(portal_dst_output_coord));
-                    sort_blocks_by_ascending_height(blocks, block_count);
+                    sort_blocks_by_ascending_height(blocks.entries(), blocks.count);
 
                     auto rotations_between_portals = portal_rotations_between(interactive->portal.face, current_portal_dir);
                     auto compatibility_rot = portal_rotations_between(current_portal_dir, interactive->portal.face);
 
-                    for(S8 b = 0; b < block_count; b++){
-                         Block_t* block = blocks[b];
+                    for(S16 b = 0; b < blocks.count; b++){
+                         Block_t* block = blocks.entries()[b];
 
                          auto portal_rotations = direction_rotations_between(interactive->portal.face, direction_opposite(current_portal_dir));
 
@@ -1995,15 +2064,55 @@ FindBlocksThroughPortalResult_t find_blocks_through_portals(Coord_t coord, TileM
 
                          block_final_pos.pixel -= block_center_pixel_offset(rotated_cut);
 
-                         result.add_block_through_portal(block_final_pos, block, check_coord, portal_dst_coord,
-                                                         interactive->portal.face, current_portal_dir, portal_rotations,
-                                                         rotations_between_portals, rotated_cut);
+                         result->add_block_through_portal(block_final_pos, block, check_coord, portal_dst_coord,
+                                                          interactive->portal.face, current_portal_dir, portal_rotations,
+                                                          rotations_between_portals, rotated_cut);
                     }
                }
           }
      }
 
-     return result;
+     destroy(&blocks);
+}
+
+const FindBlocksThroughPortalResult_t* find_blocks_through_portals(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_qt, QuadTreeNode_t<Block_t>* block_qt){
+     BlockPortalCache_t* cache = &block_portal_cache;
+
+     S32 tile_index = -1;
+     if(cache->in_pass && cache->results && coord.x >= 0 && coord.x < cache->width && coord.y >= 0 && coord.y < cache->height){
+          tile_index = coord.y * cache->width + coord.x;
+          if(cache->generations[tile_index] == cache->generation){
+               cache->stats.hits++;
+               return cache->results[tile_index];
+          }
+          cache->stats.misses++;
+     }
+
+     const FindBlocksThroughPortalResult_t* found = &no_blocks_through_portals;
+
+     FindBlocksThroughPortalResult_t* result = block_portal_arena_push(cache);
+     if(result){
+          find_blocks_through_portals_uncached(coord, tilemap, interactive_qt, block_qt, result);
+
+          // most coords aren't near a portal, hand those the shared empty result and give the slot back
+          if(result->count == 0){
+               cache->used--;
+          }else{
+               found = result;
+          }
+     }else{
+          static thread_local FindBlocksThroughPortalResult_t overflow_result;
+          overflow_result.count = 0;
+          find_blocks_through_portals_uncached(coord, tilemap, interactive_qt, block_qt, &overflow_result);
+          found = &overflow_result;
+     }
+
+     if(tile_index >= 0){
+          cache->results[tile_index] = found;
+          cache->generations[tile_index] = cache->generation;
+     }
+
+     return found;
 }
 
 BlockChainsResult_t find_block_chain(Block_t* block, Direction_t direction, QuadTreeNode_t<Block_t>* block_qt,
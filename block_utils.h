@@ -415,6 +415,7 @@ struct BlockThroughPortal_t{
 };
 
 #define MAX_BLOCKS_FOUND_THROUGH_PORTALS 64
+#define BLOCK_PORTAL_ARENA_CHUNK_SIZE 32
 
 struct FindBlocksThroughPortalResult_t{
     BlockThroughPortal_t blocks[MAX_BLOCKS_FOUND_THROUGH_PORTALS];
@@ -441,12 +442,18 @@ struct FindBlocksThroughPortalResult_t{
     }
 };
 
+struct BlockPortalCacheStats_t{
+     U64 hits = 0;
+     U64 misses = 0;
+     S32 arena_results = 0;
+};
+
+
 void add_block_held(BlockHeldResult_t* result, Block_t* block, Rect_t rect);
 void add_interactive_held(InteractiveHeldResult_t* result, Interactive_t* interactive, Rect_t rect);
 
 bool block_adjacent_pixels_to_check(Position_t pos, Vec_t pos_delta, BlockCut_t cut, Direction_t direction, Pixel_t* a, Pixel_t* b);
 
-Block_t* block_against_block_in_list(Position_t pos, BlockCut_t cut, Block_t** blocks, S16 block_count, Direction_t direction, Position_t* portal_offsets);
 Block_t* block_against_another_block(Position_t pos, BlockCut_t cut, Direction_t direction, QuadTreeNode_t<Block_t>* block_qt,
                                      QuadTreeNode_t<Interactive_t>* interactive_quad_tree, TileMap_t* tilemap, Direction_t* push_dir);
 BlockAgainstOthersResult_t block_against_other_blocks(Position_t pos, BlockCut_t cut, Direction_t direction, QuadTreeNode_t<Block_t>* block_qt,
@@ -501,7 +508,18 @@ void apply_block_change(ObjectArray_t<Block_t>* blocks_array, BlockChange_t* cha
 TransferMomentum_t get_block_push_pusher_momentum(BlockPush_t* push, World_t* world, Direction_t push_direction);
 BlockCollisionPushResult_t block_collision_push(BlockPush_t* push, World_t* world);
 
-FindBlocksThroughPortalResult_t find_blocks_through_portals(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_qt, QuadTreeNode_t<Block_t>* block_qt);
+// the result lives in the frame arena until block_portal_cache_reset_frame(), while a pass is open results are
+// reused per coord until block_portal_cache_invalidate()
+const FindBlocksThroughPortalResult_t* find_blocks_through_portals(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_qt, QuadTreeNode_t<Block_t>* block_qt);
+
+// a pass is a stretch of the frame that looks blocks up through portals many times, anything that moves a block
+// (pos, pos_delta, teleport or cut) inside it has to invalidate
+void block_portal_cache_begin_pass(TileMap_t* tilemap);
+void block_portal_cache_invalidate();
+void block_portal_cache_end_pass();
+void block_portal_cache_reset_frame();
+BlockPortalCacheStats_t block_portal_cache_stats();
+void block_portal_cache_free();
 // LOL
 BlockChainsResult_t find_block_chain(Block_t* block, Direction_t direction, QuadTreeNode_t<Block_t>* block_qt,
                                      QuadTreeNode_t<Interactive_t>* interactive_qt, TileMap_t* tilemap, S8 rotations = 0, BlockChain_t* my_chain = NULL);
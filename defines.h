@@ -51,7 +51,6 @@
 
 #define UNDO_MEMORY (4 * 1024 * 1024)
 
-#define BLOCK_QUAD_TREE_MAX_QUERY 16
 
 #define LIGHT_MAX_LINE_LEN 8
 
@@ -1,6 +1,9 @@
 #include "demo.h"
+#include "map_format.h"
 
 #include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
 
 struct DemoEntryNode_t{
      DemoEntry_t entry;
@@ -93,7 +96,9 @@ bool demo_play_frame(Demo_t* demo, PlayerAction_t* player_action, ObjectArray_t<
                return true;
           }
      }else{
-          while(frame_count == demo->entries.entries[demo->entry_index].frame){
+          // stop short of an END_DEMO on this same frame, it is checked on the next one
+          while(frame_count == demo->entries.entries[demo->entry_index].frame &&
+                demo->entries.entries[demo->entry_index].player_action_type != PLAYER_ACTION_TYPE_END_DEMO){
                player_action_perform(player_action, players,
                                      demo->entries.entries[demo->entry_index].player_action_type, record_demo->mode,
                                      record_demo->file, frame_count);
@@ -210,3 +215,60 @@ void player_action_perform(PlayerAction_t* player_action, ObjectArray_t<Player_t
           fwrite(&demo_entry, sizeof(demo_entry), 1, demo_file);
      }
 }
+
+bool demo_write(const char* filepath, const DemoEntry_t* entries, S64 entry_count, S64 end_frame, Coord_t player_start,
+                const TileMap_t* tilemap, ObjectArray_t<Block_t>* blocks, ObjectArray_t<Interactive_t>* interactives,
+                ObjectArray_t<Player_t>* players){
+     FILE* file = fopen(filepath, "wb");
+     if(!file){
+          LOG("failed to open demo file: %s\n", filepath);
+          return false;
+     }
+
+     S32 version = 2;
+     fwrite(&version, sizeof(version), 1, file);
+     fwrite(entries, sizeof(*entries), (size_t)(entry_count), file);
+
+     DemoEntry_t end {end_frame, PLAYER_ACTION_TYPE_END_DEMO};
+     fwrite(&end, sizeof(end), 1, file);
+
+     demo_write_end_state(file, player_start, tilemap, blocks, interactives, players);
+
+     fclose(file);
+     return true;
+}
+
+void demo_write_end_state(FILE* file, Coord_t player_start, const TileMap_t* tilemap, ObjectArray_t<Block_t>* blocks,
+                          ObjectArray_t<Interactive_t>* interactives, ObjectArray_t<Player_t>* players){
+     save_map_to_file(file, player_start, tilemap, blocks, interactives, NULL, NULL);
+     fwrite(&players->count, sizeof(players->count), 1, file);
+     for(S16 p = 0; p < players->count; p++){
+          fwrite(&players->elements[p].pos.pixel, sizeof(players->elements[p].pos.pixel), 1, file);
+     }
+}
+
+FILE* load_demo_number(S32 map_number, const char** demo_filepath){
+     char filepath[64] = {};
+     snprintf(filepath, 64, "content/%03d.bd", map_number);
+     *demo_filepath = strdup(filepath);
+     return fopen(*demo_filepath, "rb");
+}
+
+bool load_map_number_demo(Demo_t* demo, S16 map_number, S64* frame_count){
+     if(demo->file) fclose(demo->file);
+     demo->file = load_demo_number(map_number, &demo->filepath);
+     if(!demo->file){
+          LOG("missing map %d corresponding demo.\n", map_number);
+          return false;
+     }
+
+     free(demo->entries.entries);
+     demo->entry_index = 0;
+     fread(&demo->version, sizeof(demo->version), 1, demo->file);
+     demo->entries = demo_entries_get(demo->file);
+     *frame_count = 0;
+     demo->last_frame = demo->entries.entries[demo->entries.count - 1].frame;
+     LOG("testing demo %s: version %d with %" PRId64 " actions across %" PRId64 " frames\n", demo->filepath,
+         demo->version, demo->entries.count, demo->last_frame);
+     return true;
+}
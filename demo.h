@@ -5,6 +5,10 @@
 
 #include <stdio.h>
 
+struct TileMap_t;
+struct Block_t;
+struct Interactive_t;
+
 enum PlayerActionType_t{
      PLAYER_ACTION_TYPE_MOVE_LEFT_START,
      PLAYER_ACTION_TYPE_MOVE_LEFT_STOP,
@@ -68,3 +72,16 @@ bool demo_play_frame(Demo_t* demo, PlayerAction_t* player_action, ObjectArray_t<
 
 void player_action_perform(PlayerAction_t* player_action, ObjectArray_t<Player_t>* players, PlayerActionType_t player_action_type,
                            DemoMode_t demo_mode, FILE* demo_file, S64 frame_count);
+
+// writes a version 2 demo of entries, ending at end_frame, followed by the end state playback is checked against
+bool demo_write(const char* filepath, const DemoEntry_t* entries, S64 entry_count, S64 end_frame, Coord_t player_start,
+                const TileMap_t* tilemap, ObjectArray_t<Block_t>* blocks, ObjectArray_t<Interactive_t>* interactives,
+                ObjectArray_t<Player_t>* players);
+
+// the part of a demo demo_write() puts after the end entry
+void demo_write_end_state(FILE* file, Coord_t player_start, const TileMap_t* tilemap, ObjectArray_t<Block_t>* blocks,
+                          ObjectArray_t<Interactive_t>* interactives, ObjectArray_t<Player_t>* players);
+
+// content/<map number>.bd, demo_filepath is strdup()'d
+FILE* load_demo_number(S32 map_number, const char** demo_filepath);
+bool load_map_number_demo(Demo_t* demo, S16 map_number, S64* frame_count);
@@ -8,6 +8,7 @@
 
 #include <float.h>
 #include <ctype.h>
+#include <math.h>
 
 Vec_t theme_frame(S16 x, S16 y){
      y = (THEME_FRAMES_TALL - (S16)(1)) - y;
@@ -24,55 +25,8 @@ Vec_t player_frame(S16 x, S16 y){
      return Vec_t{(F32)(x) * PLAYER_FRAME_WIDTH, (F32)(y) * PLAYER_FRAME_HEIGHT};
 }
 
-GLuint create_texture_from_bitmap(AlphaBitmap_t* bitmap){
-     GLuint texture = 0;
-
-     glGenTextures(1, &texture);
-
-     glBindTexture(GL_TEXTURE_2D, texture);
-
-     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bitmap->width, bitmap->height, 0,  GL_RGBA, GL_UNSIGNED_BYTE, bitmap->pixels);
-
-     return texture;
-}
-
-GLuint transparent_texture_from_bitmap(Bitmap_t* bitmap){
-     AlphaBitmap_t alpha_bitmap = bitmap_to_alpha_bitmap(bitmap, BitmapPixel_t{255, 0, 255});
-     GLuint texture_id = create_texture_from_bitmap(&alpha_bitmap);
-     free(alpha_bitmap.pixels);
-     return texture_id;
-}
-
-GLuint transparent_texture_from_file(const char* filepath){
-     Bitmap_t bitmap = bitmap_load_from_file(filepath);
-     if(bitmap.raw.byte_count == 0) return 0;
-     GLuint result = transparent_texture_from_bitmap(&bitmap);
-     free(bitmap.raw.bytes);
-     return result;
-}
-
-GLuint transparent_texture_from_raw_bitmap(Raw_t* raw){
-     Bitmap_t bitmap = bitmap_load_raw(raw->bytes, raw->byte_count);
-     if(bitmap.raw.byte_count == 0) return 0;
-     GLuint result = transparent_texture_from_bitmap(&bitmap);
-     free(bitmap.raw.bytes);
-     return result;
-}
-
 void draw_screen_texture(Vec_t pos, Vec_t tex, Vec_t dim, Vec_t tex_dim){
-     glTexCoord2f(tex.x, tex.y);
-     glVertex2f(pos.x, pos.y);
-     glTexCoord2f(tex.x, tex.y + tex_dim.y);
-     glVertex2f(pos.x, pos.y + dim.y);
-     glTexCoord2f(tex.x + tex_dim.x, tex.y + tex_dim.y);
-     glVertex2f(pos.x + dim.x, pos.y + dim.y);
-     glTexCoord2f(tex.x + tex_dim.x, tex.y);
-     glVertex2f(pos.x + dim.x, pos.y);
+     render_quad(pos, dim, tex, tex_dim);
 }
 
 void draw_theme_frame(Vec_t pos, Vec_t tex){
@@ -165,9 +119,9 @@ void draw_block(Block_t* block, Vec_t pos_vec, U8 portal_rotations){
 
      if(block->element == ELEMENT_ONLY_ICED || block->element == ELEMENT_ICE ){
           tex_vec = theme_frame(4, 12);
-          glColor4f(1.0f, 1.0f, 1.0f, 0.5f);
+          render_color(1.0f, 1.0f, 1.0f, 0.5f);
           draw_double_theme_frame(pos_vec, tex_vec);
-          glColor3f(1.0f, 1.0f, 1.0f);
+          render_color(1.0f, 1.0f, 1.0f);
      }
 
      if(block->element == ELEMENT_FIRE){
@@ -190,23 +144,9 @@ void draw_block(Block_t* block, Vec_t pos_vec, U8 portal_rotations){
           quad.top = pos_vec.y;
           quad.bottom = pos_vec.y - (F32)(block->pos.z) * PIXEL_SIZE;
 
-          glEnd();
-
-          GLint save_texture;
-          glGetIntegerv(GL_TEXTURE_BINDING_2D, &save_texture);
-
-          glBindTexture(GL_TEXTURE_2D, 0);
-          glBegin(GL_QUADS);
-          glColor4f(0.0f, 0.0f, 0.0f, block_shadow_opacity);
-          glVertex2f(quad.left,  quad.top);
-          glVertex2f(quad.left,  quad.bottom);
-          glVertex2f(quad.right, quad.bottom);
-          glVertex2f(quad.right, quad.top);
-          glEnd();
-
-          glBindTexture(GL_TEXTURE_2D, save_texture);
-          glBegin(GL_QUADS);
-          glColor3f(1.0f, 1.0f, 1.0f);
+          render_color(0.0f, 0.0f, 0.0f, block_shadow_opacity);
+          render_flat_quad(&quad);
+          render_color(1.0f, 1.0f, 1.0f);
      }
 }
 
@@ -376,27 +316,13 @@ void draw_interactive(Interactive_t* interactive, Vec_t pos_vec, Coord_t coord,
 }
 
 void draw_quad_wireframe(const Quad_t* quad, F32 red, F32 green, F32 blue){
-     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-     glBegin(GL_QUADS);
-     glColor4f(red, green, blue, 1.0f);
-     glVertex2f(quad->left,  quad->top);
-     glVertex2f(quad->left,  quad->bottom);
-     glVertex2f(quad->right, quad->bottom);
-     glVertex2f(quad->right, quad->top);
-     glEnd();
-
-     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+     render_color(red, green, blue, 1.0f);
+     render_quad_outline(quad);
 }
 
 void draw_quad_filled(const Quad_t* quad, F32 red, F32 green, F32 blue){
-     glBegin(GL_QUADS);
-     glColor4f(red, green, blue, 1.0f);
-     glVertex2f(quad->left,  quad->top);
-     glVertex2f(quad->left,  quad->bottom);
-     glVertex2f(quad->right, quad->bottom);
-     glVertex2f(quad->right, quad->top);
-     glEnd();
+     render_color(red, green, blue, 1.0f);
+     render_flat_quad(quad);
 }
 
 void draw_selection(Coord_t selection_start, Coord_t selection_end, Camera_t* camera, F32 red, F32 green, F32 blue){
@@ -410,38 +336,16 @@ void draw_selection(Coord_t selection_start, Coord_t selection_end, Camera_t* ca
 
      Quad_t selection_quad {start_vec.x, start_vec.y, end_vec.x + TILE_SIZE, end_vec.y + TILE_SIZE};
 
-     glMatrixMode(GL_PROJECTION);
-     glLoadIdentity();
-     glOrtho(camera->view.left, camera->view.right, camera->view.bottom, camera->view.top, 0.0, 1.0);
-
-     glBindTexture(GL_TEXTURE_2D, 0);
+     render_view(camera->view);
      draw_quad_wireframe(&selection_quad, red, green, blue);
-
-     glMatrixMode(GL_PROJECTION);
-     glLoadIdentity();
-     glOrtho(0.0f, 1.0f, 0.0f, 1.0f, 0.0, 1.0);
+     render_view(Quad_t{0.0f, 0.0f, 1.0f, 1.0f});
 }
 
 static void draw_ice(Vec_t pos){
-     glEnd();
-
-     GLint save_texture;
-     glGetIntegerv(GL_TEXTURE_BINDING_2D, &save_texture);
-
-     // get state ready for ice
-     glBindTexture(GL_TEXTURE_2D, 0);
-     glColor4f(196.0f / 255.0f, 217.0f / 255.0f, 1.0f, 0.45f);
-     glBegin(GL_QUADS);
-     glVertex2f(pos.x, pos.y);
-     glVertex2f(pos.x, pos.y + TILE_SIZE);
-     glVertex2f(pos.x + TILE_SIZE, pos.y + TILE_SIZE);
-     glVertex2f(pos.x + TILE_SIZE, pos.y);
-     glEnd();
-
-     // reset state back to default
-     glBindTexture(GL_TEXTURE_2D, save_texture);
-     glBegin(GL_QUADS);
-     glColor3f(1.0f, 1.0f, 1.0f);
+     Quad_t quad {pos.x, pos.y, pos.x + TILE_SIZE, pos.y + TILE_SIZE};
+     render_color(196.0f / 255.0f, 217.0f / 255.0f, 1.0f, 0.45f);
+     render_flat_quad(&quad);
+     render_color(1.0f, 1.0f, 1.0f);
 }
 
 Vec_t draw_player(Player_t* player, Vec_t camera, Coord_t source_coord, Coord_t destination_coord, S8 portal_rotations){
@@ -479,29 +383,19 @@ Vec_t draw_player(Player_t* player, Vec_t camera, Coord_t source_coord, Coord_t
      Vec_t shadow_vec = player_frame(3, 0);
 
 
+     Vec_t dim {TILE_SIZE, TILE_SIZE};
+     Vec_t tex_dim {PLAYER_FRAME_WIDTH, PLAYER_FRAME_HEIGHT};
+     Vec_t half_dim {HALF_TILE_SIZE, HALF_TILE_SIZE};
+
      // draw shadow
      pos_vec.y -= PIXEL_SIZE; // move shadow up 1
-     glColor4f(1.0f, 1.0f, 1.0f, 0.5f);
-     glTexCoord2f(shadow_vec.x, shadow_vec.y);
-     glVertex2f(pos_vec.x - HALF_TILE_SIZE, pos_vec.y - HALF_TILE_SIZE);
-     glTexCoord2f(shadow_vec.x, shadow_vec.y + PLAYER_FRAME_HEIGHT);
-     glVertex2f(pos_vec.x - HALF_TILE_SIZE, pos_vec.y + HALF_TILE_SIZE);
-     glTexCoord2f(shadow_vec.x + PLAYER_FRAME_WIDTH, shadow_vec.y + PLAYER_FRAME_HEIGHT);
-     glVertex2f(pos_vec.x + HALF_TILE_SIZE, pos_vec.y + HALF_TILE_SIZE);
-     glTexCoord2f(shadow_vec.x + PLAYER_FRAME_WIDTH, shadow_vec.y);
-     glVertex2f(pos_vec.x + HALF_TILE_SIZE, pos_vec.y - HALF_TILE_SIZE);
+     render_color(1.0f, 1.0f, 1.0f, 0.5f);
+     render_quad(pos_vec - half_dim, shadow_vec, dim, tex_dim);
      pos_vec.y += PIXEL_SIZE; // undo shadow transform
 
      // draw player
-     glColor3f(1.0f, 1.0f, 1.0f);
-     glTexCoord2f(tex_vec.x, tex_vec.y);
-     glVertex2f(pos_vec.x - HALF_TILE_SIZE, pos_vec.y - HALF_TILE_SIZE);
-     glTexCoord2f(tex_vec.x, tex_vec.y + PLAYER_FRAME_HEIGHT);
-     glVertex2f(pos_vec.x - HALF_TILE_SIZE, pos_vec.y + HALF_TILE_SIZE);
-     glTexCoord2f(tex_vec.x + PLAYER_FRAME_WIDTH, tex_vec.y + PLAYER_FRAME_HEIGHT);
-     glVertex2f(pos_vec.x + HALF_TILE_SIZE, pos_vec.y + HALF_TILE_SIZE);
-     glTexCoord2f(tex_vec.x + PLAYER_FRAME_WIDTH, tex_vec.y);
-     glVertex2f(pos_vec.x + HALF_TILE_SIZE, pos_vec.y - HALF_TILE_SIZE);
+     render_color(1.0f, 1.0f, 1.0f);
+     render_quad(pos_vec - half_dim, tex_vec, dim, tex_dim);
 
      return pos_vec;
 }
@@ -537,9 +431,9 @@ void draw_flats(Vec_t pos, Tile_t* tile, Interactive_t* interactive, U8 portal_r
                if(interactive->popup.iced){
                     pos.y += interactive->popup.lift.ticks * PIXEL_SIZE;
                     Vec_t tex_vec = theme_frame(3, 12);
-                    glColor4f(1.0f, 1.0f, 1.0f, 0.5f);
+                    render_color(1.0f, 1.0f, 1.0f, 0.5f);
                     draw_theme_frame(pos, tex_vec);
-                    glColor3f(1.0f, 1.0f, 1.0f);
+                    render_color(1.0f, 1.0f, 1.0f);
                }
           }else if(interactive->type == INTERACTIVE_TYPE_LIGHT_DETECTOR ||
                    interactive->type == INTERACTIVE_TYPE_ICE_DETECTOR){
@@ -613,7 +507,8 @@ void draw_world_row_flats(S16 y, S16 x_start, S16 x_end, TileMap_t* tilemap, Qua
 }
 
 void draw_world_row_solids(S16 y, S16 x_start, S16 x_end, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_qt,
-                           QuadTreeNode_t<Block_t>* block_qt, ObjectArray_t<Player_t>* players, Vec_t camera, GLuint player_texture){
+                           QuadTreeNode_t<Block_t>* block_qt, ObjectArray_t<Player_t>* players, Vec_t camera,
+                           const Texture_t* theme_texture, const Texture_t* player_texture){
      auto draw_pos = Vec_t{(float)(x_start) * TILE_SIZE, (float)(y) * TILE_SIZE} + camera;
      auto save_draw_pos = draw_pos;
 
@@ -634,9 +529,9 @@ void draw_world_row_solids(S16 y, S16 x_start, S16 x_end, TileMap_t* tilemap, Qu
                          auto ice_draw_pos = draw_pos;
                          ice_draw_pos.y += interactive->popup.lift.ticks * PIXEL_SIZE;
                          Vec_t tex_vec = theme_frame(3, 12);
-                         glColor4f(1.0f, 1.0f, 1.0f, 0.5f);
+                         render_color(1.0f, 1.0f, 1.0f, 0.5f);
                          draw_theme_frame(ice_draw_pos, tex_vec);
-                         glColor3f(1.0f, 1.0f, 1.0f);
+                         render_color(1.0f, 1.0f, 1.0f);
                     }
                }
           }
@@ -649,26 +544,21 @@ void draw_world_row_solids(S16 y, S16 x_start, S16 x_end, TileMap_t* tilemap, Qu
                                (S16)((x_end * TILE_SIZE_IN_PIXELS) + TILE_SIZE_IN_PIXELS),
                                (S16)((y * TILE_SIZE_IN_PIXELS) + TILE_SIZE_IN_PIXELS)};
 
-     S16 block_count = 0;
-     Block_t* blocks[256]; // oh god i hope we don't need more than that?
-     quad_tree_find_in(block_qt, search_rect, blocks, &block_count, 256);
+     QuadTreeResults_t<Block_t> blocks;
+     quad_tree_find_in(block_qt, search_rect, &blocks);
 
-     sort_blocks_by_descending_height(blocks, block_count);
+     sort_blocks_by_descending_height(blocks.entries(), blocks.count);
 
-     for(S16 i = 0; i < block_count; i++){
-          auto block = blocks[i];
+     for(S16 i = 0; i < blocks.count; i++){
+          auto block = blocks.entries()[i];
           auto draw_block_pos = block->pos;
           draw_block_pos.pixel.y += block->pos.z;
           draw_block(block, pos_to_vec(draw_block_pos) + camera, 0);
      }
 
-     glEnd();
-
-     GLint save_texture = 0;
-     glGetIntegerv(GL_TEXTURE_BINDING_2D, &save_texture);
+     destroy(&blocks);
 
-     glBindTexture(GL_TEXTURE_2D, player_texture);
-     glBegin(GL_QUADS);
+     render_bind_texture(player_texture);
 
      // player layer slayer flayer bayer
      for(S16 i = 0; i < players->count; i++){
@@ -679,17 +569,13 @@ void draw_world_row_solids(S16 y, S16 x_start, S16 x_end, TileMap_t* tilemap, Qu
                draw_pos = draw_player(player, camera, coord, Coord_t{-1, -1}, 0);
 
                if(i >= 1){
-                   glEnd();
-                   glBindTexture(GL_TEXTURE_2D, save_texture);
-                   glBegin(GL_QUADS);
+                   render_bind_texture(theme_texture);
 
                    draw_pos -= Vec_t{HALF_TILE_SIZE, HALF_TILE_SIZE};
                    auto tex_vec = theme_frame(0, 22);
                    draw_theme_frame(draw_pos, tex_vec);
 
-                   glEnd();
-                   glBindTexture(GL_TEXTURE_2D, player_texture);
-                   glBegin(GL_QUADS);
+                   render_bind_texture(player_texture);
                }
           }
      }
@@ -732,6 +618,233 @@ void draw_world_row_arrows(S16 y, S16 x_start, S16 x_end, const ArrowArray_t* ar
      }
 }
 
+void draw_world_visible_range(World_t* world, Camera_t* camera, Coord_t* min, Coord_t* max){
+     // tile x is drawn at x * TILE_SIZE + world_offset, so invert that for the edges of the view
+     F32 left = (camera->view.left - camera->world_offset.x) / TILE_SIZE;
+     F32 right = (camera->view.right - camera->world_offset.x) / TILE_SIZE;
+     F32 bottom = (camera->view.bottom - camera->world_offset.y) / TILE_SIZE;
+     F32 top = (camera->view.top - camera->world_offset.y) / TILE_SIZE;
+
+     // sprites spill into neighboring tiles and raised blocks and popups are drawn above the row they are in, so
+     // rows below the view can still show up in it
+     min->x = (S16)(floorf(left)) - DRAW_CULL_MARGIN_TILES;
+     max->x = (S16)(ceilf(right)) + DRAW_CULL_MARGIN_TILES;
+     min->y = (S16)(floorf(bottom)) - DRAW_CULL_RAISED_MARGIN_TILES;
+     max->y = (S16)(ceilf(top)) + DRAW_CULL_MARGIN_TILES;
+
+     *min = coord_clamp_zero_to_dim(*min, world->tilemap.width - (S16)(1), world->tilemap.height - (S16)(1));
+     *max = coord_clamp_zero_to_dim(*max, world->tilemap.width - (S16)(1), world->tilemap.height - (S16)(1));
+}
+
+static void draw_world_row_portals(S16 y, S16 x_start, S16 x_end, World_t* world, Camera_t* camera,
+                                   const DrawTextures_t* textures){
+     for(S16 x = x_start; x <= x_end; x++){
+          Coord_t coord {x, y};
+          Interactive_t* interactive = quad_tree_find_at(world->interactive_qt, coord.x, coord.y);
+          if(!is_active_portal(interactive)) continue;
+
+          PortalExit_t portal_exits = find_portal_exits(coord, &world->tilemap, world->interactive_qt);
+
+          for(S8 d = 0; d < DIRECTION_COUNT; d++){
+               for(S8 i = 0; i < portal_exits.directions[d].count; i++){
+                    if(portal_exits.directions[d].coords[i] == coord) continue;
+                    Coord_t portal_coord = portal_exits.directions[d].coords[i] + direction_opposite((Direction_t)(d));
+                    Rect_t coord_rect = rect_surrounding_coord(portal_coord);
+                    coord_rect.left -= HALF_TILE_SIZE_IN_PIXELS;
+                    coord_rect.right += HALF_TILE_SIZE_IN_PIXELS;
+                    coord_rect.bottom -= TILE_SIZE_IN_PIXELS;
+                    coord_rect.top += HALF_TILE_SIZE_IN_PIXELS;
+
+                    QuadTreeResults_t<Block_t> blocks;
+
+                    U8 portal_rotations = portal_rotations_between((Direction_t)(d), interactive->portal.face);
+
+                    quad_tree_find_in(world->block_qt, coord_rect, &blocks);
+                    if(blocks.count){
+                         sort_blocks_by_descending_height(blocks.entries(), blocks.count);
+                         draw_portal_blocks(blocks.entries(), blocks.count, portal_coord, coord, portal_rotations, camera->world_offset);
+                    }
+                    destroy(&blocks);
+
+                    render_bind_texture(&textures->player);
+                    render_color(1.0f, 1.0f, 1.0f);
+
+                    auto player_region = rect_surrounding_coord(portal_coord);
+                    player_region.left -= 4;
+                    player_region.right += 4;
+                    player_region.bottom -= 10;
+                    player_region.top += 4;
+                    draw_portal_players(&world->players, player_region, portal_coord, coord, portal_rotations, camera->world_offset);
+
+                    render_bind_texture(&textures->theme);
+                    render_color(1.0f, 1.0f, 1.0f);
+               }
+          }
+     }
+}
+
+void destroy(FlatsCache_t* cache){
+     S32 chunk_count = cache->chunks_wide * cache->chunks_tall;
+     for(S32 i = 0; i < chunk_count; i++){
+          destroy(&cache->chunks[i].buffer);
+          destroy(&cache->chunks[i].portals);
+     }
+     free(cache->chunks);
+     *cache = FlatsCache_t{};
+}
+
+static bool flats_cache_matches(FlatsCache_t* cache, TileMap_t* tilemap, Vec_t world_offset){
+     return cache->chunks && cache->tiles == tilemap->tiles && cache->width == tilemap->width &&
+            cache->height == tilemap->height && cache->world_offset.x == world_offset.x &&
+            cache->world_offset.y == world_offset.y;
+}
+
+static void flats_chunk_rebuild(FlatsChunk_t* chunk, S16 chunk_x, S16 chunk_y, World_t* world, Vec_t world_offset,
+                                const DrawTextures_t* textures){
+     chunk->buffer.count = 0;
+     destroy(&chunk->portals);
+
+     S16 x_start = chunk_x * ROOM_TILE_SIZE;
+     S16 y_start = chunk_y * ROOM_TILE_SIZE;
+     S16 x_end = MINIMUM(x_start + ROOM_TILE_SIZE, world->tilemap.width);
+     S16 y_end = MINIMUM(y_start + ROOM_TILE_SIZE, world->tilemap.height);
+
+     RenderBuffer_t* frame_buffer = render_current_buffer();
+     render_begin(&chunk->buffer);
+     render_bind_texture(&textures->theme);
+
+     for(S16 y = y_start; y < y_start + ROOM_TILE_SIZE; y++){
+          chunk->row_starts[y - y_start] = chunk->buffer.count;
+          if(y >= y_end) continue;
+
+          for(S16 x = x_start; x < x_end; x++){
+               Coord_t coord {x, y};
+               Interactive_t* interactive = quad_tree_find_at(world->interactive_qt, x, y);
+               if(interactive && interactive->type == INTERACTIVE_TYPE_PORTAL){
+                    resize(&chunk->portals, chunk->portals.count + (S16)(1));
+                    chunk->portals.elements[chunk->portals.count - 1] = coord;
+                    continue;
+               }
+
+               Vec_t draw_pos = Vec_t{(F32)(x) * TILE_SIZE, (F32)(y) * TILE_SIZE} + world_offset;
+               draw_flats(draw_pos, tilemap_get_tile(&world->tilemap, coord), interactive, 0);
+          }
+     }
+     chunk->row_starts[ROOM_TILE_SIZE] = chunk->buffer.count;
+
+     render_begin(frame_buffer);
+}
+
+static void flats_cache_update(FlatsCache_t* cache, World_t* world, Vec_t world_offset, const DrawTextures_t* textures){
+     TileMap_t* tilemap = &world->tilemap;
+
+     if(!flats_cache_matches(cache, tilemap, world_offset)){
+          destroy(cache);
+
+          cache->chunks_wide = tilemap_chunks_wide(tilemap);
+          cache->chunks_tall = tilemap_chunks_tall(tilemap);
+          cache->chunks = (FlatsChunk_t*)(calloc(cache->chunks_wide * cache->chunks_tall, sizeof(*cache->chunks)));
+          if(!cache->chunks){
+               LOG("%s() failed to calloc %dx%d flats chunks\n", __FUNCTION__, cache->chunks_wide, cache->chunks_tall);
+               *cache = FlatsCache_t{};
+               return;
+          }
+
+          cache->tiles = tilemap->tiles;
+          cache->width = tilemap->width;
+          cache->height = tilemap->height;
+          cache->world_offset = world_offset;
+          tilemap_mark_all_flats_dirty(tilemap);
+     }
+
+     if(!tilemap->flats_dirty) return;
+
+     for(S16 chunk_y = 0; chunk_y < cache->chunks_tall; chunk_y++){
+          for(S16 chunk_x = 0; chunk_x < cache->chunks_wide; chunk_x++){
+               S32 index = chunk_y * cache->chunks_wide + chunk_x;
+               if(!tilemap->flats_dirty[index]) continue;
+
+               flats_chunk_rebuild(cache->chunks + index, chunk_x, chunk_y, world, world_offset, textures);
+               tilemap->flats_dirty[index] = false;
+          }
+     }
+}
+
+static void draw_world_row_cached_flats(S16 y, S16 x_start, S16 x_end, World_t* world, FlatsCache_t* cache,
+                                        Vec_t world_offset){
+     S16 chunk_y = y / ROOM_TILE_SIZE;
+     S16 row = y % ROOM_TILE_SIZE;
+
+     for(S16 chunk_x = x_start / ROOM_TILE_SIZE; chunk_x <= x_end / ROOM_TILE_SIZE; chunk_x++){
+          FlatsChunk_t* chunk = cache->chunks + (chunk_y * cache->chunks_wide + chunk_x);
+
+          S32 row_start = chunk->row_starts[row];
+          render_append(chunk->buffer.commands + row_start, chunk->row_starts[row + 1] - row_start);
+
+          for(S16 p = 0; p < chunk->portals.count; p++){
+               Coord_t coord = chunk->portals.elements[p];
+               if(coord.y != y) continue;
+               draw_world_row_flats(y, coord.x, coord.x, &world->tilemap, world->interactive_qt, world_offset);
+          }
+     }
+}
+
+void draw_world(World_t* world, Camera_t* camera, const DrawTextures_t* textures, FlatsCache_t* flats_cache){
+     Coord_t min;
+     Coord_t max;
+     draw_world_visible_range(world, camera, &min, &max);
+
+     if(flats_cache){
+          flats_cache_update(flats_cache, world, camera->world_offset, textures);
+          if(!flats_cache->chunks) flats_cache = nullptr;
+     }
+
+     render_view(camera->view);
+
+     render_bind_texture(&textures->theme);
+     render_color(1.0f, 1.0f, 1.0f);
+
+     // each row is recorded once, the layers put the flats of every row under the portals under the tile ids under
+     // the solids when the buffer is sorted
+     for(S16 y = max.y; y >= min.y; y--){
+          render_layer(DRAW_LAYER_FLATS, y);
+          if(flats_cache){
+               draw_world_row_cached_flats(y, min.x, max.x, world, flats_cache, camera->world_offset);
+          }else{
+               draw_world_row_flats(y, min.x, max.x, &world->tilemap, world->interactive_qt, camera->world_offset);
+          }
+
+          // only the visible source portals are scanned, what comes through them is found by looking around the
+          // exits, which may be anywhere on the map
+          render_layer(DRAW_LAYER_PORTALS, y);
+          draw_world_row_portals(y, min.x, max.x, world, camera, textures);
+
+          render_layer(DRAW_LAYER_TILE_IDS, y);
+          for(S16 x = min.x; x <= max.x; x++){
+               Tile_t* tile = tilemap_get_tile(&world->tilemap, Coord_t{x, y});
+               if(tile && tile->id >= 16){
+                    Vec_t tile_pos {(F32)(x) * TILE_SIZE + camera->world_offset.x,
+                                    (F32)(y) * TILE_SIZE + camera->world_offset.y};
+                    draw_tile_id(tile->id, tile_pos);
+               }
+          }
+
+          render_layer(DRAW_LAYER_SOLIDS, y);
+          draw_world_row_solids(y, min.x, max.x, &world->tilemap, world->interactive_qt, world->block_qt,
+                                &world->players, camera->world_offset, &textures->theme, &textures->player);
+
+          render_bind_texture(&textures->arrow);
+          render_color(1.0f, 1.0f, 1.0f);
+
+          draw_world_row_arrows(y, min.x, max.x, &world->arrows, camera->world_offset);
+
+          render_bind_texture(&textures->theme);
+          render_color(1.0f, 1.0f, 1.0f);
+     }
+
+     render_layer(0, 0);
+}
+
 void draw_text(const char* message, Vec_t pos, Vec_t dim, F32 spacing)
 {
      char c;
@@ -787,15 +900,14 @@ static Block_t block_from_stamp(Stamp_t* stamp){
 }
 
 void draw_editor(Editor_t* editor, World_t* world, Camera_t* camera, Vec_t mouse_screen,
-                 GLuint theme_texture, GLuint text_texture){
+                 const Texture_t* theme_texture, const Texture_t* text_texture){
      switch(editor->mode){
      default:
           break;
      case EDITOR_MODE_CATEGORY_SELECT:
      {
-          glBindTexture(GL_TEXTURE_2D, theme_texture);
-          glBegin(GL_QUADS);
-          glColor3f(1.0f, 1.0f, 1.0f);
+          render_bind_texture(theme_texture);
+          render_color(1.0f, 1.0f, 1.0f);
 
           Vec_t vec = {0.0f, 0.0f};
 
@@ -834,19 +946,14 @@ void draw_editor(Editor_t* editor, World_t* world, Camera_t* camera, Vec_t mouse
 
                vec.x += TILE_SIZE;
           }
-
-          glEnd();
      } break;
      case EDITOR_MODE_STAMP_SELECT:
      case EDITOR_MODE_STAMP_HIDE:
      {
-          glMatrixMode(GL_PROJECTION);
-          glLoadIdentity();
-          glOrtho(camera->view.left, camera->view.right, camera->view.bottom, camera->view.top, 0.0, 1.0);
+          render_view(camera->view);
 
-          glBindTexture(GL_TEXTURE_2D, theme_texture);
-          glBegin(GL_QUADS);
-          glColor3f(1.0f, 1.0f, 1.0f);
+          render_bind_texture(theme_texture);
+          render_color(1.0f, 1.0f, 1.0f);
 
           // draw stamp at mouse
           auto* stamp_array = editor->category_array.elements[editor->category].elements + editor->stamp;
@@ -876,12 +983,8 @@ void draw_editor(Editor_t* editor, World_t* world, Camera_t* camera, Vec_t mouse
                } break;
                }
           }
-          glEnd();
-
-          glLoadIdentity();
-          glOrtho(0.0f, 1.0f, 0.0f, 1.0f, 0.0, 1.0);
 
-          glBegin(GL_QUADS);
+          render_view(Quad_t{0.0f, 0.0f, 1.0f, 1.0f});
 
           if(editor->mode == EDITOR_MODE_STAMP_SELECT){
                // draw stamps to select from at the bottom
@@ -928,21 +1031,16 @@ void draw_editor(Editor_t* editor, World_t* world, Camera_t* camera, Vec_t mouse
                     }
                }
           }
-
-          glEnd();
      } break;
      case EDITOR_MODE_CREATE_SELECTION:
           draw_selection(editor->selection_start, editor->selection_end, camera, 1.0f, 0.0f, 0.0f);
           break;
      case EDITOR_MODE_SELECTION_MANIPULATION:
      {
-          glMatrixMode(GL_PROJECTION);
-          glLoadIdentity();
-          glOrtho(camera->view.left, camera->view.right, camera->view.bottom, camera->view.top, 0.0, 1.0);
+          render_view(camera->view);
 
-          glBindTexture(GL_TEXTURE_2D, theme_texture);
-          glBegin(GL_QUADS);
-          glColor3f(1.0f, 1.0f, 1.0f);
+          render_bind_texture(theme_texture);
+          render_color(1.0f, 1.0f, 1.0f);
 
           for(S32 g = 0; g < editor->selection.count; ++g){
                auto* stamp = editor->selection.elements + g;
@@ -973,10 +1071,8 @@ void draw_editor(Editor_t* editor, World_t* world, Camera_t* camera, Vec_t mouse
                } break;
                }
           }
-          glEnd();
 
-          glLoadIdentity();
-          glOrtho(0.0f, 1.0f, 0.0f, 1.0f, 0.0, 1.0);
+          render_view(Quad_t{0.0f, 0.0f, 1.0f, 1.0f});
 
           Rect_t selection_bounds = editor_selection_bounds(editor);
           Coord_t min_coord {selection_bounds.left, selection_bounds.bottom};
@@ -986,9 +1082,8 @@ void draw_editor(Editor_t* editor, World_t* world, Camera_t* camera, Vec_t mouse
      }
 
      if(editor->mode){
-          glBindTexture(GL_TEXTURE_2D, text_texture);
-          glBegin(GL_QUADS);
-          glColor3f(1.0f, 1.0f, 1.0f);
+          render_bind_texture(text_texture);
+          render_color(1.0f, 1.0f, 1.0f);
 
           auto mouse_world = vec_to_pos(mouse_screen);
           auto mouse_coord = pos_to_coord(mouse_world);
@@ -997,26 +1092,47 @@ void draw_editor(Editor_t* editor, World_t* world, Camera_t* camera, Vec_t mouse
 
           Vec_t text_pos {0.005f, 0.965f};
 
-          glColor3f(0.0f, 0.0f, 0.0f);
+          render_color(0.0f, 0.0f, 0.0f);
           draw_text(buffer, text_pos + Vec_t{0.002f, -0.002f});
 
-          glColor3f(1.0f, 1.0f, 1.0f);
+          render_color(1.0f, 1.0f, 1.0f);
           draw_text(buffer, text_pos);
 
           Player_t* player = world->players.elements;
           snprintf(buffer, 64, "P: %d,%d,%d R: %d", player->pos.pixel.x, player->pos.pixel.y, player->pos.z, player->rotation);
           text_pos.y -= 0.045f;
 
-          glColor3f(0.0f, 0.0f, 0.0f);
+          render_color(0.0f, 0.0f, 0.0f);
           draw_text(buffer, text_pos + Vec_t{0.002f, -0.002f});
 
-          glColor3f(1.0f, 1.0f, 1.0f);
+          render_color(1.0f, 1.0f, 1.0f);
           draw_text(buffer, text_pos);
-
-          glEnd();
      }
 }
 
+bool load_draw_textures(DrawTextures_t* textures, bool upload_to_gpu){
+     // only the atlas goes to the gpu
+     textures->theme = texture_from_file("content/theme.bmp", false);
+     if(!textures->theme.bitmap.pixels) return false;
+     textures->player = texture_from_file("content/player.bmp", false);
+     if(!textures->player.bitmap.pixels) return false;
+     textures->arrow = texture_from_file("content/arrow.bmp", false);
+     if(!textures->arrow.bitmap.pixels) return false;
+     textures->text = texture_from_file("content/text.bmp", false);
+     if(!textures->text.bitmap.pixels) return false;
+
+     Texture_t* atlas_textures[] = {&textures->theme, &textures->player, &textures->arrow, &textures->text};
+     return texture_atlas_pack(&textures->atlas, atlas_textures, (S16)(ELEM_COUNT(atlas_textures)), upload_to_gpu);
+}
+
+void destroy(DrawTextures_t* textures){
+     destroy(&textures->theme);
+     destroy(&textures->player);
+     destroy(&textures->arrow);
+     destroy(&textures->text);
+     destroy(&textures->atlas);
+}
+
 void draw_checkbox(Checkbox_t* checkbox, Vec_t scroll){
     Vec_t pos = checkbox->pos + scroll;
     Vec_t dim {CHECKBOX_DIMENSION, CHECKBOX_DIMENSION};
@@ -11,8 +11,9 @@
 #include "arrow.h"
 #include "quad.h"
 #include "ui.h"
-
-#include <SDL2/SDL_opengl.h>
+#include "render.h"
+#include "defines.h"
+#include "object_array.h"
 
 #define THEME_FRAMES_WIDE (S16)(16)
 #define THEME_FRAMES_TALL (S16)(32)
@@ -35,17 +36,57 @@
 #define TEXT_CHAR_TEX_WIDTH 0.01953125f
 #define TEXT_CHAR_TEX_HEIGHT 1.0f
 
+#define DRAW_CULL_MARGIN_TILES (S16)(1)
+#define DRAW_CULL_RAISED_MARGIN_TILES (S16)(4)
+
 // forward declarations
 struct Editor_t;
 struct World_t;
 
+// world sprites are recorded a row at a time and drawn in this order once the render buffer is sorted
+enum DrawLayer_t : U16{
+     DRAW_LAYER_FLATS = 1,
+     DRAW_LAYER_PORTALS,
+     DRAW_LAYER_TILE_IDS,
+     DRAW_LAYER_SOLIDS,
+};
+
+// flats recorded once per ROOM_TILE_SIZE chunk of the tilemap and replayed every frame until the tilemap marks the
+// chunk dirty. portal tiles show whatever is at their exits so they are always drawn live
+struct FlatsChunk_t{
+     RenderBuffer_t buffer;
+     S32 row_starts[ROOM_TILE_SIZE + 1]; // row y of the chunk is commands [row_starts[y], row_starts[y + 1])
+     ObjectArray_t<Coord_t> portals;
+};
+
+struct FlatsCache_t{
+     FlatsChunk_t* chunks = nullptr;
+     S16 chunks_wide = 0;
+     S16 chunks_tall = 0;
+
+     // what the chunks were recorded against, if any of these change everything is rebuilt
+     Tile_t** tiles = nullptr;
+     S16 width = 0;
+     S16 height = 0;
+     Vec_t world_offset {};
+};
+
+void destroy(FlatsCache_t* cache);
+
+struct DrawTextures_t{
+     Texture_t theme;
+     Texture_t player;
+     Texture_t arrow;
+     Texture_t text;
+     Texture_t atlas; // the four above packed together
+};
+
 Vec_t theme_frame(S16 x, S16 y);
 Vec_t arrow_frame(S16 x, S16 y);
 Vec_t player_frame(S16 x, S16 y);
 
-GLuint create_texture_from_bitmap(AlphaBitmap_t* bitmap);
-GLuint transparent_texture_from_file(const char* filepath);
-GLuint transparent_texture_from_raw_bitmap(Raw_t* raw);
+bool load_draw_textures(DrawTextures_t* textures, bool upload_to_gpu);
+void destroy(DrawTextures_t* textures);
 
 void draw_screen_texture(Vec_t pos, Vec_t tex, Vec_t dim, Vec_t tex_dim);
 void draw_theme_frame(Vec_t tex_vec, Vec_t pos_vec);
@@ -55,15 +96,11 @@ void draw_tile_flags(U16 flags, Vec_t tile_pos);
 void draw_interactive(Interactive_t* interactive, Vec_t pos_vec, Coord_t coord,
                       TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_quad_tree);
 void draw_flats(Vec_t pos, Tile_t* tile, Interactive_t* interactive, U8 portal_rotations);
-void draw_solids(Vec_t pos, Interactive_t* interactive, Block_t** blocks, S16 block_count,
-                 ObjectArray_t<Player_t>* players, bool* draw_players,
-                 Position_t screen_camera, GLuint theme_texture, GLuint player_texture,
-                 Coord_t source_coord, Coord_t destination_coord, U8 portal_rotations,
-                 TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_quad_tree);
 void draw_world_row_flats(S16 y, S16 x_start, S16 x_end, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_qt,
                           Vec_t camera);
 void draw_world_row_solids(S16 y, S16 x_start, S16 x_end, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_qt,
-                           QuadTreeNode_t<Block_t>* block_qt, ObjectArray_t<Player_t>* players, Vec_t camera, GLuint player_texture);
+                           QuadTreeNode_t<Block_t>* block_qt, ObjectArray_t<Player_t>* players, Vec_t camera,
+                           const Texture_t* theme_texture, const Texture_t* player_texture);
 void draw_world_row_arrows(S16 y, S16 x_start, S16 x_end, const ArrowArray_t* arrow_aray, Vec_t camera);
 void draw_portal_blocks(Block_t** blocks, S16 block_count, Coord_t source_coord, Coord_t destination_coord, S8 portal_rotations, Vec_t camera);
 void draw_portal_players(ObjectArray_t<Player_t>* players, Rect_t region, Coord_t source_coord, Coord_t destination_coord,
@@ -75,5 +112,8 @@ void draw_selection(Coord_t selection_start, Coord_t selection_end, Camera_t* ca
 
 void draw_text(const char* message, Vec_t pos, Vec_t dim = Vec_t{TEXT_CHAR_WIDTH, TEXT_CHAR_HEIGHT}, F32 spacing = TEXT_CHAR_SPACING);
 void draw_editor(Editor_t* editor, World_t* world, Camera_t* camera, Vec_t mouse_screen,
-                 GLuint theme_texture, GLuint text_texture);
+                 const Texture_t* theme_texture, const Texture_t* text_texture);
+void draw_world_visible_range(World_t* world, Camera_t* camera, Coord_t* min, Coord_t* max);
+// without a flats cache the flats are recorded from scratch
+void draw_world(World_t* world, Camera_t* camera, const DrawTextures_t* textures, FlatsCache_t* flats_cache = nullptr);
 void draw_checkbox(Checkbox_t* checkbox, Vec_t scroll);
@@ -429,6 +429,9 @@ Coord_t stamp_array_dimensions(ObjectArray_t<Stamp_t>* object_array){
 
 void apply_stamp(Stamp_t* stamp, Coord_t coord, TileMap_t* tilemap, ObjectArray_t<Block_t>* block_array, ObjectArray_t<Interactive_t>* interactive_array,
                  QuadTreeNode_t<Interactive_t>** interactive_quad_tree, bool combine){
+     tilemap_mark_flats_dirty(tilemap, coord);
+     tilemap_invalidate_portal_exits(tilemap);
+
      switch(stamp->type){
      default:
           break;
@@ -495,6 +498,9 @@ void apply_stamp(Stamp_t* stamp, Coord_t coord, TileMap_t* tilemap, ObjectArray_
 // editor.h
 void coord_clear(Coord_t coord, TileMap_t* tilemap, ObjectArray_t<Interactive_t>* interactive_array,
                  QuadTreeNode_t<Interactive_t>* interactive_quad_tree, ObjectArray_t<Block_t>* block_array){
+     tilemap_mark_flats_dirty(tilemap, coord);
+     tilemap_invalidate_portal_exits(tilemap);
+
      Tile_t* tile = tilemap_get_tile(tilemap, coord);
      if(tile){
           tile->id = 0;
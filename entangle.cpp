@@ -0,0 +1,102 @@
+#include "entangle.h"
+#include "log.h"
+
+#include <stdlib.h>
+
+static bool entangle_table_reserve(EntangleTable_t* table, S16 block_count){
+     if(block_count <= table->allocated) return true;
+
+     auto* groups = (EntangleGroup_t*)(realloc(table->groups, block_count * sizeof(*table->groups)));
+     if(groups) table->groups = groups;
+     auto* members = (S16*)(realloc(table->members, block_count * sizeof(*table->members)));
+     if(members) table->members = members;
+     auto* member_slots = (S16*)(realloc(table->member_slots, block_count * sizeof(*table->member_slots)));
+     if(member_slots) table->member_slots = member_slots;
+     auto* block_groups = (S16*)(realloc(table->block_groups, block_count * sizeof(*table->block_groups)));
+     if(block_groups) table->block_groups = block_groups;
+
+     if(!groups || !members || !member_slots || !block_groups){
+          LOG("%s() failed to realloc entangle table for %d blocks\n", __FUNCTION__, block_count);
+          return false;
+     }
+
+     table->allocated = block_count;
+     return true;
+}
+
+bool entangle_table_build(EntangleTable_t* table, ObjectArray_t<Block_t>* blocks){
+     table->group_count = 0;
+     table->block_count = 0;
+
+     for(S16 i = 0; i < blocks->count; i++) blocks->elements[i].entangle_group = -1;
+
+     if(!entangle_table_reserve(table, blocks->count)) return false;
+
+     table->block_count = blocks->count;
+     for(S16 i = 0; i < blocks->count; i++){
+          table->member_slots[i] = -1;
+          table->block_groups[i] = -1;
+     }
+
+     S16 member_count = 0;
+     for(S16 i = 0; i < blocks->count; i++){
+          if(table->member_slots[i] >= 0) continue;
+          if(blocks->elements[i].entangle_index < 0) continue;
+
+          // follow the ring, it only becomes a group if it makes it back around to where it started
+          S16 first_member = member_count;
+          S16 index = i;
+          bool ring = false;
+          while(index >= 0 && index < blocks->count && table->member_slots[index] < 0){
+               table->member_slots[index] = member_count;
+               table->members[member_count] = index;
+               member_count++;
+
+               index = blocks->elements[index].entangle_index;
+               if(index == i){
+                    ring = true;
+                    break;
+               }
+          }
+
+          // a chain that leads into someone else's ring (a block split off an entangled block) isn't a group
+          if(!ring || member_count - first_member < 2){
+               for(S16 m = first_member; m < member_count; m++) table->member_slots[table->members[m]] = -1;
+               member_count = first_member;
+               continue;
+          }
+
+          EntangleGroup_t* group = table->groups + table->group_count;
+          group->first_member = first_member;
+          group->member_count = member_count - first_member;
+          for(S16 m = first_member; m < member_count; m++){
+               S16 member = table->members[m];
+               table->block_groups[member] = table->group_count;
+               blocks->elements[member].entangle_group = table->group_count;
+          }
+          table->group_count++;
+     }
+
+     return true;
+}
+
+S16 entangle_group_size(const EntangleTable_t* table, S16 block_index){
+     if(block_index < 0 || block_index >= table->block_count) return 0;
+     S16 group = table->block_groups[block_index];
+     if(group < 0) return 0;
+     return table->groups[group].member_count;
+}
+
+S16 entangle_member_after(const EntangleTable_t* table, S16 block_index, S16 offset){
+     const EntangleGroup_t* group = table->groups + table->block_groups[block_index];
+     S16 position = (S16)(table->member_slots[block_index] - group->first_member);
+     return table->members[group->first_member + (position + offset) % group->member_count];
+}
+
+void destroy(EntangleTable_t* table){
+     free(table->groups);
+     free(table->members);
+     free(table->member_slots);
+     free(table->block_groups);
+     *table = EntangleTable_t{};
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "block.h"
+#include "object_array.h"
+
+// entangled blocks form a ring through entangle_index, the table flattens each ring into a group so checking if
+// two blocks are entangled is a compare and walking a ring doesn't chase indices through the block array. it has
+// to be rebuilt whenever blocks are added, removed or have their entangle_index changed
+
+struct EntangleGroup_t{
+     S16 first_member; // into EntangleTable_t::members
+     S16 member_count;
+};
+
+struct EntangleTable_t{
+     EntangleGroup_t* groups = nullptr;
+     S16 group_count = 0;
+
+     S16* members = nullptr; // the block indices of every group back to back, in ring order
+     S16* member_slots = nullptr; // per block, where it is in members, -1 when not entangled
+     S16* block_groups = nullptr; // per block, -1 when not entangled
+     S16 block_count = 0;
+     S16 allocated = 0;
+};
+
+// also sets every block's entangle_group
+bool entangle_table_build(EntangleTable_t* table, ObjectArray_t<Block_t>* blocks);
+
+// the number of blocks in the block's group including itself, 0 when it isn't entangled
+S16 entangle_group_size(const EntangleTable_t* table, S16 block_index);
+
+// the block offset places further around the ring, an offset of 1 is the block's entangle_index
+S16 entangle_member_after(const EntangleTable_t* table, S16 block_index, S16 offset);
+
+void destroy(EntangleTable_t* table);
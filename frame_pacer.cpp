@@ -0,0 +1,92 @@
+#include "frame_pacer.h"
+
+#include <thread>
+
+static F64 frame_pacer_seconds(std::chrono::steady_clock::duration duration){
+     return std::chrono::duration<F64>(duration).count();
+}
+
+// moves the time since the last call into the accumulator, dropping whatever is past the catch up cap
+static void frame_pacer_advance(FramePacer_t* pacer){
+     auto now = std::chrono::steady_clock::now();
+     if(!pacer->started){
+          pacer->last_time = now;
+          pacer->last_present = now;
+          pacer->started = true;
+     }
+
+     pacer->accumulator += frame_pacer_seconds(now - pacer->last_time);
+     pacer->last_time = now;
+
+     F64 max_accumulator = pacer->frame_time * FRAME_PACER_MAX_CATCH_UP_FRAMES;
+     if(pacer->accumulator > max_accumulator){
+          pacer->dropped_frames += (S64)((pacer->accumulator - max_accumulator) / pacer->frame_time);
+          pacer->accumulator = max_accumulator;
+     }
+}
+
+void frame_pacer_reset(FramePacer_t* pacer, F64 frame_time){
+     *pacer = FramePacer_t{};
+     pacer->frame_time = frame_time;
+}
+
+void frame_pacer_wait(FramePacer_t* pacer){
+     frame_pacer_advance(pacer);
+
+     if(pacer->accumulator >= pacer->frame_time){
+          // already behind, step right away
+          if(pacer->stepped_frames > 0) pacer->caught_up_frames++;
+     }else{
+          while(pacer->accumulator < pacer->frame_time){
+               F64 remaining = pacer->frame_time - pacer->accumulator;
+               if(remaining > FRAME_PACER_SPIN_SECONDS){
+                    std::this_thread::sleep_for(std::chrono::duration<F64>(remaining - FRAME_PACER_SPIN_SECONDS));
+               }else{
+                    std::this_thread::yield();
+               }
+               frame_pacer_advance(pacer);
+          }
+     }
+
+     pacer->accumulator -= pacer->frame_time;
+     pacer->stepped_frames++;
+}
+
+S32 frame_pacer_frames_due(FramePacer_t* pacer){
+     frame_pacer_advance(pacer);
+     return (S32)(pacer->accumulator / pacer->frame_time);
+}
+
+void frame_pacer_presented(FramePacer_t* pacer){
+     auto now = std::chrono::steady_clock::now();
+     if(!pacer->started){
+          pacer->last_present = now;
+          return;
+     }
+
+     pacer->frame_ms[pacer->frame_ms_index] = (F32)(frame_pacer_seconds(now - pacer->last_present) * 1000.0);
+     pacer->frame_ms_index = (pacer->frame_ms_index + 1) % FRAME_PACER_HISTORY;
+     if(pacer->frame_ms_count < FRAME_PACER_HISTORY) pacer->frame_ms_count++;
+     pacer->last_present = now;
+}
+
+FramePacerStats_t frame_pacer_stats(const FramePacer_t* pacer){
+     FramePacerStats_t stats {};
+     stats.caught_up_frames = pacer->caught_up_frames;
+     stats.dropped_frames = pacer->dropped_frames;
+     if(pacer->frame_ms_count == 0) return stats;
+
+     F32 late_frame_ms = (F32)(pacer->frame_time * 1000.0 * FRAME_PACER_LATE_FRAMES);
+     F32 total = 0.0f;
+     stats.frame_ms_min = pacer->frame_ms[0];
+     stats.frame_ms_max = pacer->frame_ms[0];
+     for(S32 i = 0; i < pacer->frame_ms_count; i++){
+          F32 frame_ms = pacer->frame_ms[i];
+          total += frame_ms;
+          if(frame_ms < stats.frame_ms_min) stats.frame_ms_min = frame_ms;
+          if(frame_ms > stats.frame_ms_max) stats.frame_ms_max = frame_ms;
+          if(frame_ms > late_frame_ms) stats.late_frames++;
+     }
+     stats.frame_ms_average = total / (F32)(pacer->frame_ms_count);
+     return stats;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "types.h"
+#include "defines.h"
+
+#include <chrono>
+
+#define FRAME_PACER_HISTORY 120
+#define FRAME_PACER_SPIN_SECONDS 0.002     // how long before a frame is due to stop sleeping and spin instead
+#define FRAME_PACER_MAX_CATCH_UP_FRAMES 4  // frames stepped back to back when behind, anything past this is dropped
+#define FRAME_PACER_LATE_FRAMES 1.5        // a presented frame taking longer than this many frame_times counts as late
+
+// fixed timestep pacing on the monotonic clock. elapsed time piles up in an accumulator and is handed out a frame_time
+// at a time, so the world always steps by the same amount no matter how unevenly the loop gets around to it. waiting
+// for the next frame sleeps until shortly before it is due, since sleeping overshoots by up to a scheduler tick, then
+// spins the rest of the way. a loop that fell behind gets several frames at once to catch up with, at most
+// FRAME_PACER_MAX_CATCH_UP_FRAMES, whatever it fell behind by past that is let go rather than leaving it running flat
+// out for as long again
+struct FramePacer_t{
+     F64 frame_time = FRAME_TIME;
+     F64 accumulator = 0.0;
+     std::chrono::steady_clock::time_point last_time {};
+     bool started = false;
+
+     // how long each of the last FRAME_PACER_HISTORY presented frames took, in milliseconds
+     F32 frame_ms[FRAME_PACER_HISTORY];
+     S32 frame_ms_count = 0;
+     S32 frame_ms_index = 0;
+     std::chrono::steady_clock::time_point last_present {};
+
+     S64 stepped_frames = 0;
+     S64 caught_up_frames = 0; // stepped without having to wait for them
+     S64 dropped_frames = 0;
+};
+
+struct FramePacerStats_t{
+     F32 frame_ms_average = 0.0f;
+     F32 frame_ms_min = 0.0f;
+     F32 frame_ms_max = 0.0f;
+     S32 late_frames = 0; // of the frames in the history, how many were late
+     S64 caught_up_frames = 0;
+     S64 dropped_frames = 0;
+};
+
+void frame_pacer_reset(FramePacer_t* pacer, F64 frame_time);
+
+// blocks until a frame is due and takes it out of the accumulator
+void frame_pacer_wait(FramePacer_t* pacer);
+
+// how many frames are due right now, without waiting or taking any
+S32 frame_pacer_frames_due(FramePacer_t* pacer);
+
+// call once a frame has been presented, the time since the last call goes in the history
+void frame_pacer_presented(FramePacer_t* pacer);
+
+FramePacerStats_t frame_pacer_stats(const FramePacer_t* pacer);
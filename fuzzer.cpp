@@ -0,0 +1,480 @@
+#include "fuzzer.h"
+#include "world.h"
+#include "world_step.h"
+#include "world_snapshot.h"
+#include "block_utils.h"
+#include "map_format.h"
+#include "conversion.h"
+#include "defines.h"
+#include "log.h"
+
+#include <chrono>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <math.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+
+#define FUZZER_ENTRY_START_SIZE 1024
+#define FUZZER_SIGNAL_STACK_SIZE (64 * 1024)
+
+// a map as it was loaded, kept around to start runs from and to write crash demos against
+struct FuzzerMap_t{
+     const char* filepath = nullptr;
+     Coord_t player_start;
+     TileMap_t tilemap {};
+     ObjectArray_t<Block_t> blocks {};
+     ObjectArray_t<Interactive_t> interactives {};
+     ObjectArray_t<Player_t> players {}; // where they start, after reset_map()
+     WorldSnapshot_t start {};
+
+     // what a crash demo ends with, serialized ahead of time since the signal handler can't allocate or use stdio
+     char* crash_end_state = nullptr;
+     size_t crash_end_state_size = 0;
+};
+
+struct FuzzerWorker_t{
+     S32 id = 0;
+     World_t world {};
+     Undo_t undo {};
+     FuzzerMap_t* undo_map = nullptr; // the map undo was sized for
+     FrameContext_t context {};
+     PlayerAction_t action {};
+     U64 rng = 0;
+
+     // the run in progress
+     FuzzerMap_t* map = nullptr;
+     char demo_filepath[256]; // where its demo goes if it fails
+     S64 frame_count = 0;
+     DemoEntry_t* entries = nullptr;
+     S64 entry_count = 0;
+     S64 entry_allocated = 0;
+
+     // what the input is in the middle of doing, and for how many more frames
+     bool held[DIRECTION_COUNT];
+     bool activating = false;
+     bool shooting = false;
+     S32 hold_frames = 0;
+
+     S64 total_frame_count = 0;
+     S64 run_count = 0;
+     S32 failure_count = 0;
+};
+
+struct FuzzerShared_t{
+     const FuzzerOptions_t* options = nullptr;
+     FuzzerMap_t* maps = nullptr;
+     S32 map_count = 0;
+     std::chrono::steady_clock::time_point end_time;
+};
+
+// the worker whose run the signal handler writes out, set on each fuzzing thread
+static thread_local FuzzerWorker_t* fuzzer_current = nullptr;
+static const char* fuzzer_demo_prefix = "fuzz";
+static int fuzzer_log_fd = -1;
+
+static U64 fuzzer_random(FuzzerWorker_t* worker){
+     // splitmix64
+     U64 x = (worker->rng += 0x9e3779b97f4a7c15ULL);
+     x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+     x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+     return x ^ (x >> 31);
+}
+
+static S32 fuzzer_random_range(FuzzerWorker_t* worker, S32 min, S32 max){
+     return min + (S32)(fuzzer_random(worker) % (U64)(max - min + 1));
+}
+
+static void fuzzer_perform(FuzzerWorker_t* worker, PlayerActionType_t type){
+     player_action_perform(&worker->action, &worker->world.players, type, DEMO_MODE_NONE, nullptr, worker->frame_count);
+
+     if(worker->entry_count >= worker->entry_allocated){
+          S64 allocated = worker->entry_allocated ? worker->entry_allocated * 2 : FUZZER_ENTRY_START_SIZE;
+          DemoEntry_t* entries = (DemoEntry_t*)(realloc(worker->entries, (size_t)(allocated) * sizeof(*entries)));
+          if(!entries) return;
+          worker->entries = entries;
+          worker->entry_allocated = allocated;
+     }
+     worker->entries[worker->entry_count++] = DemoEntry_t{worker->frame_count, type};
+}
+
+static PlayerActionType_t fuzzer_move_action(Direction_t direction, bool start){
+     return (PlayerActionType_t)(PLAYER_ACTION_TYPE_MOVE_LEFT_START + direction * 2 + (start ? 0 : 1));
+}
+
+static void fuzzer_release(FuzzerWorker_t* worker){
+     for(S8 d = 0; d < DIRECTION_COUNT; d++){
+          if(!worker->held[d]) continue;
+          fuzzer_perform(worker, fuzzer_move_action((Direction_t)(d), false));
+          worker->held[d] = false;
+     }
+     if(worker->activating){
+          fuzzer_perform(worker, PLAYER_ACTION_TYPE_ACTIVATE_STOP);
+          worker->activating = false;
+     }
+     if(worker->shooting){
+          fuzzer_perform(worker, PLAYER_ACTION_TYPE_SHOOT_STOP);
+          worker->shooting = false;
+     }
+}
+
+// one frame of input. whatever was started keeps going for a while, since players walk and push in long stretches,
+// and then something new is picked, mostly more walking
+static void fuzzer_choose_input(FuzzerWorker_t* worker){
+     if(worker->hold_frames > 0){
+          worker->hold_frames--;
+
+          // now and then a second direction joins in, which is how the diagonal and corner bugs come up
+          if(worker->hold_frames > 0 && fuzzer_random(worker) % 64 == 0){
+               Direction_t direction = (Direction_t)(fuzzer_random(worker) % DIRECTION_COUNT);
+               if(!worker->held[direction]){
+                    fuzzer_perform(worker, fuzzer_move_action(direction, true));
+                    worker->held[direction] = true;
+               }
+          }
+          return;
+     }
+
+     fuzzer_release(worker);
+
+     S32 roll = (S32)(fuzzer_random(worker) % 100);
+     Direction_t direction = (Direction_t)(fuzzer_random(worker) % DIRECTION_COUNT);
+     if(roll < 55){
+          fuzzer_perform(worker, fuzzer_move_action(direction, true));
+          worker->held[direction] = true;
+          worker->hold_frames = fuzzer_random_range(worker, 4, 120);
+     }else if(roll < 70){
+          worker->hold_frames = fuzzer_random_range(worker, 1, 30);
+     }else if(roll < 80){
+          // pressing and releasing on the same frame turns without moving
+          fuzzer_perform(worker, fuzzer_move_action(direction, true));
+          fuzzer_perform(worker, fuzzer_move_action(direction, false));
+     }else if(roll < 88){
+          fuzzer_perform(worker, PLAYER_ACTION_TYPE_ACTIVATE_START);
+          worker->activating = true;
+          worker->hold_frames = fuzzer_random_range(worker, 1, 4);
+     }else if(roll < 97){
+          fuzzer_perform(worker, PLAYER_ACTION_TYPE_SHOOT_START);
+          worker->shooting = true;
+          worker->hold_frames = fuzzer_random_range(worker, 1, 40);
+     }else{
+          fuzzer_perform(worker, PLAYER_ACTION_TYPE_UNDO);
+     }
+}
+
+static bool fuzzer_finite(Vec_t v){
+     return isfinite(v.x) && isfinite(v.y);
+}
+
+const char* fuzzer_check_invariants(World_t* world){
+     for(S16 p = 0; p < world->players.count; p++){
+          Player_t* player = world->players.elements + p;
+          if(!fuzzer_finite(player->pos.decimal) || !fuzzer_finite(player->pos_delta) ||
+             !fuzzer_finite(player->vel) || !fuzzer_finite(player->accel)){
+               return "player position or velocity is not finite";
+          }
+     }
+
+     for(S16 i = 0; i < world->blocks.count; i++){
+          Block_t* block = world->blocks.elements + i;
+          if(!fuzzer_finite(block->pos.decimal) || !fuzzer_finite(block->pos_delta) ||
+             !fuzzer_finite(block->vel) || !fuzzer_finite(block->accel)){
+               return "block position or velocity is not finite";
+          }
+          if(block->teleport) continue;
+
+          if(tilemap_is_solid(&world->tilemap, block_get_coord(block))) return "block is inside a wall";
+
+          Rect_t block_rect = block_get_inclusive_rect(block);
+          for(S16 p = 0; p < world->players.count; p++){
+               Player_t* player = world->players.elements + p;
+               if(player->teleport || !blocks_at_collidable_height(block->pos.z, player->pos.z)) continue;
+               if(pixel_in_rect(player->pos.pixel, block_rect)) return "player is inside a block";
+          }
+     }
+
+     for(S16 i = 0; i < ARROW_ARRAY_MAX; i++){
+          Arrow_t* arrow = world->arrows.arrows + i;
+          if(arrow->alive && (!fuzzer_finite(arrow->pos.decimal) || !isfinite(arrow->vel))){
+               return "arrow position or velocity is not finite";
+          }
+     }
+
+     return nullptr;
+}
+
+static void fuzzer_demo_filepath(FuzzerWorker_t* worker, char* filepath, size_t size){
+     snprintf(filepath, size, "%s_%d_%d.bd", fuzzer_demo_prefix, worker->id, worker->failure_count);
+}
+
+// the signal handler may have interrupted malloc() or stdio, so all it uses from here on are open(), write() and
+// close(), along with these
+static void fuzzer_write_all(int fd, const void* bytes, size_t size){
+     const char* cursor = (const char*)(bytes);
+     while(size > 0){
+          ssize_t written = write(fd, cursor, size);
+          if(written <= 0) return;
+          cursor += written;
+          size -= (size_t)(written);
+     }
+}
+
+static char* fuzzer_append(char* cursor, char* end, const char* text){
+     while(*text && cursor < end) *cursor++ = *text++;
+     return cursor;
+}
+
+static char* fuzzer_append(char* cursor, char* end, S64 value){
+     char digits[20];
+     S32 digit_count = 0;
+     U64 magnitude = (value < 0) ? (U64)(0) - (U64)(value) : (U64)(value);
+     do{
+          digits[digit_count++] = (char)('0' + (magnitude % 10));
+          magnitude /= 10;
+     }while(magnitude);
+
+     if(value < 0 && cursor < end) *cursor++ = '-';
+     while(digit_count > 0 && cursor < end) *cursor++ = digits[--digit_count];
+     return cursor;
+}
+
+// a crash leaves the world in whatever state it was in halfway through a step, so a crash's demo is written against
+// the map as it loaded instead, playing it back crashes before that gets checked anyway
+static void fuzzer_signal_handler(int signal_number){
+     FuzzerWorker_t* worker = fuzzer_current;
+     if(worker && worker->map){
+          FuzzerMap_t* map = worker->map;
+
+          // laid out the way demo_write() lays it out
+          int fd = open(worker->demo_filepath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+          if(fd >= 0){
+               S32 version = 2;
+               fuzzer_write_all(fd, &version, sizeof(version));
+               fuzzer_write_all(fd, worker->entries, (size_t)(worker->entry_count) * sizeof(*worker->entries));
+               DemoEntry_t end {worker->frame_count, PLAYER_ACTION_TYPE_END_DEMO};
+               fuzzer_write_all(fd, &end, sizeof(end));
+               fuzzer_write_all(fd, map->crash_end_state, map->crash_end_state_size);
+               close(fd);
+          }
+
+          char message[512];
+          char* end = message + sizeof(message);
+          char* cursor = fuzzer_append(message, end, "fuzzer caught signal ");
+          cursor = fuzzer_append(cursor, end, (S64)(signal_number));
+          cursor = fuzzer_append(cursor, end, " on ");
+          cursor = fuzzer_append(cursor, end, map->filepath);
+          cursor = fuzzer_append(cursor, end, " at frame ");
+          cursor = fuzzer_append(cursor, end, worker->frame_count);
+          cursor = fuzzer_append(cursor, end, (fd >= 0) ? ", wrote " : ", failed to write ");
+          cursor = fuzzer_append(cursor, end, worker->demo_filepath);
+          cursor = fuzzer_append(cursor, end, "\n");
+          fuzzer_write_all(STDOUT_FILENO, message, (size_t)(cursor - message));
+          if(fuzzer_log_fd >= 0) fuzzer_write_all(fuzzer_log_fd, message, (size_t)(cursor - message));
+     }
+
+     signal(signal_number, SIG_DFL);
+     raise(signal_number);
+}
+
+static void fuzzer_catch_signals(){
+     struct sigaction action;
+     memset(&action, 0, sizeof(action));
+     action.sa_handler = fuzzer_signal_handler;
+     action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+     sigemptyset(&action.sa_mask);
+     sigaction(SIGABRT, &action, nullptr);
+     sigaction(SIGSEGV, &action, nullptr);
+     sigaction(SIGBUS, &action, nullptr);
+     sigaction(SIGFPE, &action, nullptr);
+     sigaction(SIGILL, &action, nullptr);
+}
+
+static bool fuzzer_run_once(FuzzerShared_t* shared, FuzzerWorker_t* worker){
+     FuzzerMap_t* map = shared->maps + (fuzzer_random(worker) % (U64)(shared->map_count));
+     World_t* world = &worker->world;
+
+     world_snapshot_restore(&map->start, world);
+     if(worker->undo_map != map){
+          destroy(&worker->undo);
+          init(&worker->undo, UNDO_MEMORY, world->tilemap.width, world->tilemap.height, world->blocks.count,
+               world->interactives.count);
+          worker->undo_map = map;
+     }
+
+     // the demo replays from an empty history, so the run has to start from one too
+     worker->undo.history.current = worker->undo.history.start;
+     undo_snapshot(&worker->undo, &world->players, &world->tilemap, &world->blocks, &world->interactives);
+     worker->action = PlayerAction_t{};
+     worker->context.resetting = false;
+     worker->context.reset_timer = 1.0f;
+     memset(worker->held, 0, sizeof(worker->held));
+     worker->activating = false;
+     worker->shooting = false;
+     worker->hold_frames = 0;
+     worker->frame_count = 0;
+     worker->entry_count = 0;
+     fuzzer_demo_filepath(worker, worker->demo_filepath, sizeof(worker->demo_filepath));
+     worker->map = map;
+
+     const char* failure = nullptr;
+     for(S32 f = 0; f < shared->options->frames_per_run; f++){
+          world_frame_begin(world, &worker->action);
+          worker->frame_count++;
+
+          fuzzer_choose_input(worker);
+
+          world_step(world, &worker->action, &worker->context);
+          world_frame_end(&worker->action, &worker->context);
+          worker->total_frame_count++;
+
+          // dying or walking off the map is a normal way for a run to end
+          if(worker->context.resetting) break;
+
+          failure = fuzzer_check_invariants(world);
+          if(failure) break;
+     }
+
+     if(failure){
+          demo_write(worker->demo_filepath, worker->entries, worker->entry_count, worker->frame_count, map->player_start,
+                     &world->tilemap, &world->blocks, &world->interactives, &world->players);
+          LOG("fuzzer found %s on %s at frame %" PRId64 ", wrote %s\n", failure, map->filepath, worker->frame_count,
+              worker->demo_filepath);
+          worker->failure_count++;
+     }
+
+     worker->map = nullptr;
+     worker->run_count++;
+     return failure == nullptr;
+}
+
+static void fuzzer_work(FuzzerShared_t* shared, FuzzerWorker_t* worker){
+     // crashes from infinite recursion run out of stack, the handler needs one of its own to run on
+     stack_t signal_stack;
+     signal_stack.ss_sp = malloc(FUZZER_SIGNAL_STACK_SIZE);
+     signal_stack.ss_size = FUZZER_SIGNAL_STACK_SIZE;
+     signal_stack.ss_flags = 0;
+     if(signal_stack.ss_sp) sigaltstack(&signal_stack, nullptr);
+
+     fuzzer_current = worker;
+     while(std::chrono::steady_clock::now() < shared->end_time){
+          fuzzer_run_once(shared, worker);
+     }
+     fuzzer_current = nullptr;
+
+     // the portal cache is per thread and this thread is about to end
+     block_portal_cache_free();
+
+     if(signal_stack.ss_sp){
+          signal_stack.ss_flags = SS_DISABLE;
+          sigaltstack(&signal_stack, nullptr);
+          free(signal_stack.ss_sp);
+     }
+}
+
+static bool fuzzer_load_map(FuzzerMap_t* map, const char* filepath){
+     map->filepath = filepath;
+     if(!load_map(filepath, &map->player_start, &map->tilemap, &map->blocks, &map->interactives)){
+          LOG("fuzzer failed to load map: %s\n", filepath);
+          return false;
+     }
+
+     World_t world {};
+     Undo_t undo {};
+     Camera_t camera {};
+     bool loaded = load_map(filepath, &map->player_start, &world.tilemap, &world.blocks, &world.interactives);
+     if(loaded){
+          reset_map(map->player_start, &world, &undo, &camera);
+          deep_copy(&world.players, &map->players);
+          loaded = world_snapshot_capture(&map->start, &world);
+     }
+
+     if(loaded){
+          FILE* file = open_memstream(&map->crash_end_state, &map->crash_end_state_size);
+          if(file){
+               demo_write_end_state(file, map->player_start, &map->tilemap, &map->blocks, &map->interactives,
+                                    &map->players);
+               fclose(file);
+          }else{
+               LOG("fuzzer failed to open a memory stream for %s, a crash on it won't write a demo\n", filepath);
+          }
+     }
+
+     destroy(&world);
+     destroy(&undo);
+     return loaded;
+}
+
+FuzzerResult_t fuzzer_run(const FuzzerOptions_t* options){
+     FuzzerResult_t result {};
+     if(options->map_count <= 0){
+          LOG("fuzzer needs at least one map\n");
+          return result;
+     }
+
+     FuzzerShared_t shared {};
+     shared.options = options;
+     shared.maps = new FuzzerMap_t[options->map_count];
+     for(S32 m = 0; m < options->map_count; m++){
+          if(!fuzzer_load_map(shared.maps + shared.map_count, options->map_filepaths[m])) continue;
+          shared.map_count++;
+     }
+
+     result.thread_count = options->thread_count;
+     if(result.thread_count <= 0) result.thread_count = (S32)(std::thread::hardware_concurrency());
+     if(result.thread_count <= 0) result.thread_count = 1;
+
+     FuzzerWorker_t* workers = new FuzzerWorker_t[result.thread_count];
+     std::thread* threads = new std::thread[result.thread_count];
+
+     if(shared.map_count > 0){
+          fuzzer_demo_prefix = options->demo_prefix;
+          if(Log_t::log) fuzzer_log_fd = fileno(Log_t::log);
+          fuzzer_catch_signals();
+
+          for(S32 w = 0; w < result.thread_count; w++){
+               FuzzerWorker_t* worker = workers + w;
+               worker->id = w;
+               worker->rng = options->seed * 0x2545f4914f6cdd1dULL + (U64)(w);
+               worker->context.undo = &worker->undo;
+          }
+
+          auto start_time = std::chrono::steady_clock::now();
+          shared.end_time = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                              std::chrono::duration<F64>(options->seconds));
+
+          for(S32 w = 0; w < result.thread_count; w++) threads[w] = std::thread(fuzzer_work, &shared, workers + w);
+          for(S32 w = 0; w < result.thread_count; w++) threads[w].join();
+
+          std::chrono::duration<F64> elapsed = std::chrono::steady_clock::now() - start_time;
+          result.seconds = elapsed.count();
+     }
+
+     for(S32 w = 0; w < result.thread_count; w++){
+          FuzzerWorker_t* worker = workers + w;
+          result.frame_count += worker->total_frame_count;
+          result.run_count += worker->run_count;
+          result.failure_count += worker->failure_count;
+
+          free(worker->entries);
+          destroy(&worker->world);
+          destroy(&worker->undo);
+     }
+     delete[] threads;
+     delete[] workers;
+
+     for(S32 m = 0; m < options->map_count; m++){
+          FuzzerMap_t* map = shared.maps + m;
+          destroy(&map->tilemap);
+          destroy(&map->blocks);
+          destroy(&map->interactives);
+          destroy(&map->players);
+          destroy(&map->start);
+          free(map->crash_end_state);
+     }
+     delete[] shared.maps;
+
+     return result;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "types.h"
+
+// drives maps with random player input on several threads at once, each with its own world, looking for asserts,
+// crashes and states the simulation should never get into (a player inside a block, a block inside a wall, a NaN
+// position or velocity). the input is biased toward what players actually do: walking and pushing for a while in one
+// direction, tapping to turn, shooting and activating, the odd undo.
+//
+// a run replays a map from its start for up to frames_per_run frames. when one goes wrong, its input up to the frame
+// it went wrong on is written out as a demo that reproduces it against the same map. asserts and crashes are caught
+// with signal handlers that write the demo of the run that hit them before letting the process die
+
+#define FUZZER_MAP_MAX 64
+
+struct FuzzerOptions_t{
+     const char* map_filepaths[FUZZER_MAP_MAX];
+     S32 map_count = 0;
+     const char* demo_prefix = "fuzz";   // demos are written to <prefix>_<thread>_<failure>.bd
+     S32 thread_count = 0;               // 0 uses one per hardware thread
+     S32 frames_per_run = 3600;
+     F64 seconds = 60.0;
+     U64 seed = 1;
+};
+
+struct FuzzerResult_t{
+     S64 frame_count = 0;
+     S64 run_count = 0;
+     S32 failure_count = 0;
+     S32 thread_count = 0;
+     F64 seconds = 0;
+};
+
+struct World_t;
+
+FuzzerResult_t fuzzer_run(const FuzzerOptions_t* options);
+
+// returns a description of the first thing about the world that should never be true, or nullptr
+const char* fuzzer_check_invariants(World_t* world);
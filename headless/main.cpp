@@ -0,0 +1,300 @@
+// plays the map/demo combos in content/ one after the other like -suite does, validating the map state after each
+// demo, but links only against libgame_sim so there is no window and no SDL or GL. build it with `make headless`
+
+#include "log.h"
+#include "defines.h"
+#include "world.h"
+#include "world_step.h"
+#include "block_utils.h"
+#include "map_format.h"
+#include "tags.h"
+#include "solver.h"
+#include "fuzzer.h"
+#include "minimizer.h"
+#include "server.h"
+#include "job_system.h"
+
+#include <chrono>
+#include <thread>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char** argv){
+     S16 map_number = 0;
+     bool fail_slow = false;
+     bool check_hash = false;
+     bool block_sleep = true;
+     SolverOptions_t solver_options {};
+     FuzzerOptions_t fuzzer_options {};
+     MinimizerOptions_t minimizer_options {};
+     ServerOptions_t server_options {};
+     bool serve = false;
+     const char* out_filepath = nullptr;
+     S32 thread_count = 0;
+     S32 job_count = -1;
+
+     for(int i = 1; i < argc; i++){
+          if(strcmp(argv[i], "-map") == 0){
+               int next = i + 1;
+               if(next >= argc) continue;
+               map_number = (S16)(atoi(argv[next]));
+          }else if(strcmp(argv[i], "-failslow") == 0){
+               fail_slow = true;
+          }else if(strcmp(argv[i], "-checkhash") == 0){
+               check_hash = true;
+          }else if(strcmp(argv[i], "-nosleep") == 0){
+               block_sleep = false;
+          }else if(strcmp(argv[i], "-solve") == 0){
+               int next = i + 1;
+               if(next >= argc) continue;
+               solver_options.map_filepath = argv[next];
+          }else if(strcmp(argv[i], "-goal") == 0){
+               if(i + 2 >= argc) continue;
+               solver_options.goal.x = (S16)(atoi(argv[i + 1]));
+               solver_options.goal.y = (S16)(atoi(argv[i + 2]));
+          }else if(strcmp(argv[i], "-out") == 0){
+               int next = i + 1;
+               if(next >= argc) continue;
+               out_filepath = argv[next];
+          }else if(strcmp(argv[i], "-threads") == 0){
+               int next = i + 1;
+               if(next >= argc) continue;
+               thread_count = atoi(argv[next]);
+          }else if(strcmp(argv[i], "-depth") == 0){
+               int next = i + 1;
+               if(next >= argc) continue;
+               solver_options.max_depth = atoi(argv[next]);
+          }else if(strcmp(argv[i], "-fuzz") == 0){
+               int next = i + 1;
+               if(next >= argc || fuzzer_options.map_count >= FUZZER_MAP_MAX) continue;
+               fuzzer_options.map_filepaths[fuzzer_options.map_count++] = argv[next];
+          }else if(strcmp(argv[i], "-seconds") == 0){
+               int next = i + 1;
+               if(next >= argc) continue;
+               fuzzer_options.seconds = atof(argv[next]);
+          }else if(strcmp(argv[i], "-frames") == 0){
+               int next = i + 1;
+               if(next >= argc) continue;
+               fuzzer_options.frames_per_run = atoi(argv[next]);
+          }else if(strcmp(argv[i], "-seed") == 0){
+               int next = i + 1;
+               if(next >= argc) continue;
+               fuzzer_options.seed = (U64)(strtoull(argv[next], nullptr, 10));
+          }else if(strcmp(argv[i], "-minimize") == 0){
+               if(i + 2 >= argc) continue;
+               minimizer_options.map_filepath = argv[i + 1];
+               minimizer_options.demo_filepath = argv[i + 2];
+          }else if(strcmp(argv[i], "-serve") == 0){
+               serve = true;
+               int next = i + 1;
+               if(next < argc && argv[next][0] != '-') server_options.socket_path = argv[next];
+          }else if(strcmp(argv[i], "-jobs") == 0){
+               int next = i + 1;
+               if(next >= argc) continue;
+               job_count = atoi(argv[next]);
+          }else if(strcmp(argv[i], "-h") == 0){
+               printf("%s [options]\n", argv[0]);
+               printf("  -map <integer> the map number to start testing from. default: 0\n");
+               printf("  -failslow      continue running tests after a failure\n");
+               printf("  -checkhash     compare the incremental world hash against a full recompute every frame\n");
+               printf("  -nosleep       step every block every frame instead of letting resting ones sleep\n");
+               printf("  -solve <map filepath> search for the fewest moves that walk the player onto the -goal tile and\n");
+               printf("                 write the inputs as a demo instead of testing\n");
+               printf("  -goal <x> <y>  the tile -solve gets the player to\n");
+               printf("  -depth <integer> the most moves -solve tries before giving up. default: 32\n");
+               printf("  -fuzz <map filepath> play random input on the map looking for asserts, crashes and broken\n");
+               printf("                 invariants instead of testing, repeat it to fuzz several maps\n");
+               printf("  -seconds <number> how long -fuzz runs for. default: 60\n");
+               printf("  -frames <integer> the most frames a -fuzz run plays before starting over. default: 3600\n");
+               printf("  -seed <integer> seeds the -fuzz input. default: 1\n");
+               printf("  -minimize <map filepath> <demo filepath> shrink a demo that crashes or breaks an invariant on the\n");
+               printf("                 map to the fewest inputs and frames that still fail the same way\n");
+               printf("  -serve [socket path] keep running and take commands over a unix socket, or stdin and stdout\n");
+               printf("                 without one, see server.h for the protocol\n");
+               printf("  -out <filepath> the demo -solve writes, default: solution.bd, the prefix of the demos -fuzz\n");
+               printf("                 writes, default: fuzz, or the demo -minimize writes, default: minimized.bd\n");
+               printf("  -threads <integer> threads -solve, -fuzz and -serve run on and replays -minimize runs at once.\n");
+               printf("                 default: one per hardware thread\n");
+               printf("  -jobs <integer> split the passes of each step that only read the world across this many workers\n");
+               printf("                 when testing maps, 0 for one per hardware thread but one. default: none\n");
+               printf("  -h this help.\n");
+               return 0;
+          }
+     }
+
+     const char* log_path = "bryte_headless.log";
+     if(!Log_t::create(log_path)){
+          fprintf(stderr, "failed to create log file: '%s'\n", log_path);
+          return -1;
+     }
+
+     clear_global_tags();
+
+     solver_options.thread_count = thread_count;
+     fuzzer_options.thread_count = thread_count;
+     minimizer_options.thread_count = thread_count;
+     server_options.thread_count = thread_count;
+     if(out_filepath){
+          solver_options.demo_filepath = out_filepath;
+          fuzzer_options.demo_prefix = out_filepath;
+          minimizer_options.out_filepath = out_filepath;
+     }
+
+     if(solver_options.map_filepath){
+          auto solve_start = std::chrono::steady_clock::now();
+          SolverResult_t solver_result = solver_solve(&solver_options);
+          std::chrono::duration<double> solve_seconds = std::chrono::steady_clock::now() - solve_start;
+          if(solver_result.solved){
+               LOG("solved %s in %d moves and %" PRId64 " frames, wrote %s\n", solver_options.map_filepath,
+                   solver_result.depth, solver_result.frame_count, solver_options.demo_filepath);
+          }else{
+               LOG("no solution for %s\n", solver_options.map_filepath);
+          }
+          LOG("searched %" PRId64 " states in %.3fs\n", solver_result.state_count, solve_seconds.count());
+          block_portal_cache_free();
+          Log_t::destroy();
+          return solver_result.solved ? 0 : 1;
+     }
+
+     if(fuzzer_options.map_count){
+          FuzzerResult_t fuzzer_result = fuzzer_run(&fuzzer_options);
+          F64 frames_per_second = fuzzer_result.seconds > 0 ? (F64)(fuzzer_result.frame_count) / fuzzer_result.seconds : 0;
+          S32 core_count = (S32)(std::thread::hardware_concurrency());
+          if(core_count <= 0 || core_count > fuzzer_result.thread_count) core_count = fuzzer_result.thread_count;
+          LOG("fuzzed %" PRId64 " frames over %" PRId64 " runs in %.3fs on %d threads, %d failures\n",
+              fuzzer_result.frame_count, fuzzer_result.run_count, fuzzer_result.seconds, fuzzer_result.thread_count,
+              fuzzer_result.failure_count);
+          LOG("%.0f frames per second, %.0f per core\n", frames_per_second,
+              core_count > 0 ? frames_per_second / core_count : 0);
+          block_portal_cache_free();
+          Log_t::destroy();
+          return fuzzer_result.failure_count ? 1 : 0;
+     }
+
+     if(serve){
+          bool served = server_run(&server_options);
+          block_portal_cache_free();
+          Log_t::destroy();
+          return served ? 0 : 1;
+     }
+
+     if(minimizer_options.map_filepath){
+          auto minimize_start = std::chrono::steady_clock::now();
+          MinimizerResult_t minimizer_result = minimizer_minimize(&minimizer_options);
+          std::chrono::duration<double> minimize_seconds = std::chrono::steady_clock::now() - minimize_start;
+          if(minimizer_result.minimized){
+               LOG("minimized %s from %" PRId64 " entries across %" PRId64 " frames to %" PRId64 " across %" PRId64
+                   " frames, wrote %s\n", minimizer_options.demo_filepath, minimizer_result.original_entry_count,
+                   minimizer_result.original_frame_count, minimizer_result.entry_count, minimizer_result.frame_count,
+                   minimizer_options.out_filepath);
+          }
+          LOG("replayed %" PRId64 " candidates in %.3fs, stepping %" PRId64 " frames and skipping %" PRId64 "\n",
+              minimizer_result.replay_count, minimize_seconds.count(), minimizer_result.stepped_frame_count,
+              minimizer_result.skipped_frame_count);
+          block_portal_cache_free();
+          Log_t::destroy();
+          return minimizer_result.minimized ? 0 : 1;
+     }
+
+     World_t world {};
+     Undo_t undo {};
+     Camera_t camera {};
+     Coord_t player_start {2, 8};
+     char* map_number_filepath = nullptr;
+     bool current_map_tags[TAG_COUNT];
+     memset(current_map_tags, 0, TAG_COUNT * sizeof(*current_map_tags));
+
+     Demo_t play_demo {};
+     Demo_t record_demo {};
+     PlayerAction_t player_action {};
+     S64 frame_count = 0;
+     S64 total_frame_count = 0;
+
+     FrameContext_t frame_context {};
+     frame_context.undo = &undo;
+     frame_context.check_hash = check_hash;
+     frame_context.block_sleep = block_sleep;
+
+     // workers keep a block portal cache of their own
+     JobSystem_t job_system;
+     if(job_count >= 0){
+          init(&job_system, job_count, block_portal_cache_free);
+          frame_context.jobs = &job_system;
+     }
+
+     S16 first_map_number = map_number;
+     S16 fail_count = 0;
+     int rc = 0;
+
+     auto start_time = std::chrono::steady_clock::now();
+
+     while(true){
+          auto load_result = load_map_number_map(map_number, &world, &undo, &player_start, &player_action, &camera, current_map_tags);
+          if(!load_result.success) break;
+
+          free(map_number_filepath);
+          map_number_filepath = load_result.filepath;
+
+          play_demo.mode = DEMO_MODE_PLAY;
+          if(!load_map_number_demo(&play_demo, map_number, &frame_count)){
+               rc = 1;
+               break;
+          }
+
+          while(true){
+               world_frame_begin(&world, &player_action);
+               frame_count++;
+
+               if(demo_play_frame(&play_demo, &player_action, &world.players, frame_count, &record_demo)) break;
+
+               world_step(&world, &player_action, &frame_context);
+               bool reset = world_frame_end(&player_action, &frame_context);
+               total_frame_count++;
+
+               if(reset){
+                    auto reset_result = load_map_number_map(map_number, &world, &undo, &player_start, &player_action, &camera, current_map_tags);
+                    if(reset_result.success){
+                         free(map_number_filepath);
+                         map_number_filepath = reset_result.filepath;
+                    }
+               }
+          }
+
+          bool passed = test_map_end_state(&world, &play_demo);
+          clear_global_tags();
+          if(!passed){
+               LOG("test failed\n");
+               fail_count++;
+               if(!fail_slow){
+                    rc = 1;
+                    break;
+               }
+          }
+
+          map_number++;
+     }
+
+     std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start_time;
+
+     S16 maps_tested = map_number - first_map_number;
+     if(fail_slow){
+          LOG("Done Testing %d maps where %d failed.\n", maps_tested, fail_count);
+          if(fail_count) rc = 1;
+     }else if(rc == 0){
+          LOG("Done Testing %d maps.\n", maps_tested);
+     }
+     LOG("stepped %" PRId64 " frames in %.3fs\n", total_frame_count, elapsed_seconds.count());
+
+     if(play_demo.file) fclose(play_demo.file);
+     free(play_demo.entries.entries);
+     free(map_number_filepath);
+
+     destroy(&world);
+     destroy(&job_system);
+     block_portal_cache_free();
+     destroy(&undo);
+
+     Log_t::destroy();
+     return rc;
+}
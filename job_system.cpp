@@ -0,0 +1,295 @@
+#include "job_system.h"
+#include "log.h"
+
+#include <string.h>
+
+static thread_local JobSystem_t* job_worker_system = nullptr;
+static thread_local S32 job_worker_index = -1;
+
+static bool job_system_runs_jobs(JobSystem_t* system){
+     return system && system->thread_count > 0 && system->running.load(std::memory_order_acquire);
+}
+
+// the queue the calling thread puts its work in
+static S32 job_system_own_queue(JobSystem_t* system){
+     if(job_worker_system == system) return job_worker_index;
+     return system->thread_count;
+}
+
+static void job_system_push(JobSystem_t* system, JobFunction_t* function, void* data, S32 count, S32 batch,
+                            JobCounter_t* counter){
+     JobQueue_t* queue = system->queues + job_system_own_queue(system);
+     {
+          std::lock_guard<std::mutex> lock(queue->mutex);
+          for(S32 begin = 0; begin < count; begin += batch){
+               S32 end = begin + batch;
+               if(end > count) end = count;
+               queue->jobs.push_back(Job_t{function, data, begin, end, counter});
+               system->queued.fetch_add(1, std::memory_order_release);
+          }
+     }
+
+     // taking the lock means a worker is either still about to check queued or already waiting to be woken
+     {
+          std::lock_guard<std::mutex> lock(system->wake_mutex);
+     }
+     system->wake_condition.notify_all();
+}
+
+static bool job_system_take(JobSystem_t* system, Job_t* job){
+     S32 own = job_system_own_queue(system);
+     {
+          JobQueue_t* queue = system->queues + own;
+          std::lock_guard<std::mutex> lock(queue->mutex);
+          if(!queue->jobs.empty()){
+               *job = queue->jobs.back();
+               queue->jobs.pop_back();
+               system->queued.fetch_sub(1, std::memory_order_relaxed);
+               return true;
+          }
+     }
+
+     S32 queue_count = system->thread_count + 1;
+     for(S32 q = 1; q < queue_count; q++){
+          JobQueue_t* queue = system->queues + ((own + q) % queue_count);
+          std::lock_guard<std::mutex> lock(queue->mutex);
+          if(!queue->jobs.empty()){
+               *job = queue->jobs.front();
+               queue->jobs.pop_front();
+               system->queued.fetch_sub(1, std::memory_order_relaxed);
+               return true;
+          }
+     }
+
+     return false;
+}
+
+static void job_graph_start_node(JobSystem_t* system, JobGraph_t* graph, S32 index);
+
+static void job_counter_finish(JobSystem_t* system, JobCounter_t* counter){
+     // whoever waits may tear the counter down the moment it reaches 0
+     JobGraph_t* graph = counter->graph;
+     S32 node_index = counter->node;
+     if(counter->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+     if(!graph) return;
+
+     JobGraphNode_t* node = graph->nodes + node_index;
+     for(S8 d = 0; d < node->dependent_count; d++){
+          JobGraphNode_t* dependent = graph->nodes + node->dependents[d];
+          if(dependent->waiting_on.fetch_sub(1, std::memory_order_acq_rel) == 1){
+               job_graph_start_node(system, graph, node->dependents[d]);
+          }
+     }
+
+     job_counter_finish(system, &graph->done);
+}
+
+static void job_run(JobSystem_t* system, Job_t* job){
+     // tags the job adds belong to whoever waits on it, not to the thread that happened to run it
+     bool* tags = get_global_tags();
+     bool thread_tags[TAG_COUNT];
+     memcpy(thread_tags, tags, sizeof(thread_tags));
+     clear_global_tags();
+
+     for(S32 i = job->begin; i < job->end; i++){
+          job->function(job->data, i);
+     }
+
+     bool tagged = false;
+     for(S32 c = 0; c < TAG_COUNT; c++){
+          if(tags[c]){
+               tagged = true;
+               break;
+          }
+     }
+
+     if(tagged){
+          JobCounter_t* counter = job->counter->parent ? job->counter->parent : job->counter;
+          std::lock_guard<std::mutex> lock(counter->tags_mutex);
+          if(!counter->tagged){
+               memset(counter->tags, 0, sizeof(counter->tags));
+               counter->tagged = true;
+          }
+          for(S32 c = 0; c < TAG_COUNT; c++){
+               if(tags[c]) counter->tags[c] = true;
+          }
+     }
+
+     memcpy(tags, thread_tags, sizeof(thread_tags));
+
+     job_counter_finish(system, job->counter);
+}
+
+// runs whatever jobs there are instead of sleeping, the ones counted may be stuck behind others in a queue
+static void job_system_wait(JobSystem_t* system, JobCounter_t* counter){
+     Job_t job;
+     while(counter->remaining.load(std::memory_order_acquire) > 0){
+          if(job_system_take(system, &job)){
+               job_run(system, &job);
+          }else{
+               std::this_thread::yield();
+          }
+     }
+
+     if(counter->tagged){
+          for(S32 c = 0; c < TAG_COUNT; c++){
+               if(counter->tags[c]) add_global_tag((Tag_t)(c));
+          }
+     }
+}
+
+static void job_system_work(JobSystem_t* system, S32 index){
+     job_worker_system = system;
+     job_worker_index = index;
+
+     Job_t job;
+     while(true){
+          if(job_system_take(system, &job)){
+               job_run(system, &job);
+               continue;
+          }
+
+          std::unique_lock<std::mutex> lock(system->wake_mutex);
+          while(system->queued.load(std::memory_order_acquire) == 0 && system->running.load(std::memory_order_acquire)){
+               system->wake_condition.wait(lock);
+          }
+          if(!system->running.load(std::memory_order_acquire) && system->queued.load(std::memory_order_acquire) == 0) break;
+     }
+
+     if(system->thread_exit) system->thread_exit();
+
+     job_worker_system = nullptr;
+     job_worker_index = -1;
+}
+
+bool init(JobSystem_t* system, S32 thread_count, void (*thread_exit)()){
+     if(system->running.load()) return true;
+
+     if(thread_count <= 0) thread_count = (S32)(std::thread::hardware_concurrency()) - 1;
+     if(thread_count < 0) thread_count = 0;
+     if(thread_count > JOB_SYSTEM_MAX_THREADS) thread_count = JOB_SYSTEM_MAX_THREADS;
+
+     system->thread_count = thread_count;
+     system->thread_exit = thread_exit;
+     system->queued.store(0);
+     system->running.store(true);
+
+     for(S32 t = 0; t < thread_count; t++){
+          system->threads[t] = std::thread(job_system_work, system, t);
+     }
+     return true;
+}
+
+void destroy(JobSystem_t* system){
+     if(!system->running.load()) return;
+
+     {
+          std::lock_guard<std::mutex> lock(system->wake_mutex);
+          system->running.store(false, std::memory_order_release);
+     }
+     system->wake_condition.notify_all();
+
+     for(S32 t = 0; t < system->thread_count; t++){
+          system->threads[t].join();
+     }
+     system->thread_count = 0;
+}
+
+void job_system_parallel_for(JobSystem_t* system, S32 count, S32 batch, JobFunction_t* function, void* data){
+     if(batch < 1) batch = 1;
+
+     if(!job_system_runs_jobs(system) || count <= batch){
+          for(S32 i = 0; i < count; i++){
+               function(data, i);
+          }
+          return;
+     }
+
+     JobCounter_t counter;
+     counter.remaining.store((count + batch - 1) / batch, std::memory_order_relaxed);
+     job_system_push(system, function, data, count, batch, &counter);
+     job_system_wait(system, &counter);
+}
+
+S32 job_system_worker_index(){
+     return job_worker_index;
+}
+
+static void job_graph_start_node(JobSystem_t* system, JobGraph_t* graph, S32 index){
+     JobGraphNode_t* node = graph->nodes + index;
+     S32 job_count = (node->count + node->batch - 1) / node->batch;
+     if(job_count <= 0){
+          node->counter.remaining.store(1, std::memory_order_relaxed);
+          job_counter_finish(system, &node->counter);
+          return;
+     }
+
+     node->counter.remaining.store(job_count, std::memory_order_relaxed);
+     job_system_push(system, node->function, node->data, node->count, node->batch, &node->counter);
+}
+
+S32 job_graph_add(JobGraph_t* graph, JobFunction_t* function, void* data, S32 count, S32 batch){
+     if(graph->node_count >= JOB_GRAPH_MAX_NODES){
+          LOG("%s() graph already has %d nodes\n", __FUNCTION__, JOB_GRAPH_MAX_NODES);
+          return -1;
+     }
+
+     S32 index = graph->node_count;
+     JobGraphNode_t* node = graph->nodes + index;
+     node->function = function;
+     node->data = data;
+     node->count = count;
+     node->batch = (batch < 1) ? 1 : batch;
+     node->dependent_count = 0;
+     node->dependency_count = 0;
+     graph->node_count++;
+     return index;
+}
+
+bool job_graph_depend(JobGraph_t* graph, S32 node, S32 on){
+     if(on < 0 || on >= node || node >= graph->node_count){
+          LOG("%s() node %d can't depend on node %d\n", __FUNCTION__, node, on);
+          return false;
+     }
+
+     JobGraphNode_t* on_node = graph->nodes + on;
+     if(on_node->dependent_count >= JOB_GRAPH_MAX_DEPENDENTS){
+          LOG("%s() node %d already has %d dependents\n", __FUNCTION__, on, JOB_GRAPH_MAX_DEPENDENTS);
+          return false;
+     }
+
+     on_node->dependents[on_node->dependent_count] = node;
+     on_node->dependent_count++;
+     graph->nodes[node].dependency_count++;
+     return true;
+}
+
+void job_system_run_graph(JobSystem_t* system, JobGraph_t* graph){
+     if(!job_system_runs_jobs(system)){
+          for(S32 n = 0; n < graph->node_count; n++){
+               JobGraphNode_t* node = graph->nodes + n;
+               for(S32 i = 0; i < node->count; i++){
+                    node->function(node->data, i);
+               }
+          }
+          return;
+     }
+
+     if(graph->node_count == 0) return;
+
+     graph->done.remaining.store(graph->node_count, std::memory_order_relaxed);
+     graph->done.tagged = false;
+     for(S32 n = 0; n < graph->node_count; n++){
+          JobGraphNode_t* node = graph->nodes + n;
+          node->waiting_on.store(node->dependency_count, std::memory_order_relaxed);
+          node->counter.parent = &graph->done;
+          node->counter.graph = graph;
+          node->counter.node = n;
+     }
+
+     for(S32 n = 0; n < graph->node_count; n++){
+          if(graph->nodes[n].dependency_count == 0) job_graph_start_node(system, graph, n);
+     }
+
+     job_system_wait(system, &graph->done);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "types.h"
+#include "tags.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#define JOB_SYSTEM_MAX_THREADS 16
+#define JOB_GRAPH_MAX_NODES 16
+#define JOB_GRAPH_MAX_DEPENDENTS 8
+
+// called once per index, data is whatever was handed in with the work
+typedef void JobFunction_t(void* data, S32 index);
+
+struct JobGraph_t;
+
+// counts down the jobs a parallel_for or a graph node still has running. tags the jobs add on a worker end up here
+// until whoever waits takes them, global tags are per thread
+struct JobCounter_t{
+     std::atomic<S32> remaining {0};
+     JobCounter_t* parent = nullptr; // a graph node's counter hands its tags to the graph's
+     JobGraph_t* graph = nullptr;
+     S32 node = -1;
+
+     std::mutex tags_mutex;
+     bool tagged = false;
+     bool tags[TAG_COUNT];
+};
+
+struct Job_t{
+     JobFunction_t* function;
+     void* data;
+     S32 begin;
+     S32 end;
+     JobCounter_t* counter;
+};
+
+struct JobQueue_t{
+     std::mutex mutex;
+     std::deque<Job_t> jobs;
+};
+
+// a fixed set of workers, each with its own queue. a worker works through its own queue newest first, when it runs
+// dry it steals the oldest job from another queue, so a big split stays spread out and what a job splits off itself
+// stays warm on the thread that made it. threads outside the pool put their work in a shared queue and help run jobs
+// until theirs are done rather than sleep, nothing ever waits on a job that isn't being run
+struct JobSystem_t{
+     std::thread threads[JOB_SYSTEM_MAX_THREADS];
+     S32 thread_count = 0;
+
+     JobQueue_t queues[JOB_SYSTEM_MAX_THREADS + 1]; // the last one is the shared queue
+     std::atomic<S32> queued {0};
+
+     std::mutex wake_mutex;
+     std::condition_variable wake_condition;
+     std::atomic<bool> running {false};
+
+     void (*thread_exit)() = nullptr;
+};
+
+// a thread_count of 0 uses every hardware thread but the calling one. thread_exit runs on each worker as it stops,
+// for freeing per thread state like the block portal cache
+bool init(JobSystem_t* system, S32 thread_count = 0, void (*thread_exit)() = nullptr);
+void destroy(JobSystem_t* system);
+
+// calls function(data, i) for every i in [0, count), batch indices to a job, and returns once all of them have. results
+// written per index and read back in index order come out the same no matter which thread ran what. without a
+// system, or with no workers, it is a plain loop on the calling thread
+void job_system_parallel_for(JobSystem_t* system, S32 count, S32 batch, JobFunction_t* function, void* data);
+
+// which of the system's workers the calling thread is, -1 on any other thread
+S32 job_system_worker_index();
+
+struct JobGraphNode_t{
+     JobFunction_t* function;
+     void* data;
+     S32 count;
+     S32 batch;
+
+     S32 dependents[JOB_GRAPH_MAX_DEPENDENTS];
+     S8 dependent_count;
+     S8 dependency_count;
+     std::atomic<S8> waiting_on;
+
+     JobCounter_t counter;
+};
+
+// parallel_fors that have to run after one another. a node only starts once every node it depends on is done, nodes
+// that don't depend on each other run at the same time. a node can only depend on nodes added before it, so index
+// order is always an order the graph can run in, and is the one it runs in without a system
+struct JobGraph_t{
+     JobGraphNode_t nodes[JOB_GRAPH_MAX_NODES];
+     S32 node_count = 0;
+     JobCounter_t done;
+};
+
+// the index of the new node, -1 when the graph is full
+S32 job_graph_add(JobGraph_t* graph, JobFunction_t* function, void* data, S32 count, S32 batch = 1);
+
+// node won't start before on is done
+bool job_graph_depend(JobGraph_t* graph, S32 node, S32 on);
+
+void job_system_run_graph(JobSystem_t* system, JobGraph_t* graph);
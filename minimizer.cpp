@@ -0,0 +1,551 @@
+#include "minimizer.h"
+#include "fuzzer.h"
+#include "world.h"
+#include "world_step.h"
+#include "world_snapshot.h"
+#include "block_utils.h"
+#include "map_format.h"
+#include "defines.h"
+#include "log.h"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#define MINIMIZER_FAILURE_LEN 64
+#define MINIMIZER_RUN_SECONDS 120 // a candidate still going after this long has hung, which is a different failure
+
+enum MinimizerOutcome_t{
+     MINIMIZER_OUTCOME_PASSED,
+     MINIMIZER_OUTCOME_FAILED,    // an invariant broke, failure says which
+     MINIMIZER_OUTCOME_LINED_UP,  // the world matched a keyframe, the rest plays out like the smallest demo does
+     MINIMIZER_OUTCOME_CRASHED,   // filled in by the parent from how the child exited
+};
+
+// where a child replaying a candidate leaves what happened, in memory shared with the parent. frame is kept up to
+// date as it goes so a crash still leaves behind the frame it happened on
+struct MinimizerSlot_t{
+     pid_t pid;
+     MinimizerOutcome_t outcome;
+     S32 signal_number;
+     S64 frame;
+     S64 start_frame;
+     S64 stepped_frame_count;
+     char failure[MINIMIZER_FAILURE_LEN];
+};
+
+struct MinimizerDemo_t{
+     DemoEntry_t* entries = nullptr;
+     S64 count = 0;
+};
+
+// a demo to try and how it relates to the smallest one so far: everything before first_changed_frame plays the same,
+// and its entries from tail_index on are the smallest's from best_tail_index on, shift frames earlier
+struct MinimizerCandidate_t{
+     MinimizerDemo_t demo;
+     S64 first_changed_frame = 0;
+     S64 tail_index = -1; // -1 when it never lines up
+     S64 best_tail_index = 0;
+     S64 shift = 0;
+};
+
+struct MinimizerKeyframe_t{
+     WorldSnapshot_t snapshot;
+     PlayerAction_t action;
+     bool resetting;
+     F32 reset_timer;
+};
+
+struct Minimizer_t{
+     const MinimizerOptions_t* options = nullptr;
+     World_t world {};
+     Undo_t undo {};
+     FrameContext_t context {};
+     PlayerAction_t action {};
+     Coord_t player_start;
+     WorldSnapshot_t scratch {};
+     S64 end_frame = 0; // where the original demo ended, no candidate plays past it
+
+     // the smallest demo that still fails, the frame it fails on and how
+     MinimizerDemo_t best;
+     S64 best_frame = 0;
+     S32 signal_number = 0; // 0 when it breaks an invariant instead of crashing
+     char failure[MINIMIZER_FAILURE_LEN];
+
+     // the state every keyframe_interval frames into the smallest demo up to the frame it fails on, the first is the
+     // map as it loaded
+     MinimizerKeyframe_t* keyframes = nullptr;
+     S64 keyframe_count = 0;
+     S64 keyframe_allocated = 0;
+
+     MinimizerSlot_t* slots = nullptr; // one per thread
+     S32 thread_count = 0;
+
+     MinimizerResult_t result;
+};
+
+static void minimizer_reset_undo(Minimizer_t* minimizer){
+     World_t* world = &minimizer->world;
+     destroy(&minimizer->undo);
+     init(&minimizer->undo, UNDO_MEMORY, world->tilemap.width, world->tilemap.height, world->blocks.count,
+          world->interactives.count);
+     undo_snapshot(&minimizer->undo, &world->players, &world->tilemap, &world->blocks, &world->interactives);
+}
+
+static bool minimizer_capture(Minimizer_t* minimizer, S64 index){
+     if(index >= minimizer->keyframe_allocated){
+          S64 allocated = minimizer->keyframe_allocated ? minimizer->keyframe_allocated * 2 : 64;
+          while(allocated <= index) allocated *= 2;
+          MinimizerKeyframe_t* keyframes = (MinimizerKeyframe_t*)(realloc(minimizer->keyframes,
+                                                                          (size_t)(allocated) * sizeof(*keyframes)));
+          if(!keyframes) return false;
+          for(S64 k = minimizer->keyframe_allocated; k < allocated; k++) keyframes[k] = MinimizerKeyframe_t{};
+          minimizer->keyframes = keyframes;
+          minimizer->keyframe_allocated = allocated;
+     }
+
+     MinimizerKeyframe_t* keyframe = minimizer->keyframes + index;
+     if(!world_snapshot_capture(&keyframe->snapshot, &minimizer->world)) return false;
+     keyframe->action = minimizer->action;
+     keyframe->resetting = minimizer->context.resetting;
+     keyframe->reset_timer = minimizer->context.reset_timer;
+     minimizer->keyframe_count = index + 1;
+     return true;
+}
+
+static bool minimizer_lines_up(Minimizer_t* minimizer, MinimizerKeyframe_t* keyframe){
+     if(minimizer->context.resetting != keyframe->resetting || minimizer->context.reset_timer != keyframe->reset_timer) return false;
+     if(memcmp(&minimizer->action, &keyframe->action, sizeof(minimizer->action)) != 0) return false;
+     if(!world_snapshot_capture(&minimizer->scratch, &minimizer->world)) return false;
+     return minimizer->scratch.size == keyframe->snapshot.size &&
+            memcmp(minimizer->scratch.buffer, keyframe->snapshot.buffer, keyframe->snapshot.size) == 0;
+}
+
+static bool minimizer_has_undo(const MinimizerDemo_t* demo, S64 first_index){
+     for(S64 i = first_index; i < demo->count; i++){
+          if(demo->entries[i].player_action_type == PLAYER_ACTION_TYPE_UNDO) return true;
+     }
+     return false;
+}
+
+// keyframes don't hold the undo history, so a candidate that undoes after one has to start from the beginning
+static S64 minimizer_start_keyframe(Minimizer_t* minimizer, const MinimizerCandidate_t* candidate){
+     S64 interval = minimizer->options->keyframe_interval;
+     S64 index = (candidate->first_changed_frame - 1) / interval;
+     if(index >= minimizer->keyframe_count) index = minimizer->keyframe_count - 1;
+     if(index <= 0) return 0;
+
+     S64 first_index = 0;
+     while(first_index < candidate->demo.count && candidate->demo.entries[first_index].frame <= index * interval) first_index++;
+     if(minimizer_has_undo(&candidate->demo, first_index)) return 0;
+     return index;
+}
+
+// plays a candidate from a keyframe until it breaks an invariant, reaches stop_frame or lines up with a keyframe of
+// the smallest demo. capture keeps keyframes along the way, for when the candidate is the smallest demo
+static void minimizer_play(Minimizer_t* minimizer, const MinimizerCandidate_t* candidate, S64 keyframe_index,
+                           S64 stop_frame, bool capture, MinimizerSlot_t* slot){
+     World_t* world = &minimizer->world;
+     const MinimizerDemo_t* demo = &candidate->demo;
+     S64 interval = minimizer->options->keyframe_interval;
+
+     MinimizerKeyframe_t* keyframe = minimizer->keyframes + keyframe_index;
+     world_snapshot_restore(&keyframe->snapshot, world);
+     minimizer_reset_undo(minimizer);
+     minimizer->action = keyframe->action;
+     minimizer->context.resetting = keyframe->resetting;
+     minimizer->context.reset_timer = keyframe->reset_timer;
+
+     S64 frame = keyframe_index * interval;
+     S64 entry_index = 0;
+     while(entry_index < demo->count && demo->entries[entry_index].frame <= frame) entry_index++;
+
+     slot->outcome = MINIMIZER_OUTCOME_PASSED;
+     slot->frame = frame;
+     slot->start_frame = frame;
+     slot->stepped_frame_count = 0;
+     slot->failure[0] = 0;
+
+     // the world can only match the smallest demo's once both have played everything before their shared tail, and
+     // only undo history that's the same in both can be left out of the comparison
+     bool can_line_up = candidate->tail_index >= 0 && !minimizer_has_undo(demo, candidate->tail_index);
+     S64 line_up_frame = candidate->first_changed_frame;
+     if(can_line_up){
+          if(candidate->tail_index > 0){
+               line_up_frame = MAXIMUM(line_up_frame, demo->entries[candidate->tail_index - 1].frame);
+          }
+          if(candidate->best_tail_index > 0){
+               line_up_frame = MAXIMUM(line_up_frame,
+                                       minimizer->best.entries[candidate->best_tail_index - 1].frame - candidate->shift);
+          }
+     }
+
+     while(frame < stop_frame){
+          world_frame_begin(world, &minimizer->action);
+          frame++;
+          slot->frame = frame;
+
+          while(entry_index < demo->count && demo->entries[entry_index].frame == frame){
+               player_action_perform(&minimizer->action, &world->players, demo->entries[entry_index].player_action_type,
+                                     DEMO_MODE_NONE, nullptr, frame);
+               entry_index++;
+          }
+
+          world_step(world, &minimizer->action, &minimizer->context);
+          bool reset = world_frame_end(&minimizer->action, &minimizer->context);
+          slot->stepped_frame_count++;
+
+          // reloads the map like the game does
+          if(reset){
+               world_snapshot_restore(&minimizer->keyframes[0].snapshot, world);
+               minimizer_reset_undo(minimizer);
+               minimizer->action = PlayerAction_t{};
+          }
+
+          const char* failure = fuzzer_check_invariants(world);
+          if(failure){
+               strncpy(slot->failure, failure, MINIMIZER_FAILURE_LEN - 1);
+               slot->failure[MINIMIZER_FAILURE_LEN - 1] = 0;
+               slot->outcome = MINIMIZER_OUTCOME_FAILED;
+               return;
+          }
+
+          if(capture && frame % interval == 0) minimizer_capture(minimizer, frame / interval);
+
+          if(can_line_up && frame >= line_up_frame && (frame + candidate->shift) % interval == 0){
+               S64 index = (frame + candidate->shift) / interval;
+               if(index < minimizer->keyframe_count && minimizer_lines_up(minimizer, minimizer->keyframes + index)){
+                    slot->outcome = MINIMIZER_OUTCOME_LINED_UP;
+                    return;
+               }
+          }
+     }
+}
+
+static void minimizer_child(Minimizer_t* minimizer, const MinimizerCandidate_t* candidate, MinimizerSlot_t* slot){
+     // crashing is what is being looked for, there is no need to dump core or print the assert every time
+     rlimit no_core {0, 0};
+     setrlimit(RLIMIT_CORE, &no_core);
+     int null_fd = open("/dev/null", O_WRONLY);
+     if(null_fd >= 0){
+          dup2(null_fd, STDOUT_FILENO);
+          dup2(null_fd, STDERR_FILENO);
+          close(null_fd);
+     }
+     Log_t::log = fopen("/dev/null", "w");
+     if(!Log_t::log) _exit(1);
+
+     alarm(MINIMIZER_RUN_SECONDS);
+     minimizer_play(minimizer, candidate, minimizer_start_keyframe(minimizer, candidate), minimizer->end_frame, false,
+                    slot);
+     _exit(0);
+}
+
+// replays up to thread_count candidates at once, each in a process of its own
+static void minimizer_replay(Minimizer_t* minimizer, const MinimizerCandidate_t* candidates, S32 count){
+     // anything still buffered would be written again by every child that flushes it
+     fflush(Log_t::log);
+     fflush(stdout);
+
+     for(S32 i = 0; i < count; i++){
+          MinimizerSlot_t* slot = minimizer->slots + i;
+          memset(slot, 0, sizeof(*slot));
+          pid_t pid = fork();
+          if(pid == 0) minimizer_child(minimizer, candidates + i, slot);
+          if(pid < 0){
+               LOG("minimizer failed to fork a replay\n");
+          }
+          slot->pid = pid;
+     }
+
+     for(S32 i = 0; i < count; i++){
+          MinimizerSlot_t* slot = minimizer->slots + i;
+          if(slot->pid < 0) continue;
+
+          int status = 0;
+          waitpid(slot->pid, &status, 0);
+          if(WIFSIGNALED(status)){
+               slot->outcome = MINIMIZER_OUTCOME_CRASHED;
+               slot->signal_number = WTERMSIG(status);
+          }
+
+          minimizer->result.replay_count++;
+          minimizer->result.stepped_frame_count += slot->stepped_frame_count;
+          minimizer->result.skipped_frame_count += slot->start_frame;
+          if(slot->outcome == MINIMIZER_OUTCOME_LINED_UP){
+               minimizer->result.skipped_frame_count += minimizer->best_frame - candidates[i].shift - slot->frame;
+          }
+     }
+}
+
+// the frame a replay failed the same way as the smallest demo on, or -1
+static S64 minimizer_fail_frame(Minimizer_t* minimizer, const MinimizerCandidate_t* candidate, MinimizerSlot_t* slot){
+     switch(slot->outcome){
+     default:
+          break;
+     case MINIMIZER_OUTCOME_FAILED:
+          if(minimizer->signal_number == 0 && strcmp(slot->failure, minimizer->failure) == 0) return slot->frame;
+          break;
+     case MINIMIZER_OUTCOME_CRASHED:
+          if(slot->signal_number == minimizer->signal_number) return slot->frame;
+          break;
+     case MINIMIZER_OUTCOME_LINED_UP:
+          return minimizer->best_frame - candidate->shift;
+     }
+
+     return -1;
+}
+
+// makes the candidate the smallest demo, taking its entries, and keyframes it up to the frame before it fails
+static void minimizer_accept(Minimizer_t* minimizer, MinimizerCandidate_t* candidate, S64 fail_frame){
+     free(minimizer->best.entries);
+     minimizer->best = candidate->demo;
+     candidate->demo = MinimizerDemo_t{};
+
+     // entries after the failure never get played
+     while(minimizer->best.count > 0 && minimizer->best.entries[minimizer->best.count - 1].frame > fail_frame){
+          minimizer->best.count--;
+     }
+     minimizer->best_frame = fail_frame;
+
+     MinimizerCandidate_t replay {};
+     replay.demo = minimizer->best;
+     MinimizerSlot_t slot {};
+     minimizer->keyframe_count = 1;
+     minimizer_play(minimizer, &replay, 0, fail_frame - 1, true, &slot);
+}
+
+// replays the candidates and takes the first that fails the same way in fewer entries or frames
+static bool minimizer_try(Minimizer_t* minimizer, MinimizerCandidate_t* candidates, S32 count){
+     minimizer_replay(minimizer, candidates, count);
+
+     bool accepted = false;
+     for(S32 i = 0; i < count; i++){
+          MinimizerCandidate_t* candidate = candidates + i;
+          if(!accepted){
+               S64 fail_frame = minimizer_fail_frame(minimizer, candidate, minimizer->slots + i);
+               if(fail_frame >= 0 && (candidate->demo.count < minimizer->best.count || fail_frame < minimizer->best_frame)){
+                    minimizer_accept(minimizer, candidate, fail_frame);
+                    accepted = true;
+               }
+          }
+          free(candidate->demo.entries);
+          *candidate = MinimizerCandidate_t{};
+     }
+
+     return accepted;
+}
+
+static bool minimizer_remove(Minimizer_t* minimizer, MinimizerCandidate_t* candidate, S64 start, S64 end){
+     const MinimizerDemo_t* best = &minimizer->best;
+     candidate->demo.count = best->count - (end - start);
+     candidate->demo.entries = (DemoEntry_t*)(malloc((size_t)(candidate->demo.count + 1) * sizeof(DemoEntry_t)));
+     if(!candidate->demo.entries) return false;
+     memcpy(candidate->demo.entries, best->entries, (size_t)(start) * sizeof(DemoEntry_t));
+     memcpy(candidate->demo.entries + start, best->entries + end, (size_t)(best->count - end) * sizeof(DemoEntry_t));
+
+     candidate->first_changed_frame = best->entries[start].frame;
+     candidate->tail_index = start;
+     candidate->best_tail_index = end;
+     candidate->shift = 0;
+     return true;
+}
+
+static bool minimizer_shift(Minimizer_t* minimizer, MinimizerCandidate_t* candidate, S64 start, S64 shift){
+     const MinimizerDemo_t* best = &minimizer->best;
+     candidate->demo.count = best->count;
+     candidate->demo.entries = (DemoEntry_t*)(malloc((size_t)(best->count) * sizeof(DemoEntry_t)));
+     if(!candidate->demo.entries) return false;
+     memcpy(candidate->demo.entries, best->entries, (size_t)(best->count) * sizeof(DemoEntry_t));
+     for(S64 i = start; i < best->count; i++) candidate->demo.entries[i].frame -= shift;
+
+     candidate->first_changed_frame = best->entries[start].frame - shift;
+     candidate->tail_index = start;
+     candidate->best_tail_index = start;
+     candidate->shift = shift;
+     return true;
+}
+
+// delta debugging: drops ranges of entries, halving their size whenever none of them can go
+static bool minimizer_remove_ranges(Minimizer_t* minimizer, MinimizerCandidate_t* candidates){
+     bool changed = false;
+     S64 granularity = 2;
+
+     while(minimizer->best.count > 0){
+          S64 count = minimizer->best.count;
+          if(granularity > count) granularity = count;
+          S64 chunk = (count + granularity - 1) / granularity;
+
+          bool removed = false;
+          for(S64 first = 0; first < count && !removed; first += chunk * minimizer->thread_count){
+               S32 batch = 0;
+               for(S64 start = first; start < count && batch < minimizer->thread_count; start += chunk){
+                    if(minimizer_remove(minimizer, candidates + batch, start, MINIMUM(start + chunk, count))) batch++;
+               }
+               removed = minimizer_try(minimizer, candidates, batch);
+          }
+
+          if(removed){
+               changed = true;
+               granularity = MAXIMUM(granularity - 1, 2);
+               continue;
+          }
+
+          if(granularity >= count) break;
+          granularity = MINIMUM(granularity * 2, count);
+     }
+
+     return changed;
+}
+
+// pulls each entry and everything after it as much earlier as it can go, biggest squeezes first, which shortens holds
+// and waits
+static bool minimizer_squeeze_gaps(Minimizer_t* minimizer, MinimizerCandidate_t* candidates){
+     bool changed = false;
+
+     for(S64 i = 0; i < minimizer->best.count; i++){
+          S64 previous_frame = (i > 0) ? minimizer->best.entries[i - 1].frame : 1;
+          S64 gap = minimizer->best.entries[i].frame - previous_frame;
+
+          bool squeezed = false;
+          for(S64 shift = gap; shift > 0 && !squeezed;){
+               S32 batch = 0;
+               for(; shift > 0 && batch < minimizer->thread_count; shift /= 2){
+                    if(minimizer_shift(minimizer, candidates + batch, i, shift)) batch++;
+               }
+               squeezed = minimizer_try(minimizer, candidates, batch);
+          }
+
+          changed |= squeezed;
+     }
+
+     return changed;
+}
+
+static bool minimizer_load(Minimizer_t* minimizer, MinimizerCandidate_t* original){
+     const MinimizerOptions_t* options = minimizer->options;
+     World_t* world = &minimizer->world;
+     if(!load_map(options->map_filepath, &minimizer->player_start, &world->tilemap, &world->blocks, &world->interactives)){
+          LOG("minimizer failed to load map: %s\n", options->map_filepath);
+          return false;
+     }
+
+     Camera_t camera {};
+     reset_map(minimizer->player_start, world, &minimizer->undo, &camera);
+     minimizer->action = PlayerAction_t{};
+     minimizer->context = FrameContext_t{};
+     minimizer->context.undo = &minimizer->undo;
+     if(!minimizer_capture(minimizer, 0)) return false;
+
+     FILE* file = fopen(options->demo_filepath, "rb");
+     if(!file){
+          LOG("minimizer failed to open demo: %s\n", options->demo_filepath);
+          return false;
+     }
+     S32 version = 0;
+     fread(&version, sizeof(version), 1, file);
+     DemoEntries_t entries = demo_entries_get(file);
+     fclose(file);
+
+     if(entries.count <= 0 || entries.entries[entries.count - 1].player_action_type != PLAYER_ACTION_TYPE_END_DEMO){
+          LOG("minimizer found no end to demo: %s\n", options->demo_filepath);
+          free(entries.entries);
+          return false;
+     }
+
+     minimizer->end_frame = entries.entries[entries.count - 1].frame;
+     original->demo.entries = entries.entries;
+     original->demo.count = entries.count - 1;
+     original->first_changed_frame = 1;
+     return true;
+}
+
+MinimizerResult_t minimizer_minimize(const MinimizerOptions_t* options){
+     Minimizer_t* minimizer = new Minimizer_t;
+     minimizer->options = options;
+
+     minimizer->thread_count = options->thread_count;
+     if(minimizer->thread_count <= 0) minimizer->thread_count = (S32)(std::thread::hardware_concurrency());
+     if(minimizer->thread_count <= 0) minimizer->thread_count = 1;
+
+     void* slots = mmap(nullptr, (size_t)(minimizer->thread_count) * sizeof(MinimizerSlot_t), PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+     if(slots != MAP_FAILED) minimizer->slots = (MinimizerSlot_t*)(slots);
+
+     MinimizerCandidate_t* candidates = new MinimizerCandidate_t[minimizer->thread_count];
+
+     if(!minimizer->slots){
+          LOG("minimizer failed to map memory to share with its replays\n");
+     }else if(options->keyframe_interval <= 0){
+          LOG("minimizer keyframe interval has to be at least 1\n");
+     }else if(minimizer_load(minimizer, candidates)){
+          MinimizerResult_t* result = &minimizer->result;
+          result->original_entry_count = candidates[0].demo.count;
+          result->original_frame_count = minimizer->end_frame;
+
+          // how the original fails is what every candidate has to match
+          minimizer_replay(minimizer, candidates, 1);
+          MinimizerSlot_t* slot = minimizer->slots;
+          if(slot->outcome == MINIMIZER_OUTCOME_CRASHED){
+               minimizer->signal_number = slot->signal_number;
+               LOG("%s crashes with signal %d on %s at frame %" PRId64 "\n", options->demo_filepath,
+                   slot->signal_number, options->map_filepath, slot->frame);
+          }else if(slot->outcome == MINIMIZER_OUTCOME_FAILED){
+               memcpy(minimizer->failure, slot->failure, sizeof(minimizer->failure));
+               LOG("%s fails with %s on %s at frame %" PRId64 "\n", options->demo_filepath, slot->failure,
+                   options->map_filepath, slot->frame);
+          }else{
+               LOG("%s doesn't crash or break an invariant on %s, there is nothing to minimize\n", options->demo_filepath,
+                   options->map_filepath);
+          }
+
+          if(slot->outcome == MINIMIZER_OUTCOME_CRASHED || slot->outcome == MINIMIZER_OUTCOME_FAILED){
+               minimizer_accept(minimizer, candidates, slot->frame);
+               *candidates = MinimizerCandidate_t{};
+
+               while(true){
+                    bool removed = minimizer_remove_ranges(minimizer, candidates);
+                    bool squeezed = minimizer_squeeze_gaps(minimizer, candidates);
+                    LOG("minimizer down to %" PRId64 " entries across %" PRId64 " frames after %" PRId64 " replays\n",
+                        minimizer->best.count, minimizer->best_frame, result->replay_count);
+                    if(!removed && !squeezed) break;
+               }
+
+               // a crash can't be stepped up to, so its demo is checked against the map as it loaded, like the fuzzer's
+               MinimizerCandidate_t replay {};
+               replay.demo = minimizer->best;
+               MinimizerSlot_t final_slot {};
+               minimizer_play(minimizer, &replay, 0, minimizer->signal_number ? 0 : minimizer->best_frame, false,
+                              &final_slot);
+
+               World_t* world = &minimizer->world;
+               result->minimized = demo_write(options->out_filepath, minimizer->best.entries, minimizer->best.count,
+                                              minimizer->best_frame, minimizer->player_start, &world->tilemap,
+                                              &world->blocks, &world->interactives, &world->players);
+               result->entry_count = minimizer->best.count;
+               result->frame_count = minimizer->best_frame;
+          }
+     }
+
+     MinimizerResult_t result = minimizer->result;
+
+     free(candidates[0].demo.entries);
+     delete[] candidates;
+     if(minimizer->slots) munmap(minimizer->slots, (size_t)(minimizer->thread_count) * sizeof(MinimizerSlot_t));
+     for(S64 i = 0; i < minimizer->keyframe_allocated; i++) destroy(&minimizer->keyframes[i].snapshot);
+     free(minimizer->keyframes);
+     free(minimizer->best.entries);
+     destroy(&minimizer->scratch);
+     destroy(&minimizer->world);
+     destroy(&minimizer->undo);
+     delete minimizer;
+
+     return result;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "types.h"
+
+// shrinks a demo that crashes, asserts or breaks one of the fuzzer's invariants on a map down to the fewest inputs
+// and frames that still fail the same way. whole ranges of entries are dropped first (delta debugging, trying smaller
+// and smaller ranges), then the gaps between the entries that are left are squeezed, which shortens how long
+// directions are held and how long the player stands around. both repeat until neither finds anything.
+//
+// every candidate is replayed in a forked process, so crashing doesn't take the minimizer with it, and as many of
+// them run at once as there are threads. replays start from the latest keyframe of the current smallest demo that
+// comes before the candidate's first change, and stop early once the world lines up exactly with a keyframe of it
+// again, since from there on it has to fail the same way.
+//
+// a demo that only fails its end state check can't be minimized this way, any change to its input changes the end
+// state too
+
+struct MinimizerOptions_t{
+     const char* map_filepath = nullptr;
+     const char* demo_filepath = nullptr;
+     const char* out_filepath = "minimized.bd";
+     S32 thread_count = 0;          // candidates replayed at once, 0 uses one per hardware thread
+     S32 keyframe_interval = 30;    // frames between keyframes of the current smallest demo
+};
+
+struct MinimizerResult_t{
+     bool minimized = false;        // the demo failed to begin with and the smallest one was written
+     S64 original_entry_count = 0;
+     S64 original_frame_count = 0;
+     S64 entry_count = 0;
+     S64 frame_count = 0;           // frames until the failure
+     S64 replay_count = 0;          // candidates tried
+     S64 stepped_frame_count = 0;   // frames candidates actually stepped
+     S64 skipped_frame_count = 0;   // frames skipped by starting from a keyframe or lining up with one
+};
+
+MinimizerResult_t minimizer_minimize(const MinimizerOptions_t* options);
@@ -1,5 +1,8 @@
 #include "portal_exit.h"
 #include "utils.h"
+#include "log.h"
+
+#include <stdlib.h>
 
 static bool is_acceptable_portal(Interactive_t* interactive, bool require_on, bool from_on_wire){
     if(require_on) return is_active_portal(interactive);
@@ -84,8 +87,8 @@ void find_portal_exits_impl(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t<In
      }
 }
 
-PortalExit_t find_portal_exits(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_quad_tree,
-                               bool require_on){
+static PortalExit_t find_portal_exits_uncached(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_quad_tree,
+                                              bool require_on){
      PortalExit_t portal_exit = {};
      Interactive_t* interactive = quad_tree_interactive_find_at(interactive_quad_tree, coord);
      if(is_acceptable_portal(interactive, require_on, true)){
@@ -109,6 +112,112 @@ PortalExit_t find_portal_exits(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t
      return portal_exit;
 }
 
+static PortalExitCache_t* portal_exit_cache_for(TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_quad_tree){
+     PortalExitCache_t* cache = tilemap->portal_exit_cache;
+     if(!cache){
+          cache = (PortalExitCache_t*)(calloc(1, sizeof(*cache)));
+          if(!cache){
+               LOG("%s() failed to calloc portal exit cache\n", __FUNCTION__);
+               return nullptr;
+          }
+          tilemap->portal_exit_cache = cache;
+     }
+
+     if(cache->width != tilemap->width || cache->height != tilemap->height || !cache->slots){
+          free(cache->slots);
+          cache->slots = (PortalExitCacheSlot_t*)(calloc((size_t)(tilemap->width * tilemap->height * 2), sizeof(*cache->slots)));
+          if(!cache->slots){
+               LOG("%s() failed to calloc %dx%d portal exit cache slots\n", __FUNCTION__, tilemap->width, tilemap->height);
+               cache->width = 0;
+               cache->height = 0;
+               return nullptr;
+          }
+          cache->width = tilemap->width;
+          cache->height = tilemap->height;
+          cache->interactive_quad_tree = interactive_quad_tree;
+          cache->entry_count = 0;
+     }
+
+     // a rebuilt quad tree usually means the interactives moved, the cached exits can't be trusted
+     if(cache->interactive_quad_tree != interactive_quad_tree){
+          cache->interactive_quad_tree = interactive_quad_tree;
+          tilemap_invalidate_portal_exits(tilemap);
+     }
+
+     // generation 0 marks slots that were never calculated
+     if(tilemap->portal_exit_generation == 0) tilemap->portal_exit_generation = 1;
+
+     return cache;
+}
+
+PortalExit_t find_portal_exits(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_quad_tree,
+                               bool require_on){
+     if(coord.x < 0 || coord.x >= tilemap->width || coord.y < 0 || coord.y >= tilemap->height){
+          return find_portal_exits_uncached(coord, tilemap, interactive_quad_tree, require_on);
+     }
+
+     PortalExitCache_t* cache = tilemap->portal_exit_cache;
+     if(cache && cache->frozen){
+          if(cache->interactive_quad_tree == interactive_quad_tree && cache->width == tilemap->width && cache->height == tilemap->height){
+               const PortalExitCacheSlot_t* slot = cache->slots + ((coord.y * tilemap->width + coord.x) * 2 + (require_on ? 1 : 0));
+               if(slot->generation == tilemap->portal_exit_generation){
+                    if(slot->empty) return PortalExit_t{};
+                    return cache->entries[slot->entry - 1];
+               }
+          }
+          return find_portal_exits_uncached(coord, tilemap, interactive_quad_tree, require_on);
+     }
+
+     cache = portal_exit_cache_for(tilemap, interactive_quad_tree);
+     if(!cache) return find_portal_exits_uncached(coord, tilemap, interactive_quad_tree, require_on);
+
+     PortalExitCacheSlot_t* slot = cache->slots + ((coord.y * tilemap->width + coord.x) * 2 + (require_on ? 1 : 0));
+     if(slot->generation == tilemap->portal_exit_generation){
+          cache->hits++;
+          if(slot->empty) return PortalExit_t{};
+          return cache->entries[slot->entry - 1];
+     }
+
+     cache->misses++;
+     PortalExit_t portal_exit = find_portal_exits_uncached(coord, tilemap, interactive_quad_tree, require_on);
+
+     slot->empty = (portal_exit_count(&portal_exit) == 0);
+     if(!slot->empty && !slot->entry){
+          if(cache->entry_count >= cache->entry_allocated){
+               S32 new_allocated = cache->entry_allocated ? cache->entry_allocated * 2 : 16;
+               auto* new_entries = (PortalExit_t*)(realloc(cache->entries, new_allocated * sizeof(*cache->entries)));
+               if(!new_entries){
+                    LOG("%s() failed to realloc %d portal exit cache entries\n", __FUNCTION__, new_allocated);
+                    return portal_exit;
+               }
+               cache->entries = new_entries;
+               cache->entry_allocated = new_allocated;
+          }
+
+          cache->entry_count++;
+          slot->entry = cache->entry_count;
+     }
+     if(!slot->empty) cache->entries[slot->entry - 1] = portal_exit;
+
+     slot->generation = tilemap->portal_exit_generation;
+     return portal_exit;
+}
+
+void portal_exit_cache_freeze(TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_quad_tree){
+     PortalExitCache_t* cache = portal_exit_cache_for(tilemap, interactive_quad_tree);
+     if(cache) cache->frozen = true;
+}
+
+void portal_exit_cache_thaw(TileMap_t* tilemap){
+     if(tilemap->portal_exit_cache) tilemap->portal_exit_cache->frozen = false;
+}
+
+void destroy(PortalExitCache_t* cache){
+     free(cache->slots);
+     free(cache->entries);
+     memset(cache, 0, sizeof(*cache));
+}
+
 S8 portal_exit_count(const PortalExit_t* portal_exit){
     S8 count = 0;
     for (const auto &direction : portal_exit->directions) {
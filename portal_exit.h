@@ -15,6 +15,30 @@ struct PortalExit_t{
      PortalExitCoords_t directions[DIRECTION_COUNT];
 };
 
+// exits found by find_portal_exits() are kept per coord for each require_on, until the tilemap's portal exit
+// generation moves on
+struct PortalExitCacheSlot_t{
+     U32 generation; // 0 when never calculated
+     bool empty;
+     S32 entry; // index into the entries + 1, 0 until the coord first has exits
+};
+
+struct PortalExitCache_t{
+     PortalExitCacheSlot_t* slots; // 2 per tile, indexed by require_on
+     S16 width;
+     S16 height;
+     const QuadTreeNode_t<Interactive_t>* interactive_quad_tree;
+
+     PortalExit_t* entries;
+     S32 entry_count;
+     S32 entry_allocated;
+
+     U64 hits;
+     U64 misses;
+
+     bool frozen;
+};
+
 void portal_exit_add(PortalExit_t* portal_exit, Direction_t direction, Coord_t coord);
 void find_portal_exits_impl(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_quad_tree,
                             PortalExit_t* portal_exit, Direction_t from, bool from_on_wire, bool require_on = true);
@@ -22,3 +46,10 @@ PortalExit_t find_portal_exits(Coord_t coord, TileMap_t* tilemap, QuadTreeNode_t
                                bool require_on = true);
 
 S8 portal_exit_count(const PortalExit_t* portal_exit);
+
+// while frozen find_portal_exits() only reads the cache, so any number of threads may call it at once. exits the cache
+// doesn't have yet are found but not kept, nor counted
+void portal_exit_cache_freeze(TileMap_t* tilemap, QuadTreeNode_t<Interactive_t>* interactive_quad_tree);
+void portal_exit_cache_thaw(TileMap_t* tilemap);
+
+void destroy(PortalExitCache_t* cache);
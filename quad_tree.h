@@ -4,10 +4,23 @@
 #include "object_array.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #define QUAD_TREE_NODE_ENTRY_COUNT 4
 
+enum QuadTreeChild_t{
+     QUAD_TREE_CHILD_BOTTOM_LEFT,
+     QUAD_TREE_CHILD_BOTTOM_RIGHT,
+     QUAD_TREE_CHILD_TOP_LEFT,
+     QUAD_TREE_CHILD_TOP_RIGHT,
+     QUAD_TREE_CHILD_COUNT,
+};
+
+// all of a tree's nodes live in one allocation with the root first, so quad_tree_free() is a single free(). children
+// are indices relative to the root, and since the root is never anyone's child, 0 means the node has no children.
+// the nodes are laid out in morton (z) order: every node is followed by its bottom left, bottom right, top left and
+// top right subtrees, which is the order queries walk them in
 template <typename T>
 struct QuadTreeNode_t{
      T* entries[QUAD_TREE_NODE_ENTRY_COUNT];
@@ -15,70 +28,109 @@ struct QuadTreeNode_t{
 
      Rect_t bounds;
 
-     QuadTreeNode_t* bottom_left;
-     QuadTreeNode_t* bottom_right;
-     QuadTreeNode_t* top_left;
-     QuadTreeNode_t* top_right;
+     S32 children[QUAD_TREE_CHILD_COUNT];
 };
 
 template <typename T>
-bool quad_tree_insert(QuadTreeNode_t<T>* node, T* object);
+bool quad_tree_has_children(QuadTreeNode_t<T>* node){
+     return node->children[QUAD_TREE_CHILD_BOTTOM_LEFT] != 0;
+}
 
 template <typename T>
-bool quad_tree_subdivide(QuadTreeNode_t<T>* node){
-     if(node->bounds.left == node->bounds.right && node->bounds.bottom == node->bounds.top) return false;
+QuadTreeNode_t<T>* quad_tree_child(QuadTreeNode_t<T>* root, QuadTreeNode_t<T>* node, QuadTreeChild_t child){
+     return root + node->children[child];
+}
 
-     node->bottom_left = (QuadTreeNode_t<T>*)(calloc(1, sizeof(*node)));
-     if(!node->bottom_left) return false;
+// nodes are appended here as the tree is built, before quad_tree_build() lays them out in their final order
+template <typename T>
+struct QuadTreeBuildPool_t{
+     QuadTreeNode_t<T>* nodes;
+     S32 count;
+     S32 allocated;
+};
 
-     node->bottom_right = (QuadTreeNode_t<T>*)(calloc(1, sizeof(*node)));
-     if(!node->bottom_right) return false;
+template <typename T>
+S32 quad_tree_pool_add(QuadTreeBuildPool_t<T>* pool){
+     if(pool->count >= pool->allocated){
+          S32 new_allocated = pool->allocated ? pool->allocated * 2 : 64;
+          auto* nodes = (QuadTreeNode_t<T>*)(realloc(pool->nodes, new_allocated * sizeof(*pool->nodes)));
+          if(!nodes) return -1;
+          pool->nodes = nodes;
+          pool->allocated = new_allocated;
+     }
 
-     node->top_left = (QuadTreeNode_t<T>*)(calloc(1, sizeof(*node)));
-     if(!node->top_left) return false;
+     S32 index = pool->count;
+     memset(pool->nodes + index, 0, sizeof(*pool->nodes));
+     pool->count++;
+     return index;
+}
 
-     node->top_right = (QuadTreeNode_t<T>*)(calloc(1, sizeof(*node)));
-     if(!node->top_right) return false;
+template <typename T>
+bool quad_tree_insert(QuadTreeBuildPool_t<T>* pool, S32 node_index, T* object);
+
+template <typename T>
+bool quad_tree_subdivide(QuadTreeBuildPool_t<T>* pool, S32 node_index){
+     Rect_t bounds = pool->nodes[node_index].bounds;
+     if(bounds.left == bounds.right && bounds.bottom == bounds.top) return false;
+
+     // allocate first, adding to the pool can move the nodes
+     S32 children[QUAD_TREE_CHILD_COUNT];
+     for(S8 c = 0; c < QUAD_TREE_CHILD_COUNT; c++){
+          children[c] = quad_tree_pool_add(pool);
+          if(children[c] < 0) return false;
+     }
+
+     auto* node = pool->nodes + node_index;
+     for(S8 c = 0; c < QUAD_TREE_CHILD_COUNT; c++) node->children[c] = children[c];
+
+     auto* bottom_left = pool->nodes + children[QUAD_TREE_CHILD_BOTTOM_LEFT];
+     auto* bottom_right = pool->nodes + children[QUAD_TREE_CHILD_BOTTOM_RIGHT];
+     auto* top_left = pool->nodes + children[QUAD_TREE_CHILD_TOP_LEFT];
+     auto* top_right = pool->nodes + children[QUAD_TREE_CHILD_TOP_RIGHT];
 
      S16 half_width = (node->bounds.right - node->bounds.left) / (S16)(2);
      S16 half_height = (node->bounds.top - node->bounds.bottom) / (S16)(2);
 
-     node->bottom_left->bounds.left = node->bounds.left;
-     node->bottom_left->bounds.right = node->bounds.left + half_width;
-     node->bottom_left->bounds.bottom = node->bounds.bottom;
-     node->bottom_left->bounds.top = node->bounds.bottom + half_height;
+     bottom_left->bounds.left = node->bounds.left;
+     bottom_left->bounds.right = node->bounds.left + half_width;
+     bottom_left->bounds.bottom = node->bounds.bottom;
+     bottom_left->bounds.top = node->bounds.bottom + half_height;
 
-     node->bottom_right->bounds.left = node->bottom_left->bounds.right + (S16)(1);
-     node->bottom_right->bounds.right = node->bounds.right;
-     node->bottom_right->bounds.bottom = node->bounds.bottom;
-     node->bottom_right->bounds.top = node->bounds.bottom + half_height;
+     bottom_right->bounds.left = bottom_left->bounds.right + (S16)(1);
+     bottom_right->bounds.right = node->bounds.right;
+     bottom_right->bounds.bottom = node->bounds.bottom;
+     bottom_right->bounds.top = node->bounds.bottom + half_height;
 
-     node->top_left->bounds.left = node->bounds.left;
-     node->top_left->bounds.right = node->bounds.left + half_width;
-     node->top_left->bounds.bottom = node->bottom_left->bounds.top + (S16)(1);
-     node->top_left->bounds.top = node->bounds.top;
+     top_left->bounds.left = node->bounds.left;
+     top_left->bounds.right = node->bounds.left + half_width;
+     top_left->bounds.bottom = bottom_left->bounds.top + (S16)(1);
+     top_left->bounds.top = node->bounds.top;
 
-     node->top_right->bounds.left = node->bottom_right->bounds.left;
-     node->top_right->bounds.right = node->bottom_right->bounds.right;
-     node->top_right->bounds.bottom = node->bottom_left->bounds.top + (S16)(1);
-     node->top_right->bounds.top = node->bounds.top;
+     top_right->bounds.left = bottom_right->bounds.left;
+     top_right->bounds.right = bottom_right->bounds.right;
+     top_right->bounds.bottom = bottom_left->bounds.top + (S16)(1);
+     top_right->bounds.top = node->bounds.top;
 
-     for(S8 i = 0; i < node->entry_count; i++){
-          if(quad_tree_insert(node->bottom_left, node->entries[i])) continue;
-          if(quad_tree_insert(node->bottom_right, node->entries[i])) continue;
-          if(quad_tree_insert(node->top_left, node->entries[i])) continue;
-          if(quad_tree_insert(node->top_right, node->entries[i])) continue;
+     S8 entry_count = node->entry_count;
+     T* entries[QUAD_TREE_NODE_ENTRY_COUNT];
+     memcpy(entries, node->entries, sizeof(entries));
+     node->entry_count = 0;
+
+     for(S8 i = 0; i < entry_count; i++){
+          for(S8 c = 0; c < QUAD_TREE_CHILD_COUNT; c++){
+               if(quad_tree_insert(pool, children[c], entries[i])) break;
+          }
      }
 
-     node->entry_count = 0;
      return true;
 }
 
 template <typename T>
-bool quad_tree_insert(QuadTreeNode_t<T>* node, T* object){
+bool quad_tree_insert(QuadTreeBuildPool_t<T>* pool, S32 node_index, T* object){
+     auto* node = pool->nodes + node_index;
      if(!xy_in_rect(node->bounds, get_object_x(object), get_object_y(object))) return false;
 
-     if(node->entry_count == 0 && node->bottom_left){
+     if(node->entry_count == 0 && quad_tree_has_children(node)){
           // pass if the node is empty and has been subdivided
      }else{
           if(node->entry_count < QUAD_TREE_NODE_ENTRY_COUNT){
@@ -88,56 +140,81 @@ bool quad_tree_insert(QuadTreeNode_t<T>* node, T* object){
           }
      }
 
-     if(!node->bottom_left){
-          if(!quad_tree_subdivide(node)) return false; // nomem
+     if(!quad_tree_has_children(node)){
+          if(!quad_tree_subdivide(pool, node_index)) return false; // nomem
      }
 
-     if(quad_tree_insert(node->bottom_left, object)) return true;
-     if(quad_tree_insert(node->bottom_right, object)) return true;
-     if(quad_tree_insert(node->top_left, object)) return true;
-     if(quad_tree_insert(node->top_right, object)) return true;
+     // subdividing may have moved the nodes
+     S32 children[QUAD_TREE_CHILD_COUNT];
+     memcpy(children, pool->nodes[node_index].children, sizeof(children));
+
+     for(S8 c = 0; c < QUAD_TREE_CHILD_COUNT; c++){
+          if(quad_tree_insert(pool, children[c], object)) return true;
+     }
 
      return true;
 }
 
+// a node's children split its bounds without overlapping, so only one of them can hold x, y
 template <typename T>
-T* quad_tree_find_at(QuadTreeNode_t<T>* node, S16 x, S16 y){
-     if(!xy_in_rect(node->bounds, x, y)) return nullptr;
+T* quad_tree_find_at(QuadTreeNode_t<T>* root, S16 x, S16 y){
+     if(!root) return nullptr;
+     if(!xy_in_rect(root->bounds, x, y)) return nullptr;
+
+     auto* node = root;
+     while(true){
+          for(S8 i = 0; i < node->entry_count; i++){
+               if(get_object_x(node->entries[i]) == x &&
+                  get_object_y(node->entries[i]) == y) return node->entries[i];
+          }
 
-     for(S8 i = 0; i < node->entry_count; i++){
-          if(get_object_x(node->entries[i]) == x &&
-             get_object_y(node->entries[i]) == y) return node->entries[i];
-     }
+          if(!quad_tree_has_children(node)) return nullptr;
 
-     if(node->bottom_left){
-          auto* result = quad_tree_find_at(node->bottom_left, x, y);
-          if(result) return result;
-          result = quad_tree_find_at(node->bottom_right, x, y);
-          if(result) return result;
-          result = quad_tree_find_at(node->top_left, x, y);
-          if(result) return result;
-          result = quad_tree_find_at(node->top_right, x, y);
-          if(result) return result;
+          auto* bottom_left = quad_tree_child(root, node, QUAD_TREE_CHILD_BOTTOM_LEFT);
+          bool right = x > bottom_left->bounds.right;
+          bool top = y > bottom_left->bounds.top;
+          if(top){
+               node = quad_tree_child(root, node, right ? QUAD_TREE_CHILD_TOP_RIGHT : QUAD_TREE_CHILD_TOP_LEFT);
+          }else{
+               node = quad_tree_child(root, node, right ? QUAD_TREE_CHILD_BOTTOM_RIGHT : QUAD_TREE_CHILD_BOTTOM_LEFT);
+          }
      }
-
-     return nullptr;
 }
 
 template <typename T>
 void quad_tree_free(QuadTreeNode_t<T>* root){
-     if(!root) return;
-     if(root->top_left) quad_tree_free(root->top_left);
-     if(root->top_right) quad_tree_free(root->top_right);
-     if(root->bottom_left) quad_tree_free(root->bottom_left);
-     if(root->bottom_right) quad_tree_free(root->bottom_right);
      free(root);
 }
 
+// copies the subtree at index into layout in depth first (morton) order and returns where it ended up
+template <typename T>
+S32 quad_tree_layout(QuadTreeBuildPool_t<T>* pool, S32 index, QuadTreeNode_t<T>* layout, S32* layout_count){
+     S32 layout_index = *layout_count;
+     (*layout_count)++;
+
+     layout[layout_index] = pool->nodes[index];
+     if(quad_tree_has_children(pool->nodes + index)){
+          for(S8 c = 0; c < QUAD_TREE_CHILD_COUNT; c++){
+               S32 child_index = quad_tree_layout(pool, pool->nodes[index].children[c], layout, layout_count);
+               layout[layout_index].children[c] = child_index;
+          }
+     }
+
+     return layout_index;
+}
+
 template <typename T>
 QuadTreeNode_t<T>* quad_tree_build(ObjectArray_t<T>* array){
      if(array->count == 0) return nullptr;
 
-     QuadTreeNode_t<T>* root = (QuadTreeNode_t<T>*)(calloc(1, sizeof(*root)));
+     QuadTreeBuildPool_t<T> pool = {};
+     S32 root_index = quad_tree_pool_add(&pool);
+     if(root_index < 0){
+          LOG("%s() failed to allocate quad tree nodes\n", __FUNCTION__);
+          return nullptr;
+     }
+
+     auto* root = pool.nodes + root_index;
      root->bounds.left = get_object_x(array->elements + 0);
      root->bounds.right = get_object_x(array->elements + 0);
      root->bounds.bottom = get_object_y(array->elements + 0);
@@ -155,41 +232,160 @@ QuadTreeNode_t<T>* quad_tree_build(ObjectArray_t<T>* array){
 
      // insert coords
      for(int i = 0; i < array->count; i++){
-          if(!quad_tree_insert(root, array->elements + i)) break;
+          if(!quad_tree_insert(&pool, root_index, array->elements + i)) break;
+     }
+
+     auto* layout = (QuadTreeNode_t<T>*)(malloc(pool.count * sizeof(*pool.nodes)));
+     if(!layout){
+          LOG("%s() failed to malloc %d quad tree nodes\n", __FUNCTION__, pool.count);
+          free(pool.nodes);
+          return nullptr;
      }
 
-     return root;
+     S32 layout_count = 0;
+     quad_tree_layout(&pool, root_index, layout, &layout_count);
+     free(pool.nodes);
+
+     return layout;
 }
 
+// objects are stored at their x/y, which are S16s, and every level halves a node's bounds, so a tree is at most 17 levels
+// deep. walking it depth first leaves at most 3 siblings per level waiting on the stack
+#define QUAD_TREE_QUERY_STACK_SIZE 64
+
+// walks the objects inside a rect one at a time, in the order a recursive depth first search would find them (a
+// node's entries, then its bottom left, bottom right, top left and top right children), so there is no limit on how
+// many objects a query can find and callers can stop whenever they like
+//
+//      auto query = quad_tree_query(block_qt, rect);
+//      while(Block_t* block = quad_tree_query_next(&query)){
+//           ...
+//      }
 template <typename T>
-void quad_tree_find_in_impl(QuadTreeNode_t<T>* node, Rect_t rect, T** results_array, S16* count, S16 max_array_count){
-     if(!rect_in_rect(rect, node->bounds) && !rect_in_rect(node->bounds, rect)) return;
+bool quad_tree_node_overlaps(QuadTreeNode_t<T>* node, Rect_t rect){
+     return rect_in_rect(rect, node->bounds) || rect_in_rect(node->bounds, rect);
+}
 
-     for(S8 i = 0; i < node->entry_count; i++){
-          if(*count >= max_array_count){
-               assert(!"hit max array count when querying quad tree!");
-               return;
+template <typename T>
+struct QuadTreeQuery_t{
+     Rect_t rect;
+     QuadTreeNode_t<T>* root;
+
+     QuadTreeNode_t<T>* stack[QUAD_TREE_QUERY_STACK_SIZE];
+     S8 stack_count;
+
+     QuadTreeNode_t<T>* node; // the node whose entries we are walking through
+     S8 entry_index;
+};
+
+template <typename T>
+QuadTreeQuery_t<T> quad_tree_query(QuadTreeNode_t<T>* root, Rect_t rect){
+     QuadTreeQuery_t<T> query;
+     query.rect = rect;
+     query.root = root;
+     query.stack_count = 0;
+     query.node = nullptr;
+     query.entry_index = 0;
+     if(root && quad_tree_node_overlaps(root, rect)) query.stack[query.stack_count++] = root;
+     return query;
+}
+
+template <typename T>
+T* quad_tree_query_next(QuadTreeQuery_t<T>* query){
+     while(true){
+          if(query->node){
+               while(query->entry_index < query->node->entry_count){
+                    T* entry = query->node->entries[query->entry_index];
+                    query->entry_index++;
+                    if(xy_in_rect(query->rect, get_object_x(entry), get_object_y(entry))) return entry;
+               }
+
+               query->node = nullptr;
           }
 
-          S16 x = get_object_x(node->entries[i]);
-          S16 y = get_object_y(node->entries[i]);
-          if(xy_in_rect(rect, x, y)){
-               results_array[*count] = node->entries[i];
-               (*count)++;
+          if(query->stack_count == 0) return nullptr;
+
+          auto* node = query->stack[--query->stack_count];
+
+          // pushed in reverse so they come off the stack in the order we visit them, children outside the rect are
+          // never pushed at all
+          if(quad_tree_has_children(node)){
+               assert(query->stack_count + QUAD_TREE_CHILD_COUNT <= QUAD_TREE_QUERY_STACK_SIZE);
+               for(S8 c = QUAD_TREE_CHILD_COUNT - 1; c >= 0; c--){
+                    auto* child = quad_tree_child(query->root, node, (QuadTreeChild_t)(c));
+                    if(!quad_tree_node_overlaps(child, query->rect)) continue;
+                    query->stack[query->stack_count++] = child;
+               }
           }
+
+          query->node = node;
+          query->entry_index = 0;
      }
+}
+
+// calls visit(object) for every object inside the rect, in the same order as quad_tree_query_next(). visit returns
+// false to stop the query early, in which case this returns false too
+template <typename T, typename Visit>
+bool quad_tree_visit_in(QuadTreeNode_t<T>* root, Rect_t rect, Visit visit){
+     auto query = quad_tree_query(root, rect);
+     while(T* object = quad_tree_query_next(&query)){
+          if(!visit(object)) return false;
+     }
+     return true;
+}
+
+#define QUAD_TREE_RESULTS_INLINE_COUNT 32
+
+// for callers that need all the results at once (to sort them, say). small queries fit in the inline entries, bigger
+// ones move everything to the heap, so call destroy() when done with it
+template <typename T>
+struct QuadTreeResults_t{
+     T* inline_entries[QUAD_TREE_RESULTS_INLINE_COUNT];
+     T** heap_entries = nullptr;
+     S16 count = 0;
+     S16 allocated = QUAD_TREE_RESULTS_INLINE_COUNT;
+
+     T** entries(){
+          return heap_entries ? heap_entries : inline_entries;
+     }
+
+     bool add(T* entry){
+          if(count >= allocated){
+               S32 new_allocated = (S32)(allocated) * 2;
+               if(new_allocated > INT16_MAX) new_allocated = INT16_MAX;
+               if(count >= new_allocated) return false;
+
+               T** new_entries = (T**)(realloc(heap_entries, new_allocated * sizeof(*new_entries)));
+               if(!new_entries){
+                    LOG("%s() failed to realloc %d quad tree results\n", __FUNCTION__, new_allocated);
+                    return false;
+               }
+
+               if(!heap_entries) memcpy(new_entries, inline_entries, count * sizeof(*new_entries));
+               heap_entries = new_entries;
+               allocated = (S16)(new_allocated);
+          }
+
+          entries()[count] = entry;
+          count++;
+          return true;
+     }
+};
+
+template <typename T>
+void quad_tree_find_in(QuadTreeNode_t<T>* root, Rect_t rect, QuadTreeResults_t<T>* results){
+     results->count = 0;
 
-     if(node->bottom_left){
-          quad_tree_find_in_impl(node->bottom_left, rect, results_array, count, max_array_count);
-          quad_tree_find_in_impl(node->bottom_right, rect, results_array, count, max_array_count);
-          quad_tree_find_in_impl(node->top_left, rect, results_array, count, max_array_count);
-          quad_tree_find_in_impl(node->top_right, rect, results_array, count, max_array_count);
+     auto query = quad_tree_query(root, rect);
+     while(T* object = quad_tree_query_next(&query)){
+          if(!results->add(object)) return;
      }
 }
 
-// NOTE: must free returned array !
 template <typename T>
-void quad_tree_find_in(QuadTreeNode_t<T>* node, Rect_t rect, T** results_array, S16* count, S16 max_array_count){
-     *count = 0;
-     quad_tree_find_in_impl(node, rect, results_array, count, max_array_count);
+void destroy(QuadTreeResults_t<T>* results){
+     free(results->heap_entries);
+     results->heap_entries = nullptr;
+     results->count = 0;
+     results->allocated = QUAD_TREE_RESULTS_INLINE_COUNT;
 }
@@ -0,0 +1,231 @@
+#include "rasterizer.h"
+#include "defines.h"
+#include "log.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+bool init(RasterTarget_t* target, S32 width, S32 height){
+     target->pixels = (AlphaBitmapPixel_t*)(calloc(width * height, sizeof(*target->pixels)));
+     if(!target->pixels){
+          LOG("%s() failed to calloc %dx%d pixels\n", __FUNCTION__, width, height);
+          return false;
+     }
+     target->width = width;
+     target->height = height;
+     return true;
+}
+
+void destroy(RasterTarget_t* target){
+     free(target->pixels);
+     target->pixels = nullptr;
+     target->width = 0;
+     target->height = 0;
+}
+
+static F32 raster_clamp_channel(F32 value){
+     CLAMP(value, 0.0f, 1.0f);
+     return value;
+}
+
+static U8 raster_channel_to_byte(F32 value){
+     return (U8)(raster_clamp_channel(value) * 255.0f + 0.5f);
+}
+
+// matches glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA) which we use for every draw
+static void raster_blend(AlphaBitmapPixel_t* dst, F32 red, F32 green, F32 blue, F32 alpha){
+     F32 inv_alpha = 1.0f - alpha;
+     dst->red = raster_channel_to_byte(red * alpha + ((F32)(dst->red) / 255.0f) * inv_alpha);
+     dst->green = raster_channel_to_byte(green * alpha + ((F32)(dst->green) / 255.0f) * inv_alpha);
+     dst->blue = raster_channel_to_byte(blue * alpha + ((F32)(dst->blue) / 255.0f) * inv_alpha);
+     dst->alpha = raster_channel_to_byte(alpha * alpha + ((F32)(dst->alpha) / 255.0f) * inv_alpha);
+}
+
+// nearest sampling with GL_REPEAT wrapping
+static const AlphaBitmapPixel_t* raster_sample(const AlphaBitmap_t* bitmap, F32 u, F32 v){
+     S32 x = (S32)(floorf(u * (F32)(bitmap->width))) % bitmap->width;
+     S32 y = (S32)(floorf(v * (F32)(bitmap->height))) % bitmap->height;
+     if(x < 0) x += bitmap->width;
+     if(y < 0) y += bitmap->height;
+     return bitmap->pixels + (y * bitmap->width + x);
+}
+
+struct RasterRect_t{
+     S32 left;
+     S32 bottom;
+     S32 right; // exclusive
+     S32 top; // exclusive
+
+     // screen space edges of the quad before pixel snapping, used for texture interpolation
+     F32 screen_left;
+     F32 screen_bottom;
+     F32 screen_right;
+     F32 screen_top;
+
+     Quad_t tex;
+};
+
+// pixels are covered when their center is inside the quad, the same rule gl uses
+static bool raster_rect_from_command(const RenderCommand_t* command, Quad_t view, const RasterTarget_t* target,
+                                     RasterRect_t* rect){
+     F32 view_width = view.right - view.left;
+     F32 view_height = view.top - view.bottom;
+     if(view_width == 0 || view_height == 0) return false;
+
+     rect->screen_left = ((command->quad.left - view.left) / view_width) * (F32)(target->width);
+     rect->screen_right = ((command->quad.right - view.left) / view_width) * (F32)(target->width);
+     rect->screen_bottom = ((command->quad.bottom - view.bottom) / view_height) * (F32)(target->height);
+     rect->screen_top = ((command->quad.top - view.bottom) / view_height) * (F32)(target->height);
+     rect->tex = command->tex;
+
+     if(rect->screen_left > rect->screen_right){
+          SWAP(rect->screen_left, rect->screen_right);
+          SWAP(rect->tex.left, rect->tex.right);
+     }
+
+     if(rect->screen_bottom > rect->screen_top){
+          SWAP(rect->screen_bottom, rect->screen_top);
+          SWAP(rect->tex.bottom, rect->tex.top);
+     }
+
+     rect->left = (S32)(ceilf(rect->screen_left - 0.5f));
+     rect->right = (S32)(ceilf(rect->screen_right - 0.5f));
+     rect->bottom = (S32)(ceilf(rect->screen_bottom - 0.5f));
+     rect->top = (S32)(ceilf(rect->screen_top - 0.5f));
+
+     return rect->left < rect->right && rect->bottom < rect->top;
+}
+
+static void rasterize_quad(const RenderCommand_t* command, Quad_t view, RasterTarget_t* target, S32 band_bottom, S32 band_top){
+     RasterRect_t rect;
+     if(!raster_rect_from_command(command, view, target, &rect)) return;
+
+     S32 left = MAXIMUM(rect.left, 0);
+     S32 right = MINIMUM(rect.right, target->width);
+     S32 bottom = MAXIMUM(rect.bottom, band_bottom);
+     S32 top = MINIMUM(rect.top, band_top);
+     if(left >= right || bottom >= top) return;
+
+     F32 red = raster_clamp_channel(command->color.red);
+     F32 green = raster_clamp_channel(command->color.green);
+     F32 blue = raster_clamp_channel(command->color.blue);
+     F32 alpha = raster_clamp_channel(command->color.alpha);
+
+     const AlphaBitmap_t* bitmap = nullptr;
+     if(command->texture && command->texture->bitmap.pixels) bitmap = &command->texture->bitmap;
+
+     F32 u_per_pixel = (rect.tex.right - rect.tex.left) / (rect.screen_right - rect.screen_left);
+     F32 v_per_pixel = (rect.tex.top - rect.tex.bottom) / (rect.screen_top - rect.screen_bottom);
+
+     for(S32 y = bottom; y < top; y++){
+          AlphaBitmapPixel_t* dst = target->pixels + (y * target->width + left);
+          F32 v = rect.tex.bottom + (((F32)(y) + 0.5f) - rect.screen_bottom) * v_per_pixel;
+
+          for(S32 x = left; x < right; x++){
+               if(bitmap){
+                    F32 u = rect.tex.left + (((F32)(x) + 0.5f) - rect.screen_left) * u_per_pixel;
+                    const AlphaBitmapPixel_t* texel = raster_sample(bitmap, u, v);
+                    F32 texel_alpha = alpha * ((F32)(texel->alpha) / 255.0f);
+                    if(texel_alpha > 0){
+                         raster_blend(dst, red * ((F32)(texel->red) / 255.0f),
+                                      green * ((F32)(texel->green) / 255.0f),
+                                      blue * ((F32)(texel->blue) / 255.0f),
+                                      texel_alpha);
+                    }
+               }else{
+                    raster_blend(dst, red, green, blue, alpha);
+               }
+               dst++;
+          }
+     }
+}
+
+static void rasterize_quad_outline(const RenderCommand_t* command, Quad_t view, RasterTarget_t* target, S32 band_bottom, S32 band_top){
+     RasterRect_t rect;
+     if(!raster_rect_from_command(command, view, target, &rect)) return;
+
+     F32 red = raster_clamp_channel(command->color.red);
+     F32 green = raster_clamp_channel(command->color.green);
+     F32 blue = raster_clamp_channel(command->color.blue);
+     F32 alpha = raster_clamp_channel(command->color.alpha);
+
+     for(S32 y = MAXIMUM(rect.bottom, band_bottom); y < MINIMUM(rect.top, band_top); y++){
+          bool edge_row = (y == rect.bottom || y == rect.top - 1);
+          for(S32 x = MAXIMUM(rect.left, 0); x < MINIMUM(rect.right, target->width); x++){
+               if(!edge_row && x != rect.left && x != rect.right - 1) continue;
+               raster_blend(target->pixels + (y * target->width + x), red, green, blue, alpha);
+          }
+     }
+}
+
+static void rasterize_band(const RenderBuffer_t* buffer, RasterTarget_t* target, S32 band_bottom, S32 band_top){
+     Quad_t view {0.0f, 0.0f, 1.0f, 1.0f};
+
+     for(S32 i = 0; i < buffer->count; i++){
+          const RenderCommand_t* command = buffer->commands + i;
+
+          switch(command->type){
+          default:
+               break;
+          case RENDER_COMMAND_CLEAR:
+          {
+               AlphaBitmapPixel_t clear_pixel {raster_channel_to_byte(command->color.red),
+                                               raster_channel_to_byte(command->color.green),
+                                               raster_channel_to_byte(command->color.blue),
+                                               raster_channel_to_byte(command->color.alpha)};
+               AlphaBitmapPixel_t* dst = target->pixels + band_bottom * target->width;
+               S32 pixel_count = (band_top - band_bottom) * target->width;
+               for(S32 p = 0; p < pixel_count; p++) dst[p] = clear_pixel;
+          } break;
+          case RENDER_COMMAND_VIEW:
+               view = command->quad;
+               break;
+          case RENDER_COMMAND_QUAD:
+               rasterize_quad(command, view, target, band_bottom, band_top);
+               break;
+          case RENDER_COMMAND_QUAD_OUTLINE:
+               rasterize_quad_outline(command, view, target, band_bottom, band_top);
+               break;
+          }
+     }
+}
+
+struct RasterizeBandJob_t{
+     const RenderBuffer_t* buffer;
+     RasterTarget_t* target;
+     S32 band_height;
+};
+
+static void rasterize_band_job(void* data, S32 index){
+     auto* job = (RasterizeBandJob_t*)(data);
+     S32 band_bottom = index * job->band_height;
+     S32 band_top = MINIMUM(band_bottom + job->band_height, job->target->height);
+     rasterize_band(job->buffer, job->target, band_bottom, band_top);
+}
+
+void rasterize(RenderBuffer_t* buffer, RasterTarget_t* target, JobSystem_t* jobs){
+     render_sort(buffer);
+
+     S32 band_count = (jobs ? jobs->thread_count : 0) + 1;
+     if(band_count > target->height) band_count = target->height;
+
+     if(band_count > 0){
+          // every band replays all commands in order, so blending is the same no matter how many bands there are
+          S32 band_height = (target->height + band_count - 1) / band_count;
+          band_count = (target->height + band_height - 1) / band_height;
+
+          RasterizeBandJob_t job {buffer, target, band_height};
+          job_system_parallel_for(jobs, band_count, 1, rasterize_band_job, &job);
+     }
+
+     buffer->count = 0;
+}
+
+Raw_t raster_target_to_bitmap(const RasterTarget_t* target){
+     Bitmap_t bitmap = bitmap_create(target->width, target->height);
+     if(!bitmap.pixels) return bitmap.raw;
+
+     bitmap_swizzle_rgba_to_file_order((const U8*)(target->pixels), bitmap.pixels, target->width * target->height);
+
+     return bitmap.raw;
+}
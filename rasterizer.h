@@ -0,0 +1,22 @@
+#pragma once
+
+#include "render.h"
+#include "job_system.h"
+
+// rgba buffer with rows stored bottom to top, the same as a gl framebuffer and a bitmap file
+struct RasterTarget_t{
+     AlphaBitmapPixel_t* pixels = nullptr;
+     S32 width = 0;
+     S32 height = 0;
+};
+
+bool init(RasterTarget_t* target, S32 width, S32 height);
+void destroy(RasterTarget_t* target);
+
+// software backend for a RenderBuffer_t, the target is split into horizontal bands, one for each of the job system's
+// workers and one for the calling thread, that are rasterized in parallel. without a job system it is all one band. the
+// buffer is emptied afterwards like render_flush_opengl()
+void rasterize(RenderBuffer_t* buffer, RasterTarget_t* target, JobSystem_t* jobs = nullptr);
+
+// 24 bit bitmap file in memory of the target, suitable for a map thumbnail
+Raw_t raster_target_to_bitmap(const RasterTarget_t* target);
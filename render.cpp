@@ -0,0 +1,359 @@
+#include "render.h"
+#include "log.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static RenderBuffer_t* current_buffer = nullptr;
+
+static RenderCommand_t* render_push_command(RenderCommandType_t type){
+     assert(current_buffer);
+
+     if(current_buffer->count >= current_buffer->allocated){
+          S32 new_allocated = current_buffer->allocated ? current_buffer->allocated * 2 : 1024;
+          auto* new_commands = (RenderCommand_t*)(realloc(current_buffer->commands, new_allocated * sizeof(RenderCommand_t)));
+          if(!new_commands){
+               LOG("%s() failed to realloc %d render commands\n", __FUNCTION__, new_allocated);
+               return nullptr;
+          }
+          current_buffer->commands = new_commands;
+          current_buffer->allocated = new_allocated;
+     }
+
+     RenderCommand_t* command = current_buffer->commands + current_buffer->count;
+     current_buffer->count++;
+
+     command->type = type;
+     command->sort_key = ((U64)(current_buffer->layer_key) << 32) | (U64)(current_buffer->count - 1);
+     command->texture = current_buffer->texture;
+     command->color = current_buffer->color;
+     return command;
+}
+
+void destroy(RenderBuffer_t* buffer){
+     free(buffer->commands);
+     buffer->commands = nullptr;
+     buffer->count = 0;
+     buffer->allocated = 0;
+
+     free(buffer->vertices);
+     buffer->vertices = nullptr;
+     buffer->vertices_allocated = 0;
+}
+
+void render_begin(RenderBuffer_t* buffer){
+     current_buffer = buffer;
+     current_buffer->texture = nullptr;
+     current_buffer->texture_region = Quad_t{0.0f, 0.0f, 1.0f, 1.0f};
+     current_buffer->color = RenderColor_t{1.0f, 1.0f, 1.0f, 1.0f};
+     current_buffer->layer_key = 0;
+}
+
+RenderBuffer_t* render_current_buffer(){
+     return current_buffer;
+}
+
+void render_clear(F32 red, F32 green, F32 blue, F32 alpha){
+     auto* command = render_push_command(RENDER_COMMAND_CLEAR);
+     if(!command) return;
+     command->color = RenderColor_t{red, green, blue, alpha};
+}
+
+void render_view(Quad_t view){
+     current_buffer->layer_key = 0;
+     auto* command = render_push_command(RENDER_COMMAND_VIEW);
+     if(!command) return;
+     command->quad = view;
+}
+
+void render_layer(U16 layer, S16 row){
+     current_buffer->layer_key = ((U32)(layer) << 16) | (U32)((U16)(0x7FFF - row));
+}
+
+void render_bind_texture(const Texture_t* texture){
+     if(texture && texture->atlas){
+          current_buffer->texture = texture->atlas;
+          current_buffer->texture_region = texture->atlas_region;
+     }else{
+          current_buffer->texture = texture;
+          current_buffer->texture_region = Quad_t{0.0f, 0.0f, 1.0f, 1.0f};
+     }
+}
+
+void render_color(F32 red, F32 green, F32 blue, F32 alpha){
+     current_buffer->color = RenderColor_t{red, green, blue, alpha};
+}
+
+void render_quad(Vec_t pos, Vec_t dim, Vec_t tex, Vec_t tex_dim){
+     auto* command = render_push_command(RENDER_COMMAND_QUAD);
+     if(!command) return;
+     command->quad = Quad_t{pos.x, pos.y, pos.x + dim.x, pos.y + dim.y};
+
+     const Quad_t* region = &current_buffer->texture_region;
+     F32 region_width = region->right - region->left;
+     F32 region_height = region->top - region->bottom;
+     command->tex = Quad_t{region->left + tex.x * region_width, region->bottom + tex.y * region_height,
+                           region->left + (tex.x + tex_dim.x) * region_width,
+                           region->bottom + (tex.y + tex_dim.y) * region_height};
+}
+
+void render_flat_quad(const Quad_t* quad){
+     auto* command = render_push_command(RENDER_COMMAND_QUAD);
+     if(!command) return;
+     command->quad = *quad;
+
+     const Texture_t* texture = command->texture;
+     if(texture && texture->has_white_texel){
+          command->tex = Quad_t{texture->white_texel.x, texture->white_texel.y, texture->white_texel.x, texture->white_texel.y};
+     }else{
+          command->texture = nullptr;
+          command->tex = Quad_t{};
+     }
+}
+
+void render_quad_outline(const Quad_t* quad){
+     auto* command = render_push_command(RENDER_COMMAND_QUAD_OUTLINE);
+     if(!command) return;
+     command->texture = nullptr;
+     command->quad = *quad;
+     command->tex = Quad_t{};
+}
+
+void render_append(const RenderCommand_t* commands, S32 count){
+     for(S32 i = 0; i < count; i++){
+          auto* command = render_push_command(commands[i].type);
+          if(!command) return;
+          U64 sort_key = command->sort_key;
+          *command = commands[i];
+          command->sort_key = sort_key;
+     }
+}
+
+static int render_sort_key_comparer(const void* a, const void* b){
+     U64 a_key = ((const RenderCommand_t*)(a))->sort_key;
+     U64 b_key = ((const RenderCommand_t*)(b))->sort_key;
+     if(a_key < b_key) return -1;
+     if(a_key > b_key) return 1;
+     return 0;
+}
+
+static void render_sort_range(RenderCommand_t* commands, S32 count){
+     for(S32 i = 1; i < count; i++){
+          if(commands[i].sort_key < commands[i - 1].sort_key){
+               // the record order in the lower half of the key keeps this stable
+               qsort(commands, count, sizeof(*commands), render_sort_key_comparer);
+               return;
+          }
+     }
+}
+
+void render_sort(RenderBuffer_t* buffer){
+     // clears and views are barriers, nothing is sorted across them
+     S32 range_start = 0;
+     for(S32 i = 0; i < buffer->count; i++){
+          auto type = buffer->commands[i].type;
+          if(type == RENDER_COMMAND_CLEAR || type == RENDER_COMMAND_VIEW){
+               render_sort_range(buffer->commands + range_start, i - range_start);
+               range_start = i + 1;
+          }
+     }
+     render_sort_range(buffer->commands + range_start, buffer->count - range_start);
+}
+
+static bool render_reserve_vertices(RenderBuffer_t* buffer, S32 vertex_count){
+     if(vertex_count <= buffer->vertices_allocated) return true;
+
+     S32 new_allocated = buffer->vertices_allocated ? buffer->vertices_allocated : 4096;
+     while(new_allocated < vertex_count) new_allocated *= 2;
+
+     auto* new_vertices = (RenderVertex_t*)(realloc(buffer->vertices, new_allocated * sizeof(RenderVertex_t)));
+     if(!new_vertices){
+          LOG("%s() failed to realloc %d render vertices\n", __FUNCTION__, new_allocated);
+          return false;
+     }
+     buffer->vertices = new_vertices;
+     buffer->vertices_allocated = new_allocated;
+     return true;
+}
+
+static void render_quad_vertices(const RenderCommand_t* command, RenderVertex_t* vertices){
+     vertices[0] = RenderVertex_t{command->quad.left, command->quad.bottom, command->tex.left, command->tex.bottom, command->color};
+     vertices[1] = RenderVertex_t{command->quad.left, command->quad.top, command->tex.left, command->tex.top, command->color};
+     vertices[2] = RenderVertex_t{command->quad.right, command->quad.top, command->tex.right, command->tex.top, command->color};
+     vertices[3] = RenderVertex_t{command->quad.right, command->quad.bottom, command->tex.right, command->tex.bottom, command->color};
+}
+
+static GLuint render_command_texture_id(const RenderCommand_t* command){
+     return command->texture ? command->texture->id : 0;
+}
+
+void render_flush_opengl(RenderBuffer_t* buffer){
+     render_sort(buffer);
+
+     if(!render_reserve_vertices(buffer, buffer->count * 4)){
+          buffer->count = 0;
+          return;
+     }
+
+     glEnableClientState(GL_VERTEX_ARRAY);
+     glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+     glEnableClientState(GL_COLOR_ARRAY);
+     glVertexPointer(2, GL_FLOAT, sizeof(RenderVertex_t), &buffer->vertices->x);
+     glTexCoordPointer(2, GL_FLOAT, sizeof(RenderVertex_t), &buffer->vertices->u);
+     glColorPointer(4, GL_FLOAT, sizeof(RenderVertex_t), &buffer->vertices->color);
+
+     bool texture_bound = false;
+     GLuint bound_texture = 0;
+
+     S32 i = 0;
+     while(i < buffer->count){
+          const RenderCommand_t* command = buffer->commands + i;
+
+          switch(command->type){
+          default:
+               i++;
+               break;
+          case RENDER_COMMAND_CLEAR:
+               glClearColor(command->color.red, command->color.green, command->color.blue, command->color.alpha);
+               glClear(GL_COLOR_BUFFER_BIT);
+               i++;
+               break;
+          case RENDER_COMMAND_VIEW:
+               glMatrixMode(GL_PROJECTION);
+               glLoadIdentity();
+               glOrtho(command->quad.left, command->quad.right, command->quad.bottom, command->quad.top, 0.0, 1.0);
+               i++;
+               break;
+          case RENDER_COMMAND_QUAD:
+          case RENDER_COMMAND_QUAD_OUTLINE:
+          {
+               GLuint texture = render_command_texture_id(command);
+               if(!texture_bound || texture != bound_texture){
+                    glBindTexture(GL_TEXTURE_2D, texture);
+                    bound_texture = texture;
+                    texture_bound = true;
+                    buffer->stats.texture_binds++;
+               }
+
+               // gather the run of the same kind of quad with the same texture into one draw
+               S32 run_start = i;
+               while(i < buffer->count && buffer->commands[i].type == command->type &&
+                     render_command_texture_id(buffer->commands + i) == texture){
+                    render_quad_vertices(buffer->commands + i, buffer->vertices + (i * 4));
+                    i++;
+               }
+
+               if(command->type == RENDER_COMMAND_QUAD_OUTLINE) glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+               glDrawArrays(GL_QUADS, run_start * 4, (i - run_start) * 4);
+               if(command->type == RENDER_COMMAND_QUAD_OUTLINE) glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+               buffer->stats.draw_calls++;
+               buffer->stats.quads += i - run_start;
+          } break;
+          }
+     }
+
+     glDisableClientState(GL_VERTEX_ARRAY);
+     glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+     glDisableClientState(GL_COLOR_ARRAY);
+
+     buffer->count = 0;
+}
+
+static GLuint upload_texture(AlphaBitmap_t* bitmap){
+     GLuint texture = 0;
+
+     glGenTextures(1, &texture);
+
+     glBindTexture(GL_TEXTURE_2D, texture);
+
+     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bitmap->width, bitmap->height, 0,  GL_RGBA, GL_UNSIGNED_BYTE, bitmap->pixels);
+
+     return texture;
+}
+
+Texture_t texture_from_bitmap(Bitmap_t* bitmap, bool upload_to_gpu){
+     Texture_t texture {};
+     texture.bitmap = bitmap_to_alpha_bitmap(bitmap, BitmapPixel_t{255, 0, 255});
+     if(upload_to_gpu && texture.bitmap.pixels) texture.id = upload_texture(&texture.bitmap);
+     return texture;
+}
+
+Texture_t texture_from_file(const char* filepath, bool upload_to_gpu){
+     Texture_t texture {};
+     Bitmap_t bitmap = bitmap_load_from_file(filepath);
+     if(bitmap.raw.byte_count == 0) return texture;
+     texture = texture_from_bitmap(&bitmap, upload_to_gpu);
+     free(bitmap.raw.bytes);
+     return texture;
+}
+
+Texture_t texture_from_raw_bitmap(Raw_t* raw, bool upload_to_gpu){
+     Texture_t texture {};
+     Bitmap_t bitmap = bitmap_load_raw(raw->bytes, raw->byte_count);
+     if(bitmap.raw.byte_count == 0) return texture;
+     texture = texture_from_bitmap(&bitmap, upload_to_gpu);
+     free(bitmap.raw.bytes);
+     return texture;
+}
+
+void texture_upload(Texture_t* texture){
+     if(!texture->id && texture->bitmap.pixels) texture->id = upload_texture(&texture->bitmap);
+}
+
+void destroy(Texture_t* texture){
+     if(texture->id) glDeleteTextures(1, &texture->id);
+     free(texture->bitmap.pixels);
+     *texture = Texture_t{};
+}
+
+bool texture_atlas_pack(Texture_t* atlas, Texture_t** textures, S16 texture_count, bool upload_to_gpu){
+     // a transparent row between each texture so nearest sampling right on an edge can't pick up a neighbor, and a
+     // white row at the bottom for flat quads
+     S32 width = 1;
+     S32 height = 1;
+     for(S16 i = 0; i < texture_count; i++){
+          const AlphaBitmap_t* bitmap = &textures[i]->bitmap;
+          if(bitmap->width > width) width = bitmap->width;
+          height += 1 + bitmap->height;
+     }
+
+     *atlas = Texture_t{};
+     atlas->bitmap.pixels = (AlphaBitmapPixel_t*)(calloc(width * height, sizeof(*atlas->bitmap.pixels)));
+     if(!atlas->bitmap.pixels){
+          LOG("%s() failed to calloc %dx%d atlas\n", __FUNCTION__, width, height);
+          return false;
+     }
+     atlas->bitmap.width = width;
+     atlas->bitmap.height = height;
+
+     for(S32 x = 0; x < width; x++) atlas->bitmap.pixels[x] = AlphaBitmapPixel_t{255, 255, 255, 255};
+     atlas->has_white_texel = true;
+     atlas->white_texel = Vec_t{0.5f / (F32)(width), 0.5f / (F32)(height)};
+
+     S32 row = 1;
+     for(S16 i = 0; i < texture_count; i++){
+          Texture_t* texture = textures[i];
+          const AlphaBitmap_t* bitmap = &texture->bitmap;
+          row++;
+
+          for(S32 y = 0; y < bitmap->height; y++){
+               memcpy(atlas->bitmap.pixels + ((row + y) * width), bitmap->pixels + (y * bitmap->width),
+                      bitmap->width * sizeof(*bitmap->pixels));
+          }
+
+          texture->atlas = atlas;
+          texture->atlas_region = Quad_t{0.0f, (F32)(row) / (F32)(height),
+                                         (F32)(bitmap->width) / (F32)(width), (F32)(row + bitmap->height) / (F32)(height)};
+          row += bitmap->height;
+     }
+
+     if(upload_to_gpu) atlas->id = upload_texture(&atlas->bitmap);
+     return true;
+}
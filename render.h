@@ -0,0 +1,118 @@
+#pragma once
+
+#include "types.h"
+#include "vec.h"
+#include "quad.h"
+#include "bitmap.h"
+
+#include <SDL2/SDL_opengl.h>
+
+struct Texture_t{
+     GLuint id = 0; // 0 when running without an opengl context
+     AlphaBitmap_t bitmap; // cpu side copy so the software rasterizer can sample it
+
+     // once packed into an atlas, binding this texture binds the atlas and texture coordinates land in this region
+     const Texture_t* atlas = nullptr;
+     Quad_t atlas_region {0.0f, 0.0f, 1.0f, 1.0f};
+
+     // an opaque white texel in an atlas, flat quads sample it so they don't have to unbind the atlas
+     bool has_white_texel = false;
+     Vec_t white_texel {};
+};
+
+struct RenderColor_t{
+     F32 red;
+     F32 green;
+     F32 blue;
+     F32 alpha;
+};
+
+enum RenderCommandType_t : U8{
+     RENDER_COMMAND_CLEAR,
+     RENDER_COMMAND_VIEW,
+     RENDER_COMMAND_QUAD,
+     RENDER_COMMAND_QUAD_OUTLINE,
+};
+
+struct RenderCommand_t{
+     RenderCommandType_t type;
+     U64 sort_key; // layer key in the upper half, the order it was recorded in the lower
+     const Texture_t* texture; // nullptr draws a flat colored quad
+     RenderColor_t color;
+     Quad_t quad; // the view for RENDER_COMMAND_VIEW
+     Quad_t tex; // left/bottom map to the quad's left/bottom
+};
+
+struct RenderStats_t{
+     S32 draw_calls = 0;
+     S32 texture_binds = 0;
+     S32 quads = 0;
+};
+
+struct RenderVertex_t{
+     F32 x;
+     F32 y;
+     F32 u;
+     F32 v;
+     RenderColor_t color;
+};
+
+// draw calls are recorded here and then handed to a backend, either opengl or the software rasterizer
+struct RenderBuffer_t{
+     RenderCommand_t* commands = nullptr;
+     S32 count = 0;
+     S32 allocated = 0;
+
+     // recording state, mirrors what we used to set on the gl context
+     const Texture_t* texture = nullptr;
+     Quad_t texture_region {0.0f, 0.0f, 1.0f, 1.0f};
+     RenderColor_t color {1.0f, 1.0f, 1.0f, 1.0f};
+     U32 layer_key = 0;
+
+     // scratch space the opengl backend batches quads into
+     RenderVertex_t* vertices = nullptr;
+     S32 vertices_allocated = 0;
+
+     // accumulated by every flush until the caller resets it
+     RenderStats_t stats;
+};
+
+void destroy(RenderBuffer_t* buffer);
+
+// all render_*() recording calls go into the buffer passed to render_begin()
+void render_begin(RenderBuffer_t* buffer);
+RenderBuffer_t* render_current_buffer();
+
+void render_clear(F32 red, F32 green, F32 blue, F32 alpha);
+void render_view(Quad_t view);
+
+// commands between two clears or views are drawn in layer order then row order, highest row first, the same
+// layer and row keep the order they were recorded in. render_view() goes back to layer 0
+void render_layer(U16 layer, S16 row);
+void render_bind_texture(const Texture_t* texture);
+void render_color(F32 red, F32 green, F32 blue, F32 alpha = 1.0f);
+void render_quad(Vec_t pos, Vec_t dim, Vec_t tex, Vec_t tex_dim);
+void render_flat_quad(const Quad_t* quad);
+void render_quad_outline(const Quad_t* quad);
+
+// appends previously recorded commands as if they were recorded now, in the current layer
+void render_append(const RenderCommand_t* commands, S32 count);
+
+// stable sort of the commands by their layer key, the backends call this before replaying the buffer
+void render_sort(RenderBuffer_t* buffer);
+
+// replays the recorded commands on the current gl context and empties the buffer, quads that share a texture are
+// submitted together from a vertex array
+void render_flush_opengl(RenderBuffer_t* buffer);
+
+Texture_t texture_from_bitmap(Bitmap_t* bitmap, bool upload_to_gpu);
+Texture_t texture_from_file(const char* filepath, bool upload_to_gpu);
+Texture_t texture_from_raw_bitmap(Raw_t* raw, bool upload_to_gpu);
+
+// uploads a texture made without upload_to_gpu, which lets the bitmap be decoded on any thread
+void texture_upload(Texture_t* texture);
+void destroy(Texture_t* texture);
+
+// packs the textures into one atlas texture, one above the other, and points them at their region of it. the
+// textures keep their bitmaps but only the atlas is uploaded
+bool texture_atlas_pack(Texture_t* atlas, Texture_t** textures, S16 texture_count, bool upload_to_gpu);
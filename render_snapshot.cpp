@@ -0,0 +1,160 @@
+#include "render_snapshot.h"
+#include "world.h"
+#include "portal_exit.h"
+#include "log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// resizes the array to count without caring what ends up in it, it is about to be overwritten
+template <typename T>
+static bool render_snapshot_fit(ObjectArray_t<T>* array, S16 count){
+     if(array->count == count) return true;
+     if(count == 0){
+          destroy(array);
+          return true;
+     }
+     return resize(array, count);
+}
+
+template <typename T>
+static bool render_snapshot_copy(ObjectArray_t<T>* dst, const ObjectArray_t<T>* src){
+     if(!render_snapshot_fit(dst, src->count)) return false;
+     if(src->count) memcpy(dst->elements, src->elements, (size_t)(src->count) * sizeof(T));
+     return true;
+}
+
+bool render_snapshot_capture(RenderSnapshot_t* snapshot, World_t* world){
+     S32 tile_count = (S32)(world->tilemap.width) * (S32)(world->tilemap.height);
+     if(tile_count > snapshot->tiles_allocated){
+          auto* tiles = (Tile_t*)(realloc(snapshot->tiles, (size_t)(tile_count) * sizeof(Tile_t)));
+          if(!tiles){
+               LOG("%s() failed to realloc %d tiles\n", __FUNCTION__, tile_count);
+               return false;
+          }
+
+          snapshot->tiles = tiles;
+          snapshot->tiles_allocated = tile_count;
+     }
+
+     snapshot->tilemap_width = world->tilemap.width;
+     snapshot->tilemap_height = world->tilemap.height;
+
+     size_t row_size = (size_t)(world->tilemap.width) * sizeof(Tile_t);
+     for(S16 y = 0; y < world->tilemap.height; y++){
+          memcpy(snapshot->tiles + (S32)(y) * world->tilemap.width, world->tilemap.tiles[y], row_size);
+     }
+
+     if(!render_snapshot_copy(&snapshot->players, &world->players)) return false;
+     if(!render_snapshot_copy(&snapshot->blocks, &world->blocks)) return false;
+     if(!render_snapshot_copy(&snapshot->interactives, &world->interactives)) return false;
+     snapshot->arrows = world->arrows;
+
+     const PortalExitCache_t* portal_exit_cache = world->tilemap.portal_exit_cache;
+     snapshot->portal_exit_hits = portal_exit_cache ? portal_exit_cache->hits : 0;
+     snapshot->portal_exit_misses = portal_exit_cache ? portal_exit_cache->misses : 0;
+     snapshot->block_mass_hits = world->block_mass_cache.hits;
+     snapshot->block_mass_misses = world->block_mass_cache.misses;
+     snapshot->blocks_asleep = world->block_sleep.asleep_count;
+     return true;
+}
+
+bool render_snapshot_apply(const RenderSnapshot_t* snapshot, World_t* world){
+     if(!snapshot->tiles) return false;
+
+     if(world->tilemap.width != snapshot->tilemap_width || world->tilemap.height != snapshot->tilemap_height){
+          destroy(&world->tilemap);
+          if(!init(&world->tilemap, snapshot->tilemap_width, snapshot->tilemap_height)){
+               LOG("%s() failed to init %dx%d tilemap\n", __FUNCTION__, snapshot->tilemap_width, snapshot->tilemap_height);
+               return false;
+          }
+     }
+
+     bool portals_changed = false;
+
+     for(S16 y = 0; y < world->tilemap.height; y++){
+          const Tile_t* snapshot_row = snapshot->tiles + (S32)(y) * snapshot->tilemap_width;
+          Tile_t* row = world->tilemap.tiles[y];
+          if(memcmp(row, snapshot_row, (size_t)(world->tilemap.width) * sizeof(Tile_t)) == 0) continue;
+
+          for(S16 x = 0; x < world->tilemap.width; x++){
+               if(memcmp(row + x, snapshot_row + x, sizeof(Tile_t)) == 0) continue;
+               row[x] = snapshot_row[x];
+               tilemap_mark_flats_dirty(&world->tilemap, Coord_t{x, y});
+          }
+          portals_changed = true;
+     }
+
+     // unless interactives were added, removed or moved, compare them one by one so only what changed gets redrawn
+     bool interactives_moved = world->interactives.count != snapshot->interactives.count;
+     for(S16 i = 0; i < world->interactives.count && !interactives_moved; i++){
+          if(world->interactives.elements[i].coord != snapshot->interactives.elements[i].coord) interactives_moved = true;
+     }
+
+     if(interactives_moved){
+          if(!render_snapshot_copy(&world->interactives, &snapshot->interactives)) return false;
+          quad_tree_free(world->interactive_qt);
+          world->interactive_qt = quad_tree_build(&world->interactives);
+          tilemap_mark_all_flats_dirty(&world->tilemap);
+          portals_changed = true;
+     }else{
+          for(S16 i = 0; i < world->interactives.count; i++){
+               Interactive_t* interactive = world->interactives.elements + i;
+               const Interactive_t* snapshot_interactive = snapshot->interactives.elements + i;
+               if(memcmp(interactive, snapshot_interactive, sizeof(*interactive)) == 0) continue;
+               memcpy(interactive, snapshot_interactive, sizeof(*interactive)); // padding too, or it never compares equal
+               tilemap_mark_flats_dirty(&world->tilemap, interactive->coord);
+               portals_changed = true;
+          }
+     }
+
+     if(!render_snapshot_copy(&world->players, &snapshot->players)) return false;
+     if(!render_snapshot_copy(&world->blocks, &snapshot->blocks)) return false;
+     world->arrows = snapshot->arrows;
+
+     quad_tree_free(world->block_qt);
+     world->block_qt = quad_tree_build(&world->blocks);
+
+     if(portals_changed) tilemap_invalidate_portal_exits(&world->tilemap);
+     return true;
+}
+
+void destroy(RenderSnapshot_t* snapshot){
+     free(snapshot->tiles);
+     destroy(&snapshot->players);
+     destroy(&snapshot->blocks);
+     destroy(&snapshot->interactives);
+     *snapshot = RenderSnapshot_t{};
+}
+
+RenderSnapshot_t* render_triple_buffer_back(RenderTripleBuffer_t* buffer){
+     return buffer->snapshots + buffer->back;
+}
+
+void render_triple_buffer_publish(RenderTripleBuffer_t* buffer){
+     U8 previous = buffer->middle.exchange((U8)(buffer->back | RENDER_TRIPLE_BUFFER_FRESH), std::memory_order_acq_rel);
+     buffer->back = (U8)(previous & ~RENDER_TRIPLE_BUFFER_FRESH);
+}
+
+RenderSnapshot_t* render_triple_buffer_acquire(RenderTripleBuffer_t* buffer){
+     if(buffer->middle.load(std::memory_order_acquire) & RENDER_TRIPLE_BUFFER_FRESH){
+          U8 previous = buffer->middle.exchange(buffer->front, std::memory_order_acq_rel);
+          buffer->front = (U8)(previous & ~RENDER_TRIPLE_BUFFER_FRESH);
+          buffer->published = true;
+     }
+
+     if(!buffer->published) return nullptr;
+     return buffer->snapshots + buffer->front;
+}
+
+void render_triple_buffer_reset(RenderTripleBuffer_t* buffer){
+     buffer->middle.store(1, std::memory_order_relaxed);
+     buffer->back = 0;
+     buffer->front = 2;
+     buffer->published = false;
+}
+
+void destroy(RenderTripleBuffer_t* buffer){
+     for(S8 i = 0; i < 3; i++) destroy(buffer->snapshots + i);
+     render_triple_buffer_reset(buffer);
+}
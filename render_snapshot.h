@@ -0,0 +1,72 @@
+#pragma once
+
+#include "types.h"
+#include "tile.h"
+#include "block.h"
+#include "player.h"
+#include "interactive.h"
+#include "arrow.h"
+#include "camera.h"
+#include "frame_pacer.h"
+#include "object_array.h"
+
+#include <atomic>
+
+struct World_t;
+
+// everything drawing a frame of the world reads, copied out at the end of a sim step so another thread can draw it
+// while the next step runs. tiles are packed row after row
+struct RenderSnapshot_t{
+     S16 tilemap_width = 0;
+     S16 tilemap_height = 0;
+     Tile_t* tiles = nullptr;
+     S32 tiles_allocated = 0;
+
+     ObjectArray_t<Player_t> players {};
+     ObjectArray_t<Block_t> blocks {};
+     ObjectArray_t<Interactive_t> interactives {};
+     ArrowArray_t arrows {};
+
+     // filled in by whoever steps the world, they aren't part of it
+     Camera_t camera {};
+
+     // for the render stats, the caches they come from stay with the world
+     U64 portal_exit_hits = 0;
+     U64 portal_exit_misses = 0;
+     U64 block_mass_hits = 0;
+     U64 block_mass_misses = 0;
+     S16 blocks_asleep = 0;
+     FramePacerStats_t sim_pacing {};
+};
+
+bool render_snapshot_capture(RenderSnapshot_t* snapshot, World_t* world);
+
+// brings a world that is only ever drawn up to date with the snapshot. only the flats of tiles and interactives that
+// changed since the last apply are marked dirty, so the flats cache keeps working across snapshots
+bool render_snapshot_apply(const RenderSnapshot_t* snapshot, World_t* world);
+
+void destroy(RenderSnapshot_t* snapshot);
+
+#define RENDER_TRIPLE_BUFFER_FRESH 0x4
+
+// one thread fills back and publishes it, another acquires the latest published snapshot as front. neither ever
+// waits on the other: publishing swaps back with the snapshot in the middle, acquiring swaps the middle with front,
+// but only if something was published since the last acquire. a snapshot published before the last one was acquired
+// is simply skipped
+struct RenderTripleBuffer_t{
+     RenderSnapshot_t snapshots[3];
+     std::atomic<U8> middle {1}; // index, or'd with RENDER_TRIPLE_BUFFER_FRESH until it is acquired
+     U8 back = 0;                // only touched by the publishing thread
+     U8 front = 2;               // only touched by the acquiring thread
+     bool published = false;     // set once by the acquiring thread, when front first holds something
+};
+
+RenderSnapshot_t* render_triple_buffer_back(RenderTripleBuffer_t* buffer);
+void render_triple_buffer_publish(RenderTripleBuffer_t* buffer);
+
+// nullptr until the first publish
+RenderSnapshot_t* render_triple_buffer_acquire(RenderTripleBuffer_t* buffer);
+
+// neither side may be using the buffer
+void render_triple_buffer_reset(RenderTripleBuffer_t* buffer);
+void destroy(RenderTripleBuffer_t* buffer);
@@ -0,0 +1,810 @@
+#include "server.h"
+#include "world.h"
+#include "world_step.h"
+#include "world_snapshot.h"
+#include "world_hash.h"
+#include "block_utils.h"
+#include "map_format.h"
+#include "tags.h"
+#include "defines.h"
+#include "log.h"
+
+#include <condition_variable>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <mutex>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#define SERVER_LINE_MAX 4096
+#define SERVER_ARG_MAX 16
+#define SERVER_SNAPSHOT_MAX 256
+#define SERVER_SESSION_MAX 256
+#define SERVER_ENTRY_START_SIZE 256
+
+// a map as it loaded, shared by every session that loads it
+struct ServerMap_t{
+     char* filepath = nullptr;
+     Coord_t player_start;
+     WorldSnapshot_t start {};
+     ServerMap_t* next = nullptr;
+};
+
+// what step was last told to hold, so the next step knows what to start and stop
+struct ServerInput_t{
+     bool move[DIRECTION_COUNT];
+     bool activate;
+     bool shoot;
+};
+
+struct ServerSnapshot_t{
+     bool used = false;
+     ServerMap_t* map = nullptr;
+     WorldSnapshot_t world {};
+     PlayerAction_t action {};
+     ServerInput_t input {};
+     bool resetting = false;
+     F32 reset_timer = 0;
+     S64 frame_count = 0;
+     DemoEntry_t* entries = nullptr;
+     S64 entry_count = 0;
+};
+
+struct ServerSession_t{
+     int in_fd = -1;
+     int out_fd = -1;
+     bool closing = false;
+     ServerSession_t* next = nullptr; // in whichever queue it is waiting in
+
+     char in[SERVER_LINE_MAX];
+     S32 in_size = 0;
+     char* out = nullptr;
+     S32 out_size = 0;
+     S32 out_allocated = 0;
+
+     ServerMap_t* map = nullptr;
+     World_t world {};
+     Undo_t undo {};
+     FrameContext_t context {};
+     PlayerAction_t action {};
+     ServerInput_t input {};
+     bool tags[TAG_COUNT]; // the global tags are per thread and a session moves between threads
+     S64 frame_count = 0;
+
+     // the input since the map loaded, for write
+     DemoEntry_t* entries = nullptr;
+     S64 entry_count = 0;
+     S64 entry_allocated = 0;
+
+     ServerSnapshot_t snapshots[SERVER_SNAPSHOT_MAX];
+};
+
+struct ServerShared_t{
+     std::mutex map_mutex;
+     ServerMap_t* maps = nullptr;
+
+     // sessions with a line to run wait in ready for a worker, then wait in returned for the dispatcher to poll them
+     // again. a session is only ever touched by whoever took it off one of these
+     std::mutex mutex;
+     std::condition_variable ready_condition;
+     ServerSession_t* ready = nullptr;
+     ServerSession_t* ready_tail = nullptr;
+     ServerSession_t* returned = nullptr;
+     bool stopping = false;
+     int wake_fds[2] = {-1, -1};
+};
+
+static ServerMap_t* server_map_get(ServerShared_t* shared, const char* filepath){
+     std::lock_guard<std::mutex> lock(shared->map_mutex);
+     for(ServerMap_t* map = shared->maps; map; map = map->next){
+          if(strcmp(map->filepath, filepath) == 0) return map;
+     }
+
+     ServerMap_t* map = new ServerMap_t;
+     World_t world {};
+     Undo_t undo {};
+     Camera_t camera {};
+     bool loaded = load_map(filepath, &map->player_start, &world.tilemap, &world.blocks, &world.interactives);
+     if(loaded){
+          // a map starts with no tags, the calling session's are put back once they've been captured that way
+          bool tags[TAG_COUNT];
+          memcpy(tags, get_global_tags(), sizeof(tags));
+          reset_map(map->player_start, &world, &undo, &camera);
+          clear_global_tags();
+          loaded = world_snapshot_capture(&map->start, &world);
+          memcpy(get_global_tags(), tags, sizeof(tags));
+     }
+     destroy(&world);
+     destroy(&undo);
+
+     if(!loaded){
+          destroy(&map->start);
+          delete map;
+          return nullptr;
+     }
+
+     map->filepath = strdup(filepath);
+     map->next = shared->maps;
+     shared->maps = map;
+     return map;
+}
+
+static void server_reply(ServerSession_t* session, const char* format, ...){
+     while(true){
+          S32 available = session->out_allocated - session->out_size;
+          va_list args;
+          va_start(args, format);
+          int length = vsnprintf(session->out ? session->out + session->out_size : nullptr, (size_t)(available), format, args);
+          va_end(args);
+          if(length < 0) return;
+          if(length < available){
+               session->out_size += length;
+               return;
+          }
+
+          S32 allocated = session->out_allocated ? session->out_allocated * 2 : 256;
+          while(allocated - session->out_size <= length) allocated *= 2;
+          char* out = (char*)(realloc(session->out, (size_t)(allocated)));
+          if(!out) return;
+          session->out = out;
+          session->out_allocated = allocated;
+     }
+}
+
+static void server_flush(ServerSession_t* session){
+     S32 written = 0;
+     while(written < session->out_size){
+          ssize_t result = write(session->out_fd, session->out + written, (size_t)(session->out_size - written));
+          if(result < 0){
+               if(errno == EINTR) continue;
+               session->closing = true;
+               break;
+          }
+          written += (S32)(result);
+     }
+     session->out_size = 0;
+}
+
+static void server_record(ServerSession_t* session, PlayerActionType_t type){
+     if(session->entry_count >= session->entry_allocated){
+          S64 allocated = session->entry_allocated ? session->entry_allocated * 2 : SERVER_ENTRY_START_SIZE;
+          DemoEntry_t* entries = (DemoEntry_t*)(realloc(session->entries, (size_t)(allocated) * sizeof(*entries)));
+          if(!entries) return;
+          session->entries = entries;
+          session->entry_allocated = allocated;
+     }
+     session->entries[session->entry_count++] = DemoEntry_t{session->frame_count, type};
+}
+
+static void server_perform(ServerSession_t* session, PlayerActionType_t type){
+     player_action_perform(&session->action, &session->world.players, type, DEMO_MODE_NONE, nullptr, session->frame_count);
+     server_record(session, type);
+}
+
+static void server_reset_undo(ServerSession_t* session){
+     World_t* world = &session->world;
+     destroy(&session->undo);
+     init(&session->undo, UNDO_MEMORY, world->tilemap.width, world->tilemap.height, world->blocks.count,
+          world->interactives.count);
+     undo_snapshot(&session->undo, &world->players, &world->tilemap, &world->blocks, &world->interactives);
+}
+
+// back to the map as it loaded, like reloading it does
+static void server_reload(ServerSession_t* session){
+     world_snapshot_restore(&session->map->start, &session->world);
+     server_reset_undo(session);
+     session->action = PlayerAction_t{};
+     memset(&session->input, 0, sizeof(session->input));
+}
+
+static void server_restart(ServerSession_t* session){
+     server_reload(session);
+     session->context.resetting = false;
+     session->context.reset_timer = FrameContext_t{}.reset_timer;
+     session->frame_count = 0;
+     session->entry_count = 0;
+}
+
+// the input for the frame goes between the two halves
+static void server_frame_begin(ServerSession_t* session){
+     world_frame_begin(&session->world, &session->action);
+     session->frame_count++;
+}
+
+static void server_frame_end(ServerSession_t* session){
+     world_step(&session->world, &session->action, &session->context);
+     if(world_frame_end(&session->action, &session->context)) server_reload(session);
+}
+
+static bool server_parse_s64(const char* text, S64* value){
+     char* end = nullptr;
+     long long parsed = strtoll(text, &end, 10);
+     if(end == text || *end) return false;
+     *value = (S64)(parsed);
+     return true;
+}
+
+static void server_command_load(ServerShared_t* shared, ServerSession_t* session, const char* filepath){
+     ServerMap_t* map = server_map_get(shared, filepath);
+     if(!map){
+          server_reply(session, "error failed to load map %s\n", filepath);
+          return;
+     }
+
+     session->map = map;
+     server_restart(session);
+     server_reply(session, "ok %d %d %d %d\n", session->world.tilemap.width, session->world.tilemap.height,
+                  session->world.blocks.count, session->world.interactives.count);
+}
+
+static void server_command_step(ServerSession_t* session, char** args, S32 arg_count){
+     S64 frames = 0;
+     if(arg_count < 2 || !server_parse_s64(args[1], &frames) || frames < 0){
+          server_reply(session, "error step needs a frame count\n");
+          return;
+     }
+
+     ServerInput_t input {};
+     bool undo = false;
+     for(S32 a = 2; a < arg_count; a++){
+          if(strcmp(args[a], "left") == 0){
+               input.move[DIRECTION_LEFT] = true;
+          }else if(strcmp(args[a], "up") == 0){
+               input.move[DIRECTION_UP] = true;
+          }else if(strcmp(args[a], "right") == 0){
+               input.move[DIRECTION_RIGHT] = true;
+          }else if(strcmp(args[a], "down") == 0){
+               input.move[DIRECTION_DOWN] = true;
+          }else if(strcmp(args[a], "activate") == 0){
+               input.activate = true;
+          }else if(strcmp(args[a], "shoot") == 0){
+               input.shoot = true;
+          }else if(strcmp(args[a], "undo") == 0){
+               undo = true;
+          }else{
+               server_reply(session, "error unknown input %s\n", args[a]);
+               return;
+          }
+     }
+
+     for(S64 f = 0; f < frames; f++){
+          server_frame_begin(session);
+
+          if(f == 0){
+               // let go of things before pressing new ones, so turning faces the new direction
+               for(S8 d = 0; d < DIRECTION_COUNT; d++){
+                    if(session->input.move[d] && !input.move[d]){
+                         server_perform(session, (PlayerActionType_t)(PLAYER_ACTION_TYPE_MOVE_LEFT_STOP + d * 2));
+                    }
+               }
+               if(session->input.activate && !input.activate) server_perform(session, PLAYER_ACTION_TYPE_ACTIVATE_STOP);
+               if(session->input.shoot && !input.shoot) server_perform(session, PLAYER_ACTION_TYPE_SHOOT_STOP);
+
+               for(S8 d = 0; d < DIRECTION_COUNT; d++){
+                    if(!session->input.move[d] && input.move[d]){
+                         server_perform(session, (PlayerActionType_t)(PLAYER_ACTION_TYPE_MOVE_LEFT_START + d * 2));
+                    }
+               }
+               if(!session->input.activate && input.activate) server_perform(session, PLAYER_ACTION_TYPE_ACTIVATE_START);
+               if(!session->input.shoot && input.shoot) server_perform(session, PLAYER_ACTION_TYPE_SHOOT_START);
+               if(undo) server_perform(session, PLAYER_ACTION_TYPE_UNDO);
+
+               session->input = input;
+          }
+
+          server_frame_end(session);
+     }
+
+     server_reply(session, "ok %" PRId64 " %016" PRIx64 "\n", session->frame_count, world_hash(&session->world));
+}
+
+static void server_command_play(ServerSession_t* session, const char* filepath){
+     Demo_t demo {};
+     demo.mode = DEMO_MODE_PLAY;
+     demo.filepath = filepath;
+     if(!demo_begin(&demo)){
+          server_reply(session, "error failed to open demo %s\n", filepath);
+          return;
+     }
+
+     server_restart(session);
+     for(S64 i = 0; i < demo.entries.count; i++){
+          if(demo.entries.entries[i].player_action_type == PLAYER_ACTION_TYPE_END_DEMO) break;
+          session->frame_count = demo.entries.entries[i].frame;
+          server_record(session, demo.entries.entries[i].player_action_type);
+     }
+     session->frame_count = 0;
+
+     Demo_t record_demo {};
+     while(true){
+          server_frame_begin(session);
+          if(demo_play_frame(&demo, &session->action, &session->world.players, session->frame_count, &record_demo)) break;
+          server_frame_end(session);
+     }
+     session->frame_count--;
+
+     for(S8 d = 0; d < DIRECTION_COUNT; d++) session->input.move[d] = session->action.move[d];
+     session->input.activate = session->action.activate;
+     session->input.shoot = session->action.shoot;
+
+     bool passed = test_map_end_state(&session->world, &demo);
+     fclose(demo.file);
+     free(demo.entries.entries);
+
+     server_reply(session, "ok %" PRId64 " %s\n", session->frame_count, passed ? "passed" : "failed");
+}
+
+static void server_command_write(ServerSession_t* session, const char* filepath){
+     World_t* world = &session->world;
+     if(!demo_write(filepath, session->entries, session->entry_count, session->frame_count, session->map->player_start,
+                    &world->tilemap, &world->blocks, &world->interactives, &world->players)){
+          server_reply(session, "error failed to write demo %s\n", filepath);
+          return;
+     }
+
+     server_reply(session, "ok %" PRId64 " %" PRId64 "\n", session->entry_count, session->frame_count);
+}
+
+static void server_command_snapshot(ServerSession_t* session){
+     ServerSnapshot_t* snapshot = nullptr;
+     S32 id = 0;
+     for(; id < SERVER_SNAPSHOT_MAX; id++){
+          if(!session->snapshots[id].used){
+               snapshot = session->snapshots + id;
+               break;
+          }
+     }
+     if(!snapshot){
+          server_reply(session, "error all %d snapshots are in use\n", SERVER_SNAPSHOT_MAX);
+          return;
+     }
+
+     DemoEntry_t* entries = (DemoEntry_t*)(realloc(snapshot->entries, (size_t)(session->entry_count + 1) * sizeof(*entries)));
+     if(!entries || !world_snapshot_capture(&snapshot->world, &session->world)){
+          if(entries) snapshot->entries = entries;
+          server_reply(session, "error out of memory\n");
+          return;
+     }
+
+     snapshot->entries = entries;
+     memcpy(snapshot->entries, session->entries, (size_t)(session->entry_count) * sizeof(*entries));
+     snapshot->entry_count = session->entry_count;
+     snapshot->map = session->map;
+     snapshot->action = session->action;
+     snapshot->input = session->input;
+     snapshot->resetting = session->context.resetting;
+     snapshot->reset_timer = session->context.reset_timer;
+     snapshot->frame_count = session->frame_count;
+     snapshot->used = true;
+
+     server_reply(session, "ok %d\n", id);
+}
+
+static ServerSnapshot_t* server_find_snapshot(ServerSession_t* session, char** args, S32 arg_count){
+     S64 id = 0;
+     if(arg_count < 2 || !server_parse_s64(args[1], &id) || id < 0 || id >= SERVER_SNAPSHOT_MAX ||
+        !session->snapshots[id].used){
+          server_reply(session, "error no snapshot %s\n", arg_count < 2 ? "given" : args[1]);
+          return nullptr;
+     }
+     return session->snapshots + id;
+}
+
+static void server_command_restore(ServerSession_t* session, ServerSnapshot_t* snapshot){
+     if(session->entry_allocated < snapshot->entry_count){
+          DemoEntry_t* entries = (DemoEntry_t*)(realloc(session->entries, (size_t)(snapshot->entry_count) * sizeof(*entries)));
+          if(!entries){
+               server_reply(session, "error out of memory\n");
+               return;
+          }
+          session->entries = entries;
+          session->entry_allocated = snapshot->entry_count;
+     }
+
+     session->map = snapshot->map;
+     world_snapshot_restore(&snapshot->world, &session->world);
+     server_reset_undo(session);
+     memcpy(session->entries, snapshot->entries, (size_t)(snapshot->entry_count) * sizeof(*session->entries));
+     session->entry_count = snapshot->entry_count;
+     session->action = snapshot->action;
+     session->input = snapshot->input;
+     session->context.resetting = snapshot->resetting;
+     session->context.reset_timer = snapshot->reset_timer;
+     session->frame_count = snapshot->frame_count;
+
+     server_reply(session, "ok %" PRId64 "\n", session->frame_count);
+}
+
+static void server_command_players(ServerSession_t* session){
+     ObjectArray_t<Player_t>* players = &session->world.players;
+     server_reply(session, "ok %d", players->count);
+     for(S16 i = 0; i < players->count; i++){
+          Player_t* player = players->elements + i;
+          server_reply(session, " %d %d %d %d", player->pos.pixel.x, player->pos.pixel.y, player->pos.z, player->face);
+     }
+     server_reply(session, "\n");
+}
+
+static void server_command_blocks(ServerSession_t* session){
+     ObjectArray_t<Block_t>* blocks = &session->world.blocks;
+     server_reply(session, "ok %d", blocks->count);
+     for(S16 i = 0; i < blocks->count; i++){
+          Block_t* block = blocks->elements + i;
+          server_reply(session, " %d %d %d %d", block->pos.pixel.x, block->pos.pixel.y, block->pos.z, block->element);
+     }
+     server_reply(session, "\n");
+}
+
+static void server_wake(ServerShared_t* shared){
+     if(shared->wake_fds[1] < 0) return;
+     char wake = 0;
+     while(write(shared->wake_fds[1], &wake, 1) < 0 && errno == EINTR);
+}
+
+static void server_command(ServerShared_t* shared, ServerSession_t* session, char* line){
+     char* args[SERVER_ARG_MAX];
+     S32 arg_count = 0;
+     char* save = nullptr;
+     for(char* token = strtok_r(line, " \t\r", &save); token && arg_count < SERVER_ARG_MAX;
+         token = strtok_r(nullptr, " \t\r", &save)){
+          args[arg_count++] = token;
+     }
+     if(arg_count == 0) return;
+
+     const char* command = args[0];
+     if(strcmp(command, "quit") == 0){
+          server_reply(session, "ok\n");
+          session->closing = true;
+     }else if(strcmp(command, "shutdown") == 0){
+          server_reply(session, "ok\n");
+          session->closing = true;
+          {
+               std::lock_guard<std::mutex> lock(shared->mutex);
+               shared->stopping = true;
+          }
+          shared->ready_condition.notify_all();
+          server_wake(shared);
+     }else if(strcmp(command, "load") == 0){
+          if(arg_count < 2){
+               server_reply(session, "error load needs a map filepath\n");
+          }else{
+               server_command_load(shared, session, args[1]);
+          }
+     }else if(strcmp(command, "map") == 0){
+          S64 map_number = 0;
+          char filepath[512];
+          if(arg_count < 2 || !server_parse_s64(args[1], &map_number)){
+               server_reply(session, "error map needs a map number\n");
+          }else if(!map_number_filepath((S32)(map_number), filepath, sizeof(filepath))){
+               server_reply(session, "error no map %" PRId64 " in content\n", map_number);
+          }else{
+               server_command_load(shared, session, filepath);
+          }
+     }else if(!session->map){
+          server_reply(session, "error no map loaded\n");
+     }else if(strcmp(command, "step") == 0){
+          server_command_step(session, args, arg_count);
+     }else if(strcmp(command, "play") == 0){
+          if(arg_count < 2){
+               server_reply(session, "error play needs a demo filepath\n");
+          }else{
+               server_command_play(session, args[1]);
+          }
+     }else if(strcmp(command, "write") == 0){
+          if(arg_count < 2){
+               server_reply(session, "error write needs a demo filepath\n");
+          }else{
+               server_command_write(session, args[1]);
+          }
+     }else if(strcmp(command, "snapshot") == 0){
+          server_command_snapshot(session);
+     }else if(strcmp(command, "restore") == 0){
+          ServerSnapshot_t* snapshot = server_find_snapshot(session, args, arg_count);
+          if(snapshot) server_command_restore(session, snapshot);
+     }else if(strcmp(command, "drop") == 0){
+          ServerSnapshot_t* snapshot = server_find_snapshot(session, args, arg_count);
+          if(snapshot){
+               snapshot->used = false;
+               server_reply(session, "ok\n");
+          }
+     }else if(strcmp(command, "hash") == 0){
+          U64 hash = world_hash(&session->world);
+          server_reply(session, "ok %016" PRIx64 " %016" PRIx64 "\n", hash, world_hash_map_state(&session->world));
+     }else if(strcmp(command, "players") == 0){
+          server_command_players(session);
+     }else if(strcmp(command, "blocks") == 0){
+          server_command_blocks(session);
+     }else{
+          server_reply(session, "error unknown command %s\n", command);
+     }
+}
+
+static ServerSession_t* server_session_create(int in_fd, int out_fd){
+     ServerSession_t* session = new ServerSession_t;
+     session->in_fd = in_fd;
+     session->out_fd = out_fd;
+     session->context.undo = &session->undo;
+     memset(session->tags, 0, sizeof(session->tags));
+     memset(&session->input, 0, sizeof(session->input));
+     return session;
+}
+
+static void server_session_destroy(ServerSession_t* session){
+     for(S32 i = 0; i < SERVER_SNAPSHOT_MAX; i++){
+          destroy(&session->snapshots[i].world);
+          free(session->snapshots[i].entries);
+     }
+     free(session->entries);
+     free(session->out);
+     destroy(&session->world);
+     destroy(&session->undo);
+     if(session->in_fd >= 0) close(session->in_fd);
+     if(session->out_fd >= 0 && session->out_fd != session->in_fd) close(session->out_fd);
+     delete session;
+}
+
+// reads whatever has arrived, false once the other end has closed or sent a line longer than SERVER_LINE_MAX
+static bool server_session_read(ServerSession_t* session){
+     S32 available = SERVER_LINE_MAX - session->in_size;
+     if(available <= 0) return false;
+
+     ssize_t result = read(session->in_fd, session->in + session->in_size, (size_t)(available));
+     if(result < 0 && errno == EINTR) return true;
+     if(result <= 0) return false;
+     session->in_size += (S32)(result);
+     return true;
+}
+
+static bool server_session_has_line(ServerSession_t* session){
+     return memchr(session->in, '\n', (size_t)(session->in_size)) != nullptr;
+}
+
+// runs every whole line the session has sent so far and sends back the replies in one go
+static void server_session_run(ServerShared_t* shared, ServerSession_t* session){
+     memcpy(get_global_tags(), session->tags, sizeof(session->tags));
+
+     while(!session->closing){
+          char* newline = (char*)(memchr(session->in, '\n', (size_t)(session->in_size)));
+          if(!newline) break;
+          *newline = 0;
+          server_command(shared, session, session->in);
+
+          S32 consumed = (S32)(newline - session->in) + 1;
+          memmove(session->in, session->in + consumed, (size_t)(session->in_size - consumed));
+          session->in_size -= consumed;
+     }
+
+     memcpy(session->tags, get_global_tags(), sizeof(session->tags));
+     server_flush(session);
+}
+
+static void server_work(ServerShared_t* shared){
+     while(true){
+          ServerSession_t* session = nullptr;
+          {
+               std::unique_lock<std::mutex> lock(shared->mutex);
+               while(!shared->ready && !shared->stopping) shared->ready_condition.wait(lock);
+               if(!shared->ready) break;
+
+               session = shared->ready;
+               shared->ready = session->next;
+               if(!shared->ready) shared->ready_tail = nullptr;
+          }
+
+          server_session_run(shared, session);
+
+          {
+               std::lock_guard<std::mutex> lock(shared->mutex);
+               session->next = shared->returned;
+               shared->returned = session;
+          }
+          server_wake(shared);
+     }
+
+     // the portal cache is per thread and this thread is about to end
+     block_portal_cache_free();
+}
+
+static void server_push_ready(ServerShared_t* shared, ServerSession_t* session){
+     {
+          std::lock_guard<std::mutex> lock(shared->mutex);
+          session->next = nullptr;
+          if(shared->ready_tail){
+               shared->ready_tail->next = session;
+          }else{
+               shared->ready = session;
+          }
+          shared->ready_tail = session;
+     }
+     shared->ready_condition.notify_one();
+}
+
+static bool server_serve_stdin(ServerShared_t* shared){
+     // LOG() prints to stdout too, so the replies get the real stdout to themselves and everything else goes to stderr
+     fflush(stdout);
+     int out_fd = dup(STDOUT_FILENO);
+     if(out_fd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0){
+          LOG("failed to set aside stdout for replies: %s\n", strerror(errno));
+          return false;
+     }
+
+     ServerSession_t* session = server_session_create(STDIN_FILENO, out_fd);
+     while(!session->closing && !shared->stopping){
+          if(!server_session_read(session)){
+               // a last command without a newline before the end of input still runs
+               if(session->in_size > 0 && session->in_size < SERVER_LINE_MAX){
+                    session->in[session->in_size++] = '\n';
+                    server_session_run(shared, session);
+               }
+               break;
+          }
+          server_session_run(shared, session);
+     }
+
+     session->in_fd = -1;
+     server_session_destroy(session);
+     return true;
+}
+
+static bool server_serve_socket(ServerShared_t* shared, const ServerOptions_t* options){
+     sockaddr_un address;
+     memset(&address, 0, sizeof(address));
+     address.sun_family = AF_UNIX;
+     if(strlen(options->socket_path) >= sizeof(address.sun_path)){
+          LOG("socket path is too long: %s\n", options->socket_path);
+          return false;
+     }
+     strcpy(address.sun_path, options->socket_path);
+
+     int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+     if(listen_fd < 0){
+          LOG("failed to create socket: %s\n", strerror(errno));
+          return false;
+     }
+     unlink(options->socket_path);
+     if(bind(listen_fd, (sockaddr*)(&address), sizeof(address)) < 0 || listen(listen_fd, SOMAXCONN) < 0 ||
+        pipe(shared->wake_fds) < 0){
+          LOG("failed to listen on %s: %s\n", options->socket_path, strerror(errno));
+          close(listen_fd);
+          return false;
+     }
+
+     // a worker never waits on the dispatcher, a full pipe already has a wake up waiting in it
+     fcntl(shared->wake_fds[1], F_SETFL, fcntl(shared->wake_fds[1], F_GETFL) | O_NONBLOCK);
+
+     S32 thread_count = options->thread_count;
+     if(thread_count <= 0) thread_count = (S32)(std::thread::hardware_concurrency());
+     if(thread_count <= 0) thread_count = 1;
+     std::thread* threads = new std::thread[thread_count];
+     for(S32 t = 0; t < thread_count; t++) threads[t] = std::thread(server_work, shared);
+
+     LOG("serving on %s with %d threads\n", options->socket_path, thread_count);
+     fflush(Log_t::log);
+     fflush(stdout);
+
+     // sessions waiting for their next line, the rest are with the workers
+     ServerSession_t* idle[SERVER_SESSION_MAX];
+     S32 idle_count = 0;
+     S32 session_count = 0;
+     pollfd fds[SERVER_SESSION_MAX + 2];
+
+     while(true){
+          fds[0] = pollfd{listen_fd, POLLIN, 0};
+          fds[1] = pollfd{shared->wake_fds[0], POLLIN, 0};
+          for(S32 i = 0; i < idle_count; i++) fds[i + 2] = pollfd{idle[i]->in_fd, POLLIN, 0};
+
+          if(poll(fds, (nfds_t)(idle_count + 2), -1) < 0){
+               if(errno == EINTR) continue;
+               LOG("failed to poll sessions: %s\n", strerror(errno));
+               break;
+          }
+
+          S32 kept = 0;
+          for(S32 i = 0; i < idle_count; i++){
+               ServerSession_t* session = idle[i];
+               if(fds[i + 2].revents){
+                    if(!server_session_read(session)){
+                         server_session_destroy(session);
+                         session_count--;
+                         continue;
+                    }
+                    if(server_session_has_line(session)){
+                         server_push_ready(shared, session);
+                         continue;
+                    }
+               }
+               idle[kept++] = session;
+          }
+          idle_count = kept;
+
+          if(fds[1].revents){
+               char drain[64];
+               while(read(shared->wake_fds[0], drain, sizeof(drain)) < 0 && errno == EINTR);
+
+               ServerSession_t* returned = nullptr;
+               bool stopping = false;
+               {
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    returned = shared->returned;
+                    shared->returned = nullptr;
+                    stopping = shared->stopping;
+               }
+
+               while(returned){
+                    ServerSession_t* session = returned;
+                    returned = returned->next;
+                    if(session->closing){
+                         server_session_destroy(session);
+                         session_count--;
+                    }else{
+                         idle[idle_count++] = session;
+                    }
+               }
+
+               if(stopping) break;
+          }
+
+          if(fds[0].revents){
+               int fd = accept(listen_fd, nullptr, nullptr);
+               if(fd >= 0){
+                    if(session_count >= SERVER_SESSION_MAX){
+                         LOG("turned away a session, all %d are in use\n", SERVER_SESSION_MAX);
+                         close(fd);
+                    }else{
+                         idle[idle_count++] = server_session_create(fd, fd);
+                         session_count++;
+                    }
+               }
+          }
+     }
+
+     {
+          std::lock_guard<std::mutex> lock(shared->mutex);
+          shared->stopping = true;
+     }
+     shared->ready_condition.notify_all();
+     for(S32 t = 0; t < thread_count; t++) threads[t].join();
+     delete[] threads;
+
+     // the workers run out the ready queue before they stop, so everything is back by now
+     for(ServerSession_t* session = shared->returned; session;){
+          ServerSession_t* next = session->next;
+          server_session_destroy(session);
+          session = next;
+     }
+     shared->returned = nullptr;
+     for(S32 i = 0; i < idle_count; i++) server_session_destroy(idle[i]);
+
+     close(listen_fd);
+     unlink(options->socket_path);
+     close(shared->wake_fds[0]);
+     close(shared->wake_fds[1]);
+     return true;
+}
+
+bool server_run(const ServerOptions_t* options){
+     // a session hanging up mid reply shouldn't take the server with it
+     signal(SIGPIPE, SIG_IGN);
+
+     ServerShared_t* shared = new ServerShared_t;
+     bool served = options->socket_path ? server_serve_socket(shared, options) : server_serve_stdin(shared);
+
+     for(ServerMap_t* map = shared->maps; map;){
+          ServerMap_t* next = map->next;
+          free(map->filepath);
+          destroy(&map->start);
+          delete map;
+          map = next;
+     }
+     delete shared;
+
+     return served;
+}
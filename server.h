@@ -0,0 +1,34 @@
+#pragma once
+
+#include "types.h"
+
+// keeps the simulation resident so scripts can drive it without paying for process startup and a map load on every
+// call. sessions talk a line protocol, one command per line and one reply line per command, which starts with "ok" or
+// "error <what went wrong>":
+//
+//   load <map filepath>          start over on a map: ok <width> <height> <block count> <interactive count>
+//   map <number>                 the same with content/<number>*.bm
+//   step <frames> [inputs]       hold inputs (left, up, right, down, activate, shoot) for that many frames, anything
+//                                not listed is let go, undo undoes on the first of them: ok <frame> <world hash>
+//   play <demo filepath>         start over on the map and play the demo through, checking its end state:
+//                                ok <frame> passed|failed
+//   write <demo filepath>        write the input since the map was loaded, ending now: ok <entry count> <frame>
+//   snapshot                     ok <id>
+//   restore <id>                 ok <frame>, undo history from before the restore is gone
+//   drop <id>                    ok
+//   hash                         ok <world hash> <map state hash>
+//   players                      ok <count> then <pixel x> <pixel y> <z> <face> for each
+//   blocks                       ok <count> then <pixel x> <pixel y> <z> <element> for each
+//   quit                         ok, then the session ends
+//   shutdown                     ok, then the server stops
+//
+// over a unix socket every connection is its own session, and sessions with a command waiting are handed to a fixed
+// set of worker threads, so one slow session doesn't hold up the others. without a socket there is one session on
+// stdin and stdout. maps are loaded once and shared by every session that loads them
+
+struct ServerOptions_t{
+     const char* socket_path = nullptr; // nullptr serves stdin and stdout
+     S32 thread_count = 0;               // 0 uses one per hardware thread
+};
+
+bool server_run(const ServerOptions_t* options);
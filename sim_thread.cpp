@@ -0,0 +1,107 @@
+#include "sim_thread.h"
+#include "world.h"
+#include "world_step.h"
+#include "block_utils.h"
+#include "camera.h"
+#include "defines.h"
+#include "log.h"
+
+#include <stdlib.h>
+
+static void sim_thread_publish(SimThread_t* sim){
+     SimThreadState_t* state = &sim->state;
+
+     RenderSnapshot_t* snapshot = render_triple_buffer_back(&sim->render_buffer);
+     if(!render_snapshot_capture(snapshot, state->world)) return;
+
+     snapshot->camera = *state->camera;
+     snapshot->sim_pacing = frame_pacer_stats(&sim->pacer);
+
+     render_triple_buffer_publish(&sim->render_buffer);
+}
+
+static void sim_thread_step(SimThread_t* sim){
+     SimThreadState_t* state = &sim->state;
+     World_t* world = state->world;
+     PlayerAction_t* player_action = state->player_action;
+     FrameContext_t* frame_context = state->frame_context;
+
+     std::lock_guard<std::mutex> lock(sim->world_mutex);
+
+     world_frame_begin(world, player_action);
+     (*state->frame_count)++;
+
+     U32 input_write = sim->input_write.load(std::memory_order_acquire);
+     U32 input_read = sim->input_read.load(std::memory_order_relaxed);
+     for(; input_read != input_write; input_read++){
+          if(frame_context->resetting) continue;
+          player_action_perform(player_action, &world->players, sim->inputs[input_read % SIM_INPUT_QUEUE_SIZE],
+                                state->record_demo->mode, state->record_demo->file, *state->frame_count);
+     }
+     sim->input_read.store(input_read, std::memory_order_release);
+
+     frame_context->dt = FRAME_TIME;
+     world_step(world, player_action, frame_context);
+     if(world_frame_end(player_action, frame_context)){
+          auto load_result = load_map_number_map(*state->map_number, world, state->undo, state->player_start,
+                                                 player_action, state->camera, state->map_tags);
+          if(load_result.success){
+               free(*state->map_number_filepath);
+               *state->map_number_filepath = load_result.filepath;
+          }
+     }
+
+     sim_thread_publish(sim);
+}
+
+static void sim_thread_run(SimThread_t* sim){
+     while(sim->running.load(std::memory_order_acquire)){
+          frame_pacer_wait(&sim->pacer);
+          sim_thread_step(sim);
+          frame_pacer_presented(&sim->pacer);
+     }
+
+     // the portal cache is per thread
+     block_portal_cache_free();
+}
+
+bool sim_thread_start(SimThread_t* sim, const SimThreadState_t* state){
+     if(sim->running.load()) return true;
+
+     sim->state = *state;
+     sim->input_read.store(0);
+     sim->input_write.store(0);
+     render_triple_buffer_reset(&sim->render_buffer);
+     frame_pacer_reset(&sim->pacer, FRAME_TIME);
+
+     sim_thread_publish(sim);
+
+     sim->running.store(true);
+     sim->thread = std::thread(sim_thread_run, sim);
+     return true;
+}
+
+void sim_thread_stop(SimThread_t* sim){
+     if(!sim->running.load()) return;
+
+     sim->running.store(false, std::memory_order_release);
+     sim->thread.join();
+}
+
+bool sim_thread_push_input(SimThread_t* sim, PlayerActionType_t player_action_type){
+     U32 input_write = sim->input_write.load(std::memory_order_relaxed);
+     U32 input_read = sim->input_read.load(std::memory_order_acquire);
+     if(input_write - input_read >= SIM_INPUT_QUEUE_SIZE){
+          LOG("%s() dropped input %d, the queue is full\n", __FUNCTION__, player_action_type);
+          return false;
+     }
+
+     sim->inputs[input_write % SIM_INPUT_QUEUE_SIZE] = player_action_type;
+     sim->input_write.store(input_write + 1, std::memory_order_release);
+     return true;
+}
+
+void destroy(SimThread_t* sim){
+     sim_thread_stop(sim);
+     destroy(&sim->render_buffer);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "types.h"
+#include "demo.h"
+#include "render_snapshot.h"
+#include "frame_pacer.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+struct World_t;
+struct Undo_t;
+struct FrameContext_t;
+struct Camera_t;
+
+#define SIM_INPUT_QUEUE_SIZE 64
+
+// whatever the sim thread steps, owned by the caller. none of it may be touched without holding world_mutex while
+// the thread runs
+struct SimThreadState_t{
+     World_t* world = nullptr;
+     PlayerAction_t* player_action = nullptr;
+     FrameContext_t* frame_context = nullptr;
+     Undo_t* undo = nullptr;
+     Coord_t* player_start = nullptr;
+     Camera_t* camera = nullptr;
+     S16* map_number = nullptr;
+     char** map_number_filepath = nullptr;
+     bool* map_tags = nullptr;
+     Demo_t* record_demo = nullptr;
+     S64* frame_count = nullptr;
+};
+
+// steps the world at a fixed FRAME_TIME on its own thread, paced by a FramePacer_t, so a slow frame to draw never holds
+// up the simulation and a slow step never holds up drawing. every step ends by publishing a render snapshot, player
+// input comes in through a single producer, single consumer queue and is performed at the start of the next step, the
+// way the game performs it between steps. anything else that changes the state takes world_mutex, the thread holds it
+// for a whole step
+struct SimThread_t{
+     SimThreadState_t state;
+     std::thread thread;
+     std::mutex world_mutex;
+     std::atomic<bool> running {false};
+
+     PlayerActionType_t inputs[SIM_INPUT_QUEUE_SIZE];
+     std::atomic<U32> input_read {0};
+     std::atomic<U32> input_write {0};
+
+     RenderTripleBuffer_t render_buffer;
+     FramePacer_t pacer; // only touched by the sim thread once it runs
+};
+
+// publishes a snapshot of the world as it is before the thread starts, so there is always one to draw
+bool sim_thread_start(SimThread_t* sim, const SimThreadState_t* state);
+
+// waits for the step in progress, input still queued is dropped
+void sim_thread_stop(SimThread_t* sim);
+
+// only one thread may push, false when the queue is full
+bool sim_thread_push_input(SimThread_t* sim, PlayerActionType_t player_action_type);
+
+void destroy(SimThread_t* sim);
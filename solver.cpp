@@ -0,0 +1,992 @@
+#include "solver.h"
+#include "world.h"
+#include "world_step.h"
+#include "world_snapshot.h"
+#include "world_hash.h"
+#include "block_utils.h"
+#include "map_format.h"
+#include "conversion.h"
+#include "utils.h"
+#include "defines.h"
+#include "log.h"
+#include "job_system.h"
+
+#include <atomic>
+#include <inttypes.h>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#define SOLVER_TILE_FRAME_LIMIT 60      // frames a walk gets per tile before the player counts as stuck
+#define SOLVER_STOP_FRAME_LIMIT 60      // frames the player gets to come to a stop after letting go of a direction
+#define SOLVER_PUSH_FRAME_LIMIT 180     // frames a block gets to leave its tile once the player starts pushing it
+#define SOLVER_SETTLE_FRAMES 12         // frames nothing can move or change for before the world counts as settled
+#define SOLVER_SETTLE_FRAME_LIMIT 900
+#define SOLVER_BOW_DRAW_FRAMES ((S32)(PLAYER_BOW_DRAW_DELAY / FRAME_TIME) + 2)
+#define SOLVER_PENDING_MAX 4
+#define SOLVER_KEYFRAME_DEPTHS 4        // moves between nodes that keep a snapshot of the state they end in
+
+enum SolverArrowAt_t : U8{
+     SOLVER_ARROW_MISSES,
+     SOLVER_ARROW_HITS,
+     SOLVER_ARROW_TRADES_ELEMENT,
+};
+
+enum SolverMoveType_t : U8{
+     SOLVER_MOVE_WALK, // only the final walk onto the goal is a move of its own
+     SOLVER_MOVE_PUSH,
+     SOLVER_MOVE_SHOOT,
+     SOLVER_MOVE_ACTIVATE,
+};
+
+struct SolverMove_t{
+     SolverMoveType_t type = SOLVER_MOVE_WALK;
+     Direction_t direction = DIRECTION_COUNT;
+     Coord_t from;   // where the player walks to before pushing, shooting or activating
+     Coord_t target; // what gets pushed, shot or activated
+};
+
+struct SolverNode_t{
+     S32 parent = -1;
+     S32 depth = 0;
+     SolverMove_t move;
+     S64 frame_count = 0;             // from the start of the map to the end of this node's move
+     DemoEntry_t* entries = nullptr;  // the move's inputs, their frames count from the end of the parent's move
+     S32 entry_count = 0;
+     WorldSnapshot_t snapshot;        // the state the move ends in, only on the root and every SOLVER_KEYFRAME_DEPTHS
+                                      // moves, other nodes are rebuilt by replaying their moves from the nearest one
+};
+
+// node indices for one worker to expand. the owner pops off the back and the other workers steal off the front once
+// they run out, a mutex is plenty since popping is nothing next to playing out a move
+struct SolverQueue_t{
+     std::mutex mutex;
+     S32* items = nullptr;
+     S32 head = 0;
+     S32 tail = 0;
+     S32 allocated = 0;
+};
+
+// states seen so far, shared by every worker. open addressing over keys that are already hashes, a slot is claimed
+// with a compare and swap so nothing needs a lock. 0 marks an empty slot. it never holds more than limit keys, which
+// keeps it under half full, and the search stops once it would
+struct SolverVisited_t{
+     std::atomic<U64>* slots = nullptr;
+     U64 mask = 0;
+     S64 limit = 0;
+     std::atomic<S64> count;
+     std::atomic<bool> full;
+};
+
+struct SolverWorker_t{
+     S32 id = 0;
+     World_t world {};
+     Undo_t undo {};
+     FrameContext_t context {};
+     PlayerAction_t action {};
+     S64 frame_count = 0; // since the last restore
+
+     // inputs for the next step, and every input since the last restore
+     PlayerActionType_t pending[SOLVER_PENDING_MAX];
+     S32 pending_count = 0;
+     DemoEntry_t* entries = nullptr;
+     S32 entry_count = 0;
+     S32 entry_allocated = 0;
+
+     // per tile scratch: the tile the flood reached each tile from (-1 if it didn't), the tiles in the order the
+     // flood reached them, the block standing on each tile at the player's height, whether a shot arrow would hit or
+     // trade elements with a block there and the directions each tile has been shot from
+     S32 tile_count = 0;
+     S32* came_from = nullptr;
+     S32* reached = nullptr;
+     S32 reached_count = 0;
+     S16* block_at = nullptr;
+     U8* arrow_at = nullptr;
+     U8* shot_from = nullptr;
+     S32* path = nullptr;
+
+     SolverMove_t* moves = nullptr;
+     S32 move_count = 0;
+     S32 move_allocated = 0;
+
+     SolverNode_t* children = nullptr;
+     S32 child_count = 0;
+     S32 child_allocated = 0;
+
+     // the nodes between the one being rebuilt and its keyframe, and the state the rebuild ends in
+     S32* chain = nullptr;
+     S32 chain_count = 0;
+     S32 chain_allocated = 0;
+     WorldSnapshot_t snapshot;
+
+     // set on the worker that reached the goal, goal.parent indexes this worker's children until they are merged
+     bool found_goal = false;
+     SolverNode_t goal;
+
+     SolverQueue_t queue;
+};
+
+struct SolverShared_t{
+     SolverNode_t* nodes = nullptr;
+     S32 node_count = 0;
+     S32 node_allocated = 0;
+
+     SolverVisited_t visited;
+     SolverWorker_t* workers = nullptr;
+     S32 worker_count = 0;
+
+     Coord_t goal;
+     std::atomic<bool> solved;
+};
+
+static bool solver_stopping(SolverShared_t* shared){
+     return shared->solved.load(std::memory_order_relaxed) || shared->visited.full.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+static bool solver_reserve(T** array, S32* allocated, S32 count){
+     if(count <= *allocated) return true;
+     S32 new_allocated = *allocated ? *allocated * 2 : 64;
+     while(new_allocated < count) new_allocated *= 2;
+     T* elements = (T*)(realloc(*array, (size_t)(new_allocated) * sizeof(T)));
+     if(!elements){
+          LOG("%s() failed to realloc %d elements\n", __FUNCTION__, new_allocated);
+          return false;
+     }
+     *array = elements;
+     *allocated = new_allocated;
+     return true;
+}
+
+static S32 solver_tile_index(TileMap_t* tilemap, Coord_t coord){
+     return (S32)(coord.y) * tilemap->width + coord.x;
+}
+
+static Coord_t solver_tile_coord(TileMap_t* tilemap, S32 index){
+     return Coord_t{(S16)(index % tilemap->width), (S16)(index / tilemap->width)};
+}
+
+// true if key hadn't been seen yet. once the set holds its limit nothing new goes in and it is marked full instead,
+// the table has room past the limit for a key in flight on every worker so a probe always finds an empty slot
+static bool solver_visit(SolverVisited_t* visited, U64 key){
+     if(key == 0) key = 1;
+     for(U64 probe = 0; ; probe++){
+          std::atomic<U64>* slot = visited->slots + ((key + probe) & visited->mask);
+          U64 current = slot->load(std::memory_order_relaxed);
+          if(current == key) return false;
+          if(current != 0) continue;
+          if(visited->count.load(std::memory_order_relaxed) >= visited->limit){
+               visited->full.store(true, std::memory_order_relaxed);
+               return false;
+          }
+          if(slot->compare_exchange_strong(current, key)){
+               visited->count.fetch_add(1, std::memory_order_relaxed);
+               return true;
+          }
+          if(current == key) return false;
+     }
+}
+
+static void solver_queue_push(SolverQueue_t* queue, S32 item){
+     std::lock_guard<std::mutex> lock(queue->mutex);
+     if(!solver_reserve(&queue->items, &queue->allocated, queue->tail + 1)) return;
+     queue->items[queue->tail++] = item;
+}
+
+static bool solver_queue_pop(SolverQueue_t* queue, S32* item){
+     std::lock_guard<std::mutex> lock(queue->mutex);
+     if(queue->head == queue->tail) return false;
+     *item = queue->items[--queue->tail];
+     return true;
+}
+
+static bool solver_queue_steal(SolverQueue_t* queue, S32* item){
+     std::lock_guard<std::mutex> lock(queue->mutex);
+     if(queue->head == queue->tail) return false;
+     *item = queue->items[queue->head++];
+     return true;
+}
+
+static void solver_restore(SolverWorker_t* worker, WorldSnapshot_t* snapshot){
+     World_t* world = &worker->world;
+     world_snapshot_restore(snapshot, world);
+     world_refresh_quad_trees(world);
+
+     // nothing is ever undone, so what world_step() commits only has to fit until the next restore
+     worker->undo.history.current = worker->undo.history.start;
+     undo_snapshot(&worker->undo, &world->players, &world->tilemap, &world->blocks, &world->interactives);
+
+     worker->action = PlayerAction_t{};
+     worker->context.resetting = false;
+     worker->frame_count = 0;
+     worker->pending_count = 0;
+     worker->entry_count = 0;
+}
+
+static void solver_press(SolverWorker_t* worker, PlayerActionType_t type){
+     if(worker->pending_count < SOLVER_PENDING_MAX) worker->pending[worker->pending_count++] = type;
+}
+
+static PlayerActionType_t solver_move_action(Direction_t direction, bool start){
+     return (PlayerActionType_t)(PLAYER_ACTION_TYPE_MOVE_LEFT_START + direction * 2 + (start ? 0 : 1));
+}
+
+// runs a frame the way the game does, playing and recording whatever was pressed since the last one
+static void solver_step(SolverWorker_t* worker){
+     World_t* world = &worker->world;
+     world_frame_begin(world, &worker->action);
+     worker->frame_count++;
+
+     for(S32 i = 0; i < worker->pending_count; i++){
+          player_action_perform(&worker->action, &world->players, worker->pending[i], DEMO_MODE_NONE, nullptr,
+                                worker->frame_count);
+          if(solver_reserve(&worker->entries, &worker->entry_allocated, worker->entry_count + 1)){
+               worker->entries[worker->entry_count++] = DemoEntry_t{worker->frame_count, worker->pending[i]};
+          }
+     }
+     worker->pending_count = 0;
+
+     world_step(world, &worker->action, &worker->context);
+     world_frame_end(&worker->action, &worker->context);
+}
+
+static bool solver_still(World_t* world){
+     for(S16 i = 0; i < world->players.count; i++){
+          Player_t* player = world->players.elements + i;
+          if(player->vel.x != 0 || player->vel.y != 0 || player->teleport) return false;
+     }
+
+     for(S16 i = 0; i < world->blocks.count; i++){
+          Block_t* block = world->blocks.elements + i;
+          if(block->vel.x != 0 || block->vel.y != 0 || block->teleport) return false;
+     }
+
+     return true;
+}
+
+// arrows aren't part of the world hash and can sit still with a velocity, so settling watches where they are instead
+static U64 solver_arrow_hash(World_t* world){
+     U64 hash = 0;
+     for(S16 i = 0; i < ARROW_ARRAY_MAX; i++){
+          Arrow_t* arrow = world->arrows.arrows + i;
+          if(!arrow->alive) continue;
+          U64 pos = (U64)(U16)(arrow->pos.pixel.x) | ((U64)(U16)(arrow->pos.pixel.y) << 16) |
+                    ((U64)(U8)(arrow->pos.z) << 32) | ((U64)(U8)(arrow->element) << 40);
+          hash ^= world_hash_mix(pos ^ world_hash_mix((U64)(i) + 1));
+     }
+     return hash;
+}
+
+// steps until nothing has moved or changed for a little while, false if the player dies first or it never settles
+static bool solver_settle(SolverWorker_t* worker){
+     U64 last_hash = 0;
+     S32 still_frames = 0;
+     for(S32 f = 0; f < SOLVER_SETTLE_FRAME_LIMIT; f++){
+          U64 hash = world_hash(&worker->world) ^ solver_arrow_hash(&worker->world);
+          if(hash == last_hash && solver_still(&worker->world)){
+               still_frames++;
+               if(still_frames >= SOLVER_SETTLE_FRAMES) return true;
+          }else{
+               still_frames = 0;
+          }
+          last_hash = hash;
+
+          solver_step(worker);
+          if(worker->context.resetting) return false;
+     }
+
+     return false;
+}
+
+// steps until the player stops, after letting go of the direction they were walking in
+static bool solver_stop(SolverWorker_t* worker){
+     for(S32 f = 0; f < SOLVER_STOP_FRAME_LIMIT; f++){
+          solver_step(worker);
+          if(worker->context.resetting) return false;
+
+          Player_t* player = worker->world.players.elements;
+          if(player->vel.x == 0 && player->vel.y == 0) return true;
+     }
+
+     return false;
+}
+
+static bool solver_walkable(SolverWorker_t* worker, Coord_t coord){
+     World_t* world = &worker->world;
+     Tile_t* tile = tilemap_get_tile(&world->tilemap, coord);
+     if(!tile || tile_is_solid(tile)) return false;
+     if(worker->block_at[solver_tile_index(&world->tilemap, coord)] >= 0) return false;
+
+     Interactive_t* interactive = quad_tree_interactive_find_at(world->interactive_qt, coord);
+     if(!interactive) return true;
+
+     // pits and clone killers end the run and portals move the player somewhere the flood doesn't follow
+     if(interactive->type == INTERACTIVE_TYPE_PIT ||
+        interactive->type == INTERACTIVE_TYPE_CLONE_KILLER ||
+        interactive->type == INTERACTIVE_TYPE_PORTAL){
+          return false;
+     }
+
+     return !interactive_is_solid(interactive);
+}
+
+// floods out from the first player's tile over every tile they can walk to. returns the lowest tile index reached,
+// which names the area the player is in no matter where in it they stand, or -1 if they're off the map
+static S32 solver_flood(SolverWorker_t* worker){
+     World_t* world = &worker->world;
+     TileMap_t* tilemap = &world->tilemap;
+     Player_t* player = world->players.elements;
+
+     for(S32 i = 0; i < worker->tile_count; i++){
+          worker->came_from[i] = -1;
+          worker->block_at[i] = -1;
+          worker->arrow_at[i] = 0;
+     }
+
+     S8 arrow_z = player->pos.z + ARROW_SHOOT_HEIGHT;
+     for(S16 i = 0; i < world->blocks.count; i++){
+          Block_t* block = world->blocks.elements + i;
+          Coord_t coord = block_get_coord(block);
+          if(!tilemap_get_tile(tilemap, coord)) continue;
+          S32 index = solver_tile_index(tilemap, coord);
+
+          if(blocks_at_collidable_height(block->pos.z, player->pos.z)) worker->block_at[index] = i;
+
+          S8 block_top = block->pos.z + HEIGHT_INTERVAL;
+          if(arrow_z >= block->pos.z && arrow_z <= block_top){
+               worker->arrow_at[index] = SOLVER_ARROW_HITS;
+          }else if(block->element != ELEMENT_NONE && arrow_z > block_top && arrow_z < block_top + HEIGHT_INTERVAL){
+               worker->arrow_at[index] = SOLVER_ARROW_TRADES_ELEMENT;
+          }
+     }
+
+     worker->reached_count = 0;
+     Coord_t start = pos_to_coord(player->pos);
+     if(!tilemap_get_tile(tilemap, start)) return -1;
+
+     S32 start_index = solver_tile_index(tilemap, start);
+     worker->came_from[start_index] = start_index;
+     worker->reached[worker->reached_count++] = start_index;
+     S32 lowest = start_index;
+
+     for(S32 r = 0; r < worker->reached_count; r++){
+          S32 index = worker->reached[r];
+          Coord_t coord = solver_tile_coord(tilemap, index);
+          for(S8 d = 0; d < DIRECTION_COUNT; d++){
+               Coord_t next = coord + (Direction_t)(d);
+               if(!solver_walkable(worker, next)) continue;
+               S32 next_index = solver_tile_index(tilemap, next);
+               if(worker->came_from[next_index] >= 0) continue;
+               worker->came_from[next_index] = index;
+               worker->reached[worker->reached_count++] = next_index;
+               if(next_index < lowest) lowest = next_index;
+          }
+     }
+
+     return lowest;
+}
+
+static Direction_t solver_direction_between(Coord_t a, Coord_t b){
+     for(S8 d = 0; d < DIRECTION_COUNT; d++){
+          if(a + (Direction_t)(d) == b) return (Direction_t)(d);
+     }
+     return DIRECTION_COUNT;
+}
+
+// true once the player's center is at or past the center of coord, heading in direction
+static bool solver_reached_center(Player_t* player, Coord_t coord, Direction_t direction){
+     Pixel_t center = coord_to_pixel_at_center(coord);
+     Coord_t step = Coord_t{0, 0} + direction;
+     S32 remaining = (S32)(center.x - player->pos.pixel.x) * step.x + (S32)(center.y - player->pos.pixel.y) * step.y;
+     return remaining <= 0;
+}
+
+// walks the first player along the flood's path to target, coming to a stop before every turn so they don't catch
+// on corners. false if they don't get there in time or die on the way
+static bool solver_walk(SolverWorker_t* worker, Coord_t target){
+     TileMap_t* tilemap = &worker->world.tilemap;
+     S32 target_index = solver_tile_index(tilemap, target);
+     if(worker->came_from[target_index] < 0) return false;
+
+     // the flood gives the path backwards
+     S32 length = 0;
+     for(S32 index = target_index; ; index = worker->came_from[index]){
+          worker->path[length++] = index;
+          if(worker->came_from[index] == index) break;
+     }
+     for(S32 i = 0; i < length / 2; i++){
+          S32 tmp = worker->path[i];
+          worker->path[i] = worker->path[length - 1 - i];
+          worker->path[length - 1 - i] = tmp;
+     }
+
+     S64 frame_limit = worker->frame_count + (S64)(length) * SOLVER_TILE_FRAME_LIMIT;
+     Direction_t held = DIRECTION_COUNT;
+     S32 next = 1;
+     while(next < length){
+          if(worker->frame_count > frame_limit) return false;
+
+          Coord_t from = solver_tile_coord(tilemap, worker->path[next - 1]);
+          Coord_t to = solver_tile_coord(tilemap, worker->path[next]);
+          Direction_t direction = solver_direction_between(from, to);
+
+          if(held == direction && solver_reached_center(worker->world.players.elements, to, direction)){
+               next++;
+               continue;
+          }
+
+          if(held != direction){
+               if(held != DIRECTION_COUNT){
+                    solver_press(worker, solver_move_action(held, false));
+                    held = DIRECTION_COUNT;
+                    if(!solver_stop(worker)) return false;
+               }
+               solver_press(worker, solver_move_action(direction, true));
+               held = direction;
+          }
+
+          solver_step(worker);
+          if(worker->context.resetting) return false;
+     }
+
+     if(held != DIRECTION_COUNT){
+          solver_press(worker, solver_move_action(held, false));
+          if(!solver_stop(worker)) return false;
+     }
+
+     return pos_to_coord(worker->world.players.elements->pos) == target;
+}
+
+// pressing and releasing a direction on the same frame turns the player without moving them
+static bool solver_face(SolverWorker_t* worker, Direction_t direction){
+     solver_press(worker, solver_move_action(direction, true));
+     solver_press(worker, solver_move_action(direction, false));
+     solver_step(worker);
+     return !worker->context.resetting;
+}
+
+// holds the direction until the block leaves its tile, then lets go and waits for it to settle
+static bool solver_push(SolverWorker_t* worker, Direction_t direction, Coord_t block_coord){
+     S16 block_index = worker->block_at[solver_tile_index(&worker->world.tilemap, block_coord)];
+     if(block_index < 0) return false;
+
+     solver_press(worker, solver_move_action(direction, true));
+
+     bool moved = false;
+     for(S32 f = 0; f < SOLVER_PUSH_FRAME_LIMIT && !moved; f++){
+          solver_step(worker);
+          if(worker->context.resetting) return false;
+
+          // removing a block reorders them, which only happens when the pushed one is gone
+          moved = block_index >= worker->world.blocks.count ||
+                  block_get_coord(worker->world.blocks.elements + block_index) != block_coord;
+     }
+
+     solver_press(worker, solver_move_action(direction, false));
+     solver_step(worker);
+     if(worker->context.resetting || !moved) return false;
+
+     return solver_settle(worker);
+}
+
+static bool solver_shoot(SolverWorker_t* worker, Direction_t direction){
+     if(!solver_face(worker, direction)) return false;
+
+     solver_press(worker, PLAYER_ACTION_TYPE_SHOOT_START);
+     for(S32 f = 0; f < SOLVER_BOW_DRAW_FRAMES; f++){
+          solver_step(worker);
+          if(worker->context.resetting) return false;
+     }
+
+     solver_press(worker, PLAYER_ACTION_TYPE_SHOOT_STOP);
+     solver_step(worker);
+     if(worker->context.resetting) return false;
+
+     return solver_settle(worker);
+}
+
+static bool solver_activate(SolverWorker_t* worker, Direction_t direction){
+     if(!solver_face(worker, direction)) return false;
+
+     solver_press(worker, PLAYER_ACTION_TYPE_ACTIVATE_START);
+     solver_step(worker);
+     solver_press(worker, PLAYER_ACTION_TYPE_ACTIVATE_STOP);
+     solver_step(worker);
+     if(worker->context.resetting) return false;
+
+     return solver_settle(worker);
+}
+
+// follows an arrow's line out of coord. arrows fly over blocks on the ground, trading elements with them, and stop
+// at the first block at their height, wall or solid interactive. shots that would cross the same elemental block or
+// hit the same thing in the same direction end the same way, so key gives back the first of those. false if the
+// arrow would change nothing on the way
+static bool solver_shot_key(SolverWorker_t* worker, Coord_t coord, Direction_t direction, Coord_t* key){
+     World_t* world = &worker->world;
+     Coord_t check = coord + direction;
+     while(true){
+          Tile_t* tile = tilemap_get_tile(&world->tilemap, check);
+          if(!tile || tile_is_solid(tile)) return false;
+
+          U8 arrow_at = worker->arrow_at[solver_tile_index(&world->tilemap, check)];
+          Interactive_t* interactive = quad_tree_interactive_find_at(world->interactive_qt, check);
+          if(arrow_at || (interactive && (interactive_is_solid(interactive) || interactive->type == INTERACTIVE_TYPE_PORTAL))){
+               *key = check;
+               return true;
+          }
+
+          check += direction;
+     }
+}
+
+static void solver_add_move(SolverWorker_t* worker, SolverMoveType_t type, Direction_t direction, Coord_t from,
+                            Coord_t target){
+     if(!solver_reserve(&worker->moves, &worker->move_allocated, worker->move_count + 1)) return;
+     SolverMove_t* move = worker->moves + worker->move_count++;
+     move->type = type;
+     move->direction = direction;
+     move->from = from;
+     move->target = target;
+}
+
+// every push, shot and lever pull the player can reach from where the last flood said they could walk. shots that
+// would hit the same thing from the same side are only tried once
+static void solver_find_moves(SolverWorker_t* worker){
+     World_t* world = &worker->world;
+     TileMap_t* tilemap = &world->tilemap;
+     bool has_bow = world->players.elements->has_bow;
+
+     worker->move_count = 0;
+     memset(worker->shot_from, 0, (size_t)(worker->tile_count) * sizeof(*worker->shot_from));
+
+     for(S32 r = 0; r < worker->reached_count; r++){
+          Coord_t coord = solver_tile_coord(tilemap, worker->reached[r]);
+          for(S8 d = 0; d < DIRECTION_COUNT; d++){
+               Direction_t direction = (Direction_t)(d);
+               Coord_t adjacent = coord + direction;
+               if(!tilemap_get_tile(tilemap, adjacent)) continue;
+
+               if(worker->block_at[solver_tile_index(tilemap, adjacent)] >= 0){
+                    solver_add_move(worker, SOLVER_MOVE_PUSH, direction, coord, adjacent);
+               }
+
+               Interactive_t* interactive = quad_tree_interactive_find_at(world->interactive_qt, adjacent);
+               if(interactive && interactive->type == INTERACTIVE_TYPE_LEVER){
+                    solver_add_move(worker, SOLVER_MOVE_ACTIVATE, direction, coord, adjacent);
+               }
+
+               Coord_t target;
+               if(has_bow && solver_shot_key(worker, coord, direction, &target)){
+                    U8* shot_from = worker->shot_from + solver_tile_index(tilemap, target);
+                    if(!(*shot_from & (1 << d))){
+                         *shot_from |= (U8)(1 << d);
+                         solver_add_move(worker, SOLVER_MOVE_SHOOT, direction, coord, target);
+                    }
+               }
+          }
+     }
+}
+
+static bool solver_fill_node(SolverNode_t* node, SolverWorker_t* worker, S32 parent, S32 parent_depth,
+                             S64 parent_frame_count, SolverMove_t move){
+     *node = SolverNode_t{};
+     node->parent = parent;
+     node->depth = parent_depth + 1;
+     node->move = move;
+     node->frame_count = parent_frame_count + worker->frame_count;
+
+     if(worker->entry_count){
+          node->entries = (DemoEntry_t*)(malloc((size_t)(worker->entry_count) * sizeof(*node->entries)));
+          if(!node->entries){
+               LOG("%s() failed to malloc %d demo entries\n", __FUNCTION__, worker->entry_count);
+               return false;
+          }
+          memcpy(node->entries, worker->entries, (size_t)(worker->entry_count) * sizeof(*node->entries));
+          node->entry_count = worker->entry_count;
+     }
+
+     if(node->depth % SOLVER_KEYFRAME_DEPTHS == 0 && !world_snapshot_capture(&node->snapshot, &worker->world)){
+          free(node->entries);
+          *node = SolverNode_t{};
+          return false;
+     }
+
+     return true;
+}
+
+static void solver_destroy_node(SolverNode_t* node){
+     free(node->entries);
+     destroy(&node->snapshot);
+     *node = SolverNode_t{};
+}
+
+// puts the worker in the state a node ends in by restoring the nearest keyframe above it and replaying the inputs of
+// every node in between. each node's inputs play from a restore of the state before them, like they did when the
+// node was found, so they end the same way. returns the state to restore to for every move tried from the node
+static WorldSnapshot_t* solver_rebuild(SolverShared_t* shared, SolverWorker_t* worker, S32 node_index){
+     worker->chain_count = 0;
+     S32 keyframe = node_index;
+     while(!shared->nodes[keyframe].snapshot.buffer){
+          if(!solver_reserve(&worker->chain, &worker->chain_allocated, worker->chain_count + 1)) return nullptr;
+          worker->chain[worker->chain_count++] = keyframe;
+          keyframe = shared->nodes[keyframe].parent;
+     }
+
+     WorldSnapshot_t* snapshot = &shared->nodes[keyframe].snapshot;
+     solver_restore(worker, snapshot);
+
+     for(S32 c = worker->chain_count - 1; c >= 0; c--){
+          SolverNode_t* node = shared->nodes + worker->chain[c];
+          S64 frame_count = node->frame_count - shared->nodes[node->parent].frame_count;
+          S32 e = 0;
+          while(worker->frame_count < frame_count){
+               while(e < node->entry_count && node->entries[e].frame == worker->frame_count + 1){
+                    solver_press(worker, node->entries[e++].player_action_type);
+               }
+               solver_step(worker);
+          }
+
+          if(!world_snapshot_capture(&worker->snapshot, &worker->world)) return nullptr;
+          snapshot = &worker->snapshot;
+          solver_restore(worker, snapshot);
+     }
+
+     return snapshot;
+}
+
+// walks onto the goal from the state the worker is in, which the last flood showed it could reach, and claims the
+// solve if no other worker got there first
+static bool solver_walk_to_goal(SolverShared_t* shared, SolverWorker_t* worker, S32 parent, S32 parent_depth,
+                                S64 parent_frame_count){
+     worker->frame_count = 0;
+     worker->entry_count = 0;
+     if(!solver_walk(worker, shared->goal)) return false;
+
+     bool expected = false;
+     if(!shared->solved.compare_exchange_strong(expected, true)) return false;
+
+     SolverMove_t move;
+     move.from = shared->goal;
+     move.target = shared->goal;
+     if(!solver_fill_node(&worker->goal, worker, parent, parent_depth, parent_frame_count, move)){
+          shared->solved.store(false);
+          return false;
+     }
+
+     worker->found_goal = true;
+     return true;
+}
+
+static void solver_expand(SolverShared_t* shared, SolverWorker_t* worker, S32 node_index){
+     SolverNode_t* node = shared->nodes + node_index;
+     TileMap_t* tilemap = &worker->world.tilemap;
+
+     WorldSnapshot_t* snapshot = solver_rebuild(shared, worker, node_index);
+     if(!snapshot) return;
+     solver_flood(worker);
+     solver_find_moves(worker);
+
+     for(S32 m = 0; m < worker->move_count && !solver_stopping(shared); m++){
+          SolverMove_t move = worker->moves[m];
+          if(m > 0){
+               solver_restore(worker, snapshot);
+               solver_flood(worker);
+          }
+
+          if(!solver_walk(worker, move.from)) continue;
+
+          bool done = false;
+          switch(move.type){
+          default:
+               break;
+          case SOLVER_MOVE_PUSH:
+               done = solver_push(worker, move.direction, move.target);
+               break;
+          case SOLVER_MOVE_SHOOT:
+               done = solver_shoot(worker, move.direction);
+               break;
+          case SOLVER_MOVE_ACTIVATE:
+               done = solver_activate(worker, move.direction);
+               break;
+          }
+          if(!done) continue;
+
+          S32 area = solver_flood(worker);
+          if(area < 0) continue;
+
+          U64 key = world_hash_map_state(&worker->world) ^ world_hash_mix((U64)(area) + 1);
+          if(!solver_visit(&shared->visited, key)) continue;
+
+          if(!solver_reserve(&worker->children, &worker->child_allocated, worker->child_count + 1)) continue;
+          SolverNode_t* child = worker->children + worker->child_count;
+          if(!solver_fill_node(child, worker, node_index, node->depth, node->frame_count, move)) continue;
+          worker->child_count++;
+
+          if(worker->came_from[solver_tile_index(tilemap, shared->goal)] < 0) continue;
+          if(solver_walk_to_goal(shared, worker, worker->child_count - 1, child->depth, child->frame_count)) break;
+     }
+}
+
+// expands nodes for one worker until every queue is empty, index is the worker
+static void solver_work(void* data, S32 index){
+     SolverShared_t* shared = (SolverShared_t*)(data);
+     SolverWorker_t* worker = shared->workers + index;
+     S32 node_index = 0;
+     while(!solver_stopping(shared)){
+          bool found = solver_queue_pop(&worker->queue, &node_index);
+          for(S32 i = 1; !found && i < shared->worker_count; i++){
+               found = solver_queue_steal(&shared->workers[(worker->id + i) % shared->worker_count].queue, &node_index);
+          }
+          if(!found) break;
+
+          solver_expand(shared, worker, node_index);
+     }
+}
+
+static bool solver_init_worker(SolverWorker_t* worker, S32 id, WorldSnapshot_t* root){
+     worker->id = id;
+     worker->context.undo = &worker->undo;
+
+     world_snapshot_restore(root, &worker->world);
+     World_t* world = &worker->world;
+     if(!init(&worker->undo, UNDO_MEMORY, world->tilemap.width, world->tilemap.height, world->blocks.count,
+              world->interactives.count)){
+          return false;
+     }
+
+     worker->tile_count = (S32)(world->tilemap.width) * (S32)(world->tilemap.height);
+     size_t tile_count = (size_t)(worker->tile_count);
+     worker->came_from = (S32*)(malloc(tile_count * sizeof(*worker->came_from)));
+     worker->reached = (S32*)(malloc(tile_count * sizeof(*worker->reached)));
+     worker->block_at = (S16*)(malloc(tile_count * sizeof(*worker->block_at)));
+     worker->arrow_at = (U8*)(malloc(tile_count * sizeof(*worker->arrow_at)));
+     worker->shot_from = (U8*)(malloc(tile_count * sizeof(*worker->shot_from)));
+     worker->path = (S32*)(malloc(tile_count * sizeof(*worker->path)));
+     if(!worker->came_from || !worker->reached || !worker->block_at || !worker->arrow_at || !worker->shot_from || !worker->path){
+          LOG("%s() failed to malloc scratch for %d tiles\n", __FUNCTION__, worker->tile_count);
+          return false;
+     }
+
+     return true;
+}
+
+static void solver_destroy_worker(SolverWorker_t* worker){
+     for(S32 i = 0; i < worker->child_count; i++) solver_destroy_node(worker->children + i);
+     free(worker->children);
+     if(worker->found_goal) solver_destroy_node(&worker->goal);
+     free(worker->moves);
+     free(worker->entries);
+     free(worker->came_from);
+     free(worker->reached);
+     free(worker->block_at);
+     free(worker->arrow_at);
+     free(worker->shot_from);
+     free(worker->path);
+     free(worker->queue.items);
+     free(worker->chain);
+     destroy(&worker->snapshot);
+     destroy(&worker->world);
+     destroy(&worker->undo);
+}
+
+// the goal's state is rebuilt on worker, which has to be idle
+static bool solver_write_demo(const char* filepath, SolverShared_t* shared, S32 goal_index, Coord_t player_start,
+                              SolverWorker_t* worker){
+     // nodes only know their parent and frames relative to it, so walk the chain back twice: once to count and once
+     // to fill the entries in from the end
+     S64 entry_count = 0;
+     for(S32 i = goal_index; i > 0; i = shared->nodes[i].parent) entry_count += shared->nodes[i].entry_count;
+
+     DemoEntry_t* entries = (DemoEntry_t*)(malloc((size_t)(entry_count) * sizeof(*entries) + 1));
+     if(!entries){
+          LOG("%s() failed to malloc %" PRId64 " demo entries\n", __FUNCTION__, entry_count);
+          return false;
+     }
+
+     S64 slot = entry_count;
+     for(S32 i = goal_index; i > 0; i = shared->nodes[i].parent){
+          SolverNode_t* node = shared->nodes + i;
+          S64 start_frame = shared->nodes[node->parent].frame_count;
+          slot -= node->entry_count;
+          for(S32 e = 0; e < node->entry_count; e++){
+               entries[slot + e] = DemoEntry_t{start_frame + node->entries[e].frame, node->entries[e].player_action_type};
+          }
+     }
+
+     if(!solver_rebuild(shared, worker, goal_index)){
+          free(entries);
+          return false;
+     }
+
+     World_t* world = &worker->world;
+     bool written = demo_write(filepath, entries, entry_count, shared->nodes[goal_index].frame_count, player_start,
+                               &world->tilemap, &world->blocks, &world->interactives, &world->players);
+     free(entries);
+     return written;
+}
+
+// moves every worker's children onto the end of the shared nodes, fixing up the goal's parent on the way
+static S32 solver_merge(SolverShared_t* shared){
+     S32 goal_index = -1;
+     for(S32 w = 0; w < shared->worker_count; w++){
+          SolverWorker_t* worker = shared->workers + w;
+          S32 offset = shared->node_count;
+          if(solver_reserve(&shared->nodes, &shared->node_allocated, shared->node_count + worker->child_count)){
+               memcpy(shared->nodes + offset, worker->children, (size_t)(worker->child_count) * sizeof(*worker->children));
+               shared->node_count += worker->child_count;
+          }else{
+               for(S32 i = 0; i < worker->child_count; i++) solver_destroy_node(worker->children + i);
+          }
+
+          if(worker->found_goal){
+               worker->goal.parent += offset;
+               goal_index = w;
+          }
+          worker->child_count = 0;
+     }
+
+     // after every child so the next depth's nodes stay together
+     if(goal_index >= 0){
+          SolverWorker_t* worker = shared->workers + goal_index;
+          if(!solver_reserve(&shared->nodes, &shared->node_allocated, shared->node_count + 1)) return -1;
+          shared->nodes[shared->node_count] = worker->goal;
+          worker->found_goal = false;
+          goal_index = shared->node_count++;
+     }
+
+     return goal_index;
+}
+
+SolverResult_t solver_solve(const SolverOptions_t* options){
+     SolverResult_t result {};
+
+     World_t world {};
+     Undo_t undo {};
+     Camera_t camera {};
+     Coord_t player_start {};
+     if(!load_map(options->map_filepath, &player_start, &world.tilemap, &world.blocks, &world.interactives)){
+          LOG("solver failed to load map: %s\n", options->map_filepath);
+          return result;
+     }
+     reset_map(player_start, &world, &undo, &camera);
+
+     if(!tilemap_get_tile(&world.tilemap, options->goal)){
+          LOG("solver goal %d, %d is off the %dx%d map\n", options->goal.x, options->goal.y, world.tilemap.width,
+              world.tilemap.height);
+          destroy(&world);
+          destroy(&undo);
+          return result;
+     }
+
+     SolverShared_t shared {};
+     shared.goal = options->goal;
+     shared.solved.store(false);
+     shared.worker_count = options->thread_count;
+     if(shared.worker_count <= 0) shared.worker_count = (S32)(std::thread::hardware_concurrency());
+     if(shared.worker_count <= 0) shared.worker_count = 1;
+     // the most the pool and this thread can run at once
+     if(shared.worker_count > JOB_SYSTEM_MAX_THREADS + 1) shared.worker_count = JOB_SYSTEM_MAX_THREADS + 1;
+
+     // at most half full so probes stay short, and never short of room for the keys workers race in past the limit
+     shared.visited.limit = options->max_states;
+     U64 capacity = 1;
+     U64 room = (U64)(options->max_states) + (U64)(shared.worker_count);
+     while(capacity < (U64)(options->max_states) * 2 || capacity <= room) capacity <<= 1;
+     shared.visited.slots = new std::atomic<U64>[capacity];
+     for(U64 i = 0; i < capacity; i++) shared.visited.slots[i].store(0, std::memory_order_relaxed);
+     shared.visited.mask = capacity - 1;
+     shared.visited.count.store(0);
+     shared.visited.full.store(false);
+
+     S32 goal_index = -1;
+     shared.workers = new SolverWorker_t[shared.worker_count];
+
+     // one pool for the whole search, the calling thread runs a worker too
+     JobSystem_t jobs;
+     if(shared.worker_count > 1) init(&jobs, shared.worker_count - 1, block_portal_cache_free);
+
+     // the root, the map as it loads
+     bool ready = solver_reserve(&shared.nodes, &shared.node_allocated, 1);
+     if(ready){
+          shared.nodes[0] = SolverNode_t{};
+          ready = world_snapshot_capture(&shared.nodes[0].snapshot, &world);
+          if(ready) shared.node_count = 1;
+     }
+     for(S32 w = 0; w < shared.worker_count && ready; w++){
+          ready = solver_init_worker(shared.workers + w, w, &shared.nodes[0].snapshot);
+     }
+
+     if(ready){
+          // the start counts as seen, and might already be in walking distance of the goal
+          SolverWorker_t* first = shared.workers;
+          solver_restore(first, &shared.nodes[0].snapshot);
+          S32 area = solver_flood(first);
+          solver_visit(&shared.visited, world_hash_map_state(&first->world) ^ world_hash_mix((U64)(area) + 1));
+          if(area >= 0 && first->came_from[solver_tile_index(&first->world.tilemap, shared.goal)] >= 0 &&
+             solver_walk_to_goal(&shared, first, 0, 0, 0) &&
+             solver_reserve(&shared.nodes, &shared.node_allocated, shared.node_count + 1)){
+               shared.nodes[shared.node_count] = first->goal;
+               first->found_goal = false;
+               goal_index = shared.node_count++;
+          }
+     }
+
+     S32 level_start = 0;
+     S32 level_end = shared.node_count;
+     S32 keyframe_start = 0;
+     S32 keyframe_end = shared.node_count;
+     for(S32 depth = 1; ready && goal_index < 0 && depth <= options->max_depth && level_start < level_end &&
+                        !shared.visited.full.load(); depth++){
+          for(S32 w = 0; w < shared.worker_count; w++){
+               shared.workers[w].queue.head = 0;
+               shared.workers[w].queue.tail = 0;
+          }
+          for(S32 i = level_start; i < level_end; i++){
+               solver_queue_push(&shared.workers[i % shared.worker_count].queue, i);
+          }
+
+          job_system_parallel_for(&jobs, shared.worker_count, 1, solver_work, &shared);
+
+          goal_index = solver_merge(&shared);
+          level_start = level_end;
+          level_end = shared.node_count - (goal_index >= 0 ? 1 : 0);
+
+          LOG("solver depth %d: %d new states, %" PRId64 " seen\n", depth, level_end - level_start,
+              (S64)(shared.visited.count.load()));
+
+          // nothing left to expand replays from before the keyframes just made
+          if(goal_index < 0 && depth % SOLVER_KEYFRAME_DEPTHS == 0){
+               for(S32 i = keyframe_start; i < keyframe_end; i++) destroy(&shared.nodes[i].snapshot);
+               keyframe_start = level_start;
+               keyframe_end = level_end;
+          }
+     }
+
+     if(shared.visited.full.load()){
+          LOG("solver stopped after seeing %" PRId64 " states, raise max_states to search further\n",
+              (S64)(shared.visited.count.load()));
+     }
+
+     result.state_count = shared.visited.count.load();
+     if(goal_index >= 0){
+          result.solved = true;
+          result.frame_count = shared.nodes[goal_index].frame_count;
+          for(S32 i = goal_index; i > 0; i = shared.nodes[i].parent) result.depth++;
+
+          if(!solver_write_demo(options->demo_filepath, &shared, goal_index, player_start, shared.workers)){
+               result.solved = false;
+          }
+     }
+
+     destroy(&jobs);
+     for(S32 i = 0; i < shared.node_count; i++) solver_destroy_node(shared.nodes + i);
+     free(shared.nodes);
+     for(S32 w = 0; w < shared.worker_count; w++) solver_destroy_worker(shared.workers + w);
+     delete[] shared.workers;
+     delete[] shared.visited.slots;
+
+     destroy(&world);
+     destroy(&undo);
+     return result;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "types.h"
+#include "coord.h"
+
+// searches a map breadth first for the fewest moves that get the player onto a goal tile and writes the inputs that
+// do it out as a demo. a move is walking somewhere the player can reach and then pushing a block until it settles,
+// shooting an arrow or activating a lever from there. every move is played out frame by frame with world_step() on a
+// snapshot of the state it starts from, so the demo replays exactly. a state is kept as the inputs of the move that
+// led to it, with a full snapshot only every few moves, and is rebuilt by replaying from the nearest one.
+//
+// two states are the same if the world hash (without the players) matches and the player can walk to the same tiles
+// in both, where exactly they stand doesn't matter since walking is free. each depth of the search is split across a
+// pool of threads kept for the whole search, which take states off the back of their own queue and steal off the
+// front of the others' once it's empty
+
+struct SolverOptions_t{
+     const char* map_filepath = nullptr;
+     const char* demo_filepath = "solution.bd";
+     Coord_t goal = {-1, -1};
+     S32 thread_count = 0;          // 0 uses one per hardware thread
+     S32 max_depth = 32;            // moves, not counting the final walk onto the goal
+     S32 max_states = 1 << 20;      // the search gives up once it has seen this many states
+};
+
+struct SolverResult_t{
+     bool solved = false;
+     S32 depth = 0;                 // moves in the solution, including the final walk onto the goal
+     S64 frame_count = 0;           // frames the demo plays for
+     S64 state_count = 0;           // distinct states visited
+};
+
+SolverResult_t solver_solve(const SolverOptions_t* options);
@@ -132,7 +132,8 @@ const char* tag_to_string(Tag_t tag){
     return "TAG_UNKNOWN";
 }
 
-bool global_tags[TAG_COUNT];
+// per thread, so threads that each step their own world (the solver's) don't share tags
+thread_local bool global_tags[TAG_COUNT];
 
 void add_global_tag(Tag_t tag){
      global_tags[tag] = true;
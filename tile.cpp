@@ -1,5 +1,6 @@
 #include "tile.h"
 #include "defines.h"
+#include "portal_exit.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -16,6 +17,18 @@ bool init(TileMap_t* tilemap, S16 width, S16 height){
      tilemap->width = width;
      tilemap->height = height;
 
+     tilemap->flats_dirty = (bool*)calloc((size_t)(tilemap_chunks_wide(tilemap) * tilemap_chunks_tall(tilemap)),
+                                          sizeof(*tilemap->flats_dirty));
+     if(!tilemap->flats_dirty) return false;
+     tilemap_mark_all_flats_dirty(tilemap);
+
+     S32 tile_count = (S32)(width) * (S32)(height);
+     tilemap->changed = (bool*)calloc((size_t)(tile_count), sizeof(*tilemap->changed));
+     if(!tilemap->changed) return false;
+     tilemap->changed_coords = (Coord_t*)malloc((size_t)(tile_count) * sizeof(*tilemap->changed_coords));
+     if(!tilemap->changed_coords) return false;
+     tilemap->changed_count = 0;
+
      return true;
 }
 
@@ -35,6 +48,13 @@ void destroy(TileMap_t* tilemap){
      }
 
      free(tilemap->tiles);
+     free(tilemap->flats_dirty);
+     free(tilemap->changed);
+     free(tilemap->changed_coords);
+     if(tilemap->portal_exit_cache){
+          destroy(tilemap->portal_exit_cache);
+          free(tilemap->portal_exit_cache);
+     }
      memset(tilemap, 0, sizeof(*tilemap));
 }
 
@@ -53,6 +73,53 @@ Tile_t* tilemap_get_tile(TileMap_t* tilemap, Coord_t coord){
      return tilemap->tiles[coord.y] + coord.x;
 }
 
+S16 tilemap_chunks_wide(const TileMap_t* tilemap){
+     return (S16)((tilemap->width + ROOM_TILE_SIZE - 1) / ROOM_TILE_SIZE);
+}
+
+S16 tilemap_chunks_tall(const TileMap_t* tilemap){
+     return (S16)((tilemap->height + ROOM_TILE_SIZE - 1) / ROOM_TILE_SIZE);
+}
+
+void tilemap_mark_flats_dirty(TileMap_t* tilemap, Coord_t coord){
+     if(!tilemap->flats_dirty) return;
+     if(coord.x < 0 || coord.x >= tilemap->width) return;
+     if(coord.y < 0 || coord.y >= tilemap->height) return;
+
+     S16 chunk_x = coord.x / ROOM_TILE_SIZE;
+     S16 chunk_y = coord.y / ROOM_TILE_SIZE;
+     tilemap->flats_dirty[chunk_y * tilemap_chunks_wide(tilemap) + chunk_x] = true;
+}
+
+void tilemap_mark_all_flats_dirty(TileMap_t* tilemap){
+     if(!tilemap->flats_dirty) return;
+     S32 chunk_count = tilemap_chunks_wide(tilemap) * tilemap_chunks_tall(tilemap);
+     for(S32 i = 0; i < chunk_count; i++) tilemap->flats_dirty[i] = true;
+}
+
+void tilemap_mark_changed(TileMap_t* tilemap, Coord_t coord){
+     if(!tilemap->changed) return;
+     if(coord.x < 0 || coord.x >= tilemap->width) return;
+     if(coord.y < 0 || coord.y >= tilemap->height) return;
+
+     S32 index = (S32)(coord.y) * tilemap->width + coord.x;
+     if(tilemap->changed[index]) return;
+     tilemap->changed[index] = true;
+     tilemap->changed_coords[tilemap->changed_count++] = coord;
+}
+
+void tilemap_clear_changes(TileMap_t* tilemap){
+     for(S32 i = 0; i < tilemap->changed_count; i++){
+          Coord_t coord = tilemap->changed_coords[i];
+          tilemap->changed[(S32)(coord.y) * tilemap->width + coord.x] = false;
+     }
+     tilemap->changed_count = 0;
+}
+
+void tilemap_invalidate_portal_exits(TileMap_t* tilemap){
+     tilemap->portal_exit_generation++;
+}
+
 bool tilemap_is_solid(TileMap_t* tilemap, Coord_t coord){
      Tile_t* tile = tilemap_get_tile(tilemap, coord);
      if(!tile) return false;
@@ -122,6 +189,75 @@ bool tile_flags_cluster_all_on(U16 flags){
      return true;
 }
 
+// toggles the part of a cluster that is fed by electricity coming in the direction given
+void tile_flags_toggle_cluster_input(U16* flags, Direction_t direction){
+     Direction_t cluster_direction = tile_flags_cluster_direction(*flags);
+     switch(cluster_direction){
+     default:
+          break;
+     case DIRECTION_LEFT:
+          switch(direction){
+          default:
+               break;
+          case DIRECTION_LEFT:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_MID) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_MID_ON);
+               break;
+          case DIRECTION_UP:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_LEFT) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_LEFT_ON);
+               break;
+          case DIRECTION_DOWN:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_RIGHT) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_RIGHT_ON);
+               break;
+          }
+          break;
+     case DIRECTION_RIGHT:
+          switch(direction){
+          default:
+               break;
+          case DIRECTION_RIGHT:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_MID) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_MID_ON);
+               break;
+          case DIRECTION_DOWN:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_LEFT) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_LEFT_ON);
+               break;
+          case DIRECTION_UP:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_RIGHT) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_RIGHT_ON);
+               break;
+          }
+          break;
+     case DIRECTION_DOWN:
+          switch(direction){
+          default:
+               break;
+          case DIRECTION_DOWN:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_MID) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_MID_ON);
+               break;
+          case DIRECTION_LEFT:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_LEFT) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_LEFT_ON);
+               break;
+          case DIRECTION_RIGHT:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_RIGHT) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_RIGHT_ON);
+               break;
+          }
+          break;
+     case DIRECTION_UP:
+          switch(direction){
+          default:
+               break;
+          case DIRECTION_UP:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_MID) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_MID_ON);
+               break;
+          case DIRECTION_RIGHT:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_LEFT) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_LEFT_ON);
+               break;
+          case DIRECTION_LEFT:
+               if(*flags & TILE_FLAG_WIRE_CLUSTER_RIGHT) TOGGLE_BIT_FLAG(*flags, TILE_FLAG_WIRE_CLUSTER_RIGHT_ON);
+               break;
+          }
+          break;
+     }
+}
+
 void tile_toggle_wire_activated(Tile_t* tile){
      if(tile->flags & TILE_FLAG_WIRE_CLUSTER_LEFT){
           TOGGLE_BIT_FLAG(tile->flags, TILE_FLAG_WIRE_CLUSTER_LEFT_ON);
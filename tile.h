@@ -38,10 +38,26 @@ struct Tile_t{
      U16 flags;
 };
 
+struct PortalExitCache_t;
+
 struct TileMap_t{
      S16 width;
      S16 height;
      Tile_t** tiles;
+
+     // one flag per ROOM_TILE_SIZE square chunk, set whenever something drawn on the floor changes so the cached
+     // flats layer knows which chunks to rebuild
+     bool* flats_dirty;
+
+     // one flag per tile, set along with the tile's entry in changed_coords when its flags or the state of the
+     // interactive on it change, so the world hash only rehashes tiles that changed
+     bool* changed;
+     Coord_t* changed_coords;
+     S32 changed_count;
+
+     // bumped whenever a wire, wire cross or portal changes so cached portal exits are recalculated
+     U32 portal_exit_generation;
+     PortalExitCache_t* portal_exit_cache;
 };
 
 bool init(TileMap_t* tilemap, S16 width, S16 height);
@@ -50,9 +66,17 @@ void destroy(TileMap_t* tilemap);
 bool tile_is_solid(Tile_t* tile);
 bool tile_is_iced(Tile_t* tile);
 Tile_t* tilemap_get_tile(TileMap_t* tilemap, Coord_t coord);
+S16 tilemap_chunks_wide(const TileMap_t* tilemap);
+S16 tilemap_chunks_tall(const TileMap_t* tilemap);
+void tilemap_mark_flats_dirty(TileMap_t* tilemap, Coord_t coord);
+void tilemap_mark_all_flats_dirty(TileMap_t* tilemap);
+void tilemap_mark_changed(TileMap_t* tilemap, Coord_t coord);
+void tilemap_clear_changes(TileMap_t* tilemap);
+void tilemap_invalidate_portal_exits(TileMap_t* tilemap);
 bool tilemap_is_solid(TileMap_t* tilemap, Coord_t coord);
 bool tilemap_is_iced(TileMap_t* tilemap, Coord_t coord);
 Direction_t tile_flags_cluster_direction(U16 flags);
 void tile_flags_set_cluster_direction(U16* flags, Direction_t dir);
 bool tile_flags_cluster_all_on(U16 flags);
+void tile_flags_toggle_cluster_input(U16* flags, Direction_t direction);
 void tile_toggle_wire_activated(Tile_t* tile);
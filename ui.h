@@ -3,13 +3,7 @@
 #include "defines.h"
 #include "vec.h"
 #include "tags.h"
-
-#ifdef __linux
-    #include <GL/gl.h>
-#elif __APPLE__
-    #define GL_SILENCE_DEPRECATION
-    #include <OpenGL/gl.h>
-#endif
+#include "render.h"
 
 #define CHECKBOX_DIMENSION (8.0 * PIXEL_SIZE)
 #define THUMBNAIL_UI_DIMENSION (0.1375f)
@@ -29,7 +23,7 @@ struct MapThumbnail_t{
     int map_number = 0;
     bool tags[TAG_COUNT];
     Vec_t pos;
-    GLuint texture = 0;
+    Texture_t texture;
 
     Quad_t get_area(Vec_t scroll){
         Vec_t final = pos + scroll;
@@ -367,6 +367,10 @@ void undo_revert(Undo_t* undo, ObjectArray_t<Player_t>* players, TileMap_t* tile
                  ObjectArray_t<Interactive_t>* interactives){
      if(undo->history.current <= undo->history.start) return;
 
+     // tiles and interactives can change anywhere
+     tilemap_mark_all_flats_dirty(tilemap);
+     tilemap_invalidate_portal_exits(tilemap);
+
      auto* ptr = (char*)(undo->history.current);
      S32 diff_count = 0;
      ptr -= sizeof(diff_count);
@@ -0,0 +1,469 @@
+#include "wire_network.h"
+#include "defines.h"
+#include "utils.h"
+
+#include <string.h>
+
+// wires that loop back on themselves would recurse forever in toggle_electricity(), give up on those
+#define WIRE_NETWORK_MAX_DEPTH 1024
+#define WIRE_PROGRAM_COMPILING -2
+
+struct WireStepList_t{
+     WireStep_t* steps = nullptr;
+     S32 count = 0;
+     S32 allocated = 0;
+};
+
+struct WireCompile_t{
+     WireNetwork_t* network;
+     TileMap_t* tilemap;
+     ObjectArray_t<Interactive_t>* interactives;
+     QuadTreeNode_t<Interactive_t>* interactive_qt;
+};
+
+static bool wire_step_list_push(WireStepList_t* list, WireStepType_t type, Coord_t coord, S16 interactive_index,
+                                Direction_t direction = DIRECTION_COUNT, S32 program = -1){
+     if(list->count >= list->allocated){
+          S32 new_allocated = list->allocated ? list->allocated * 2 : 32;
+          auto* new_steps = (WireStep_t*)(realloc(list->steps, new_allocated * sizeof(WireStep_t)));
+          if(!new_steps){
+               LOG("%s() failed to realloc %d wire steps\n", __FUNCTION__, new_allocated);
+               return false;
+          }
+          list->steps = new_steps;
+          list->allocated = new_allocated;
+     }
+
+     WireStep_t* step = list->steps + list->count;
+     list->count++;
+     step->type = type;
+     step->direction = direction;
+     step->coord = coord;
+     step->interactive_index = interactive_index;
+     step->program = program;
+     return true;
+}
+
+static void wire_bounds_add(Coord_t* min, Coord_t* max, Coord_t coord){
+     if(coord.x < min->x) min->x = coord.x;
+     if(coord.y < min->y) min->y = coord.y;
+     if(coord.x > max->x) max->x = coord.x;
+     if(coord.y > max->y) max->y = coord.y;
+}
+
+static S32 wire_network_commit(WireNetwork_t* network, const WireStepList_t* list, Coord_t min, Coord_t max){
+     if(network->step_count + list->count > network->step_allocated){
+          S32 new_allocated = network->step_allocated ? network->step_allocated : 256;
+          while(new_allocated < network->step_count + list->count) new_allocated *= 2;
+          auto* new_steps = (WireStep_t*)(realloc(network->steps, new_allocated * sizeof(WireStep_t)));
+          if(!new_steps){
+               LOG("%s() failed to realloc %d wire steps\n", __FUNCTION__, new_allocated);
+               return -1;
+          }
+          network->steps = new_steps;
+          network->step_allocated = new_allocated;
+     }
+
+     if(network->program_count >= network->program_allocated){
+          S32 new_allocated = network->program_allocated ? network->program_allocated * 2 : 64;
+          auto* new_programs = (WireProgram_t*)(realloc(network->programs, new_allocated * sizeof(WireProgram_t)));
+          if(!new_programs){
+               LOG("%s() failed to realloc %d wire programs\n", __FUNCTION__, new_allocated);
+               return -1;
+          }
+          network->programs = new_programs;
+          network->program_allocated = new_allocated;
+     }
+
+     if(list->count) memcpy(network->steps + network->step_count, list->steps, list->count * sizeof(WireStep_t));
+
+     S32 index = network->program_count;
+     WireProgram_t* program = network->programs + index;
+     program->first_step = network->step_count;
+     program->step_count = list->count;
+     program->min = min;
+     program->max = max;
+     program->valid = true;
+
+     network->program_count++;
+     network->step_count += list->count;
+     network->live_step_count += list->count;
+     return index;
+}
+
+static S32 wire_tile_index(const WireNetwork_t* network, Coord_t coord){
+     return coord.y * network->width + coord.x;
+}
+
+static S32 wire_compile_cluster(WireCompile_t* compile, Coord_t coord, Direction_t direction, S32 depth);
+
+// mirrors toggle_electricity() but records what it would toggle instead of toggling it
+static bool wire_compile(WireCompile_t* compile, WireStepList_t* list, Coord_t* min, Coord_t* max, Coord_t coord,
+                         Direction_t direction, bool from_wire, bool activated_by_door, S32 depth){
+     if(depth > WIRE_NETWORK_MAX_DEPTH) return false;
+
+     Coord_t adjacent_coord = coord + direction;
+     Tile_t* tile = tilemap_get_tile(compile->tilemap, adjacent_coord);
+     if(!tile) return true;
+
+     wire_bounds_add(min, max, adjacent_coord);
+
+     Interactive_t* interactive = quad_tree_interactive_find_at(compile->interactive_qt, adjacent_coord);
+     S16 interactive_index = interactive ? (S16)(interactive - compile->interactives->elements) : (S16)(-1);
+     if(interactive){
+          switch(interactive->type){
+          default:
+               break;
+          case INTERACTIVE_TYPE_POPUP:
+               if(!wire_step_list_push(list, WIRE_STEP_POPUP, adjacent_coord, interactive_index)) return false;
+               break;
+          case INTERACTIVE_TYPE_DOOR:
+               if(!wire_step_list_push(list, WIRE_STEP_DOOR, adjacent_coord, interactive_index)) return false;
+               // open connecting door
+               if(!activated_by_door){
+                    if(!wire_compile(compile, list, min, max, coord_move(coord, interactive->door.face, 3),
+                                     interactive->door.face, from_wire, true, depth + 1)){
+                         return false;
+                    }
+               }
+               break;
+          case INTERACTIVE_TYPE_PORTAL:
+               if(from_wire){
+                    if(!wire_step_list_push(list, WIRE_STEP_PORTAL, adjacent_coord, interactive_index)) return false;
+               }
+               break;
+          }
+     }
+
+     U16 wire_flags = TILE_FLAG_WIRE_LEFT | TILE_FLAG_WIRE_UP | TILE_FLAG_WIRE_RIGHT | TILE_FLAG_WIRE_DOWN;
+
+     if((tile->flags & wire_flags) ||
+        (interactive && interactive->type == INTERACTIVE_TYPE_WIRE_CROSS && interactive->wire_cross.mask & wire_flags)){
+          bool wire_cross = false;
+
+          if(interactive && interactive->type == INTERACTIVE_TYPE_WIRE_CROSS){
+               U16 tile_wire_flag = 0;
+               DirectionMask_t cross_mask = DIRECTION_MASK_NONE;
+
+               switch(direction){
+               default:
+                    return true;
+               case DIRECTION_LEFT:
+                    tile_wire_flag = TILE_FLAG_WIRE_RIGHT;
+                    cross_mask = DIRECTION_MASK_RIGHT;
+                    break;
+               case DIRECTION_RIGHT:
+                    tile_wire_flag = TILE_FLAG_WIRE_LEFT;
+                    cross_mask = DIRECTION_MASK_LEFT;
+                    break;
+               case DIRECTION_UP:
+                    tile_wire_flag = TILE_FLAG_WIRE_DOWN;
+                    cross_mask = DIRECTION_MASK_DOWN;
+                    break;
+               case DIRECTION_DOWN:
+                    tile_wire_flag = TILE_FLAG_WIRE_UP;
+                    cross_mask = DIRECTION_MASK_UP;
+                    break;
+               }
+
+               if(tile->flags & tile_wire_flag){
+                    if(!wire_step_list_push(list, WIRE_STEP_WIRE, adjacent_coord, interactive_index)) return false;
+               }else if(interactive->wire_cross.mask & cross_mask){
+                    if(!wire_step_list_push(list, WIRE_STEP_WIRE_CROSS, adjacent_coord, interactive_index)) return false;
+                    wire_cross = true;
+               }else{
+                    return true;
+               }
+          }else{
+               switch(direction){
+               default:
+                    return true;
+               case DIRECTION_LEFT:
+                    if(!(tile->flags & TILE_FLAG_WIRE_RIGHT)) return true;
+                    break;
+               case DIRECTION_RIGHT:
+                    if(!(tile->flags & TILE_FLAG_WIRE_LEFT)) return true;
+                    break;
+               case DIRECTION_UP:
+                    if(!(tile->flags & TILE_FLAG_WIRE_DOWN)) return true;
+                    break;
+               case DIRECTION_DOWN:
+                    if(!(tile->flags & TILE_FLAG_WIRE_UP)) return true;
+                    break;
+               }
+
+               if(!wire_step_list_push(list, WIRE_STEP_WIRE, adjacent_coord, interactive_index)) return false;
+          }
+
+          bool left;
+          bool right;
+          bool down;
+          bool up;
+
+          if(wire_cross){
+               left = interactive->wire_cross.mask & DIRECTION_MASK_LEFT;
+               right = interactive->wire_cross.mask & DIRECTION_MASK_RIGHT;
+               down = interactive->wire_cross.mask & DIRECTION_MASK_DOWN;
+               up = interactive->wire_cross.mask & DIRECTION_MASK_UP;
+          }else{
+               left = tile->flags & TILE_FLAG_WIRE_LEFT;
+               right = tile->flags & TILE_FLAG_WIRE_RIGHT;
+               down = tile->flags & TILE_FLAG_WIRE_DOWN;
+               up = tile->flags & TILE_FLAG_WIRE_UP;
+          }
+
+          if(left && direction != DIRECTION_RIGHT &&
+             !wire_compile(compile, list, min, max, adjacent_coord, DIRECTION_LEFT, true, false, depth + 1)) return false;
+          if(right && direction != DIRECTION_LEFT &&
+             !wire_compile(compile, list, min, max, adjacent_coord, DIRECTION_RIGHT, true, false, depth + 1)) return false;
+          if(down && direction != DIRECTION_UP &&
+             !wire_compile(compile, list, min, max, adjacent_coord, DIRECTION_DOWN, true, false, depth + 1)) return false;
+          if(up && direction != DIRECTION_DOWN &&
+             !wire_compile(compile, list, min, max, adjacent_coord, DIRECTION_UP, true, false, depth + 1)) return false;
+     }else if(tile->flags & (TILE_FLAG_WIRE_CLUSTER_LEFT | TILE_FLAG_WIRE_CLUSTER_MID | TILE_FLAG_WIRE_CLUSTER_RIGHT)){
+          Direction_t cluster_direction = tile_flags_cluster_direction(tile->flags);
+          S32 program = wire_compile_cluster(compile, adjacent_coord, cluster_direction, depth + 1);
+          if(program < 0) return false;
+
+          WireProgram_t* cluster_program = compile->network->programs + program;
+          wire_bounds_add(min, max, cluster_program->min);
+          wire_bounds_add(min, max, cluster_program->max);
+
+          if(!wire_step_list_push(list, WIRE_STEP_CLUSTER, adjacent_coord, interactive_index, direction, program)) return false;
+     }
+
+     return true;
+}
+
+static S32 wire_compile_cluster(WireCompile_t* compile, Coord_t coord, Direction_t direction, S32 depth){
+     WireNetwork_t* network = compile->network;
+     S32* memo = network->cluster_programs + (wire_tile_index(network, coord) * DIRECTION_COUNT + direction);
+     if(*memo >= 0) return *memo;
+     if(*memo == WIRE_PROGRAM_COMPILING) return -1; // a cluster powering itself
+
+     *memo = WIRE_PROGRAM_COMPILING;
+
+     WireStepList_t list;
+     Coord_t min = coord;
+     Coord_t max = coord;
+     S32 program = -1;
+     if(wire_compile(compile, &list, &min, &max, coord, direction, true, false, depth)){
+          program = wire_network_commit(network, &list, min, max);
+     }
+     free(list.steps);
+
+     *memo = program;
+     return program;
+}
+
+static S32 wire_compile_source(WireCompile_t* compile, Coord_t coord){
+     WireStepList_t list;
+     Coord_t min = coord;
+     Coord_t max = coord;
+     S32 program = -1;
+
+     // the same order activate() toggles the directions in
+     if(wire_compile(compile, &list, &min, &max, coord, DIRECTION_LEFT, false, false, 0) &&
+        wire_compile(compile, &list, &min, &max, coord, DIRECTION_RIGHT, false, false, 0) &&
+        wire_compile(compile, &list, &min, &max, coord, DIRECTION_UP, false, false, 0) &&
+        wire_compile(compile, &list, &min, &max, coord, DIRECTION_DOWN, false, false, 0)){
+          program = wire_network_commit(compile->network, &list, min, max);
+     }
+     free(list.steps);
+
+     compile->network->source_programs[wire_tile_index(compile->network, coord)] = program;
+     return program;
+}
+
+static bool wire_is_source(const Interactive_t* interactive){
+     return interactive->type == INTERACTIVE_TYPE_LEVER ||
+            interactive->type == INTERACTIVE_TYPE_PRESSURE_PLATE ||
+            interactive->type == INTERACTIVE_TYPE_LIGHT_DETECTOR ||
+            interactive->type == INTERACTIVE_TYPE_ICE_DETECTOR ||
+            interactive->type == INTERACTIVE_TYPE_PORTAL;
+}
+
+static bool wire_coord_in_map(const WireNetwork_t* network, Coord_t coord){
+     return coord.x >= 0 && coord.x < network->width && coord.y >= 0 && coord.y < network->height;
+}
+
+// only the parts of the interactives that change where electricity goes
+static U32 wire_interactive_layout_hash(const ObjectArray_t<Interactive_t>* interactives){
+     U32 hash = 2166136261u;
+     for(S16 i = 0; i < interactives->count; i++){
+          const Interactive_t* interactive = interactives->elements + i;
+          U32 values[4] = {(U32)(interactive->type), (U32)((U16)(interactive->coord.x)), (U32)((U16)(interactive->coord.y)), 0};
+          if(interactive->type == INTERACTIVE_TYPE_DOOR) values[3] = (U32)(interactive->door.face);
+          if(interactive->type == INTERACTIVE_TYPE_WIRE_CROSS) values[3] = (U32)(interactive->wire_cross.mask);
+          for(U32 value : values){
+               hash ^= value;
+               hash *= 16777619u;
+          }
+     }
+     return hash;
+}
+
+static bool wire_network_matches(const WireNetwork_t* network, const TileMap_t* tilemap,
+                                 const ObjectArray_t<Interactive_t>* interactives){
+     return network->source_programs && network->tiles == tilemap->tiles && network->width == tilemap->width &&
+            network->height == tilemap->height && network->interactives == interactives->elements &&
+            network->interactive_count == interactives->count;
+}
+
+static void wire_network_compile_sources(WireCompile_t* compile){
+     WireNetwork_t* network = compile->network;
+     for(S16 i = 0; i < compile->interactives->count; i++){
+          Interactive_t* interactive = compile->interactives->elements + i;
+          if(!wire_is_source(interactive)) continue;
+          if(!wire_coord_in_map(network, interactive->coord)) continue;
+
+          S32 existing = network->source_programs[wire_tile_index(network, interactive->coord)];
+          if(existing >= 0 && network->programs[existing].valid) continue;
+
+          wire_compile_source(compile, interactive->coord);
+     }
+}
+
+bool wire_network_build(WireNetwork_t* network, TileMap_t* tilemap, ObjectArray_t<Interactive_t>* interactives,
+                        QuadTreeNode_t<Interactive_t>* interactive_qt){
+     destroy(network);
+
+     S32 tile_count = tilemap->width * tilemap->height;
+     network->source_programs = (S32*)(malloc(tile_count * sizeof(*network->source_programs)));
+     network->cluster_programs = (S32*)(malloc(tile_count * DIRECTION_COUNT * sizeof(*network->cluster_programs)));
+     if(!network->source_programs || !network->cluster_programs){
+          LOG("%s() failed to malloc wire program tables for %d tiles\n", __FUNCTION__, tile_count);
+          destroy(network);
+          return false;
+     }
+
+     for(S32 i = 0; i < tile_count; i++) network->source_programs[i] = -1;
+     for(S32 i = 0; i < tile_count * DIRECTION_COUNT; i++) network->cluster_programs[i] = -1;
+
+     network->tiles = tilemap->tiles;
+     network->width = tilemap->width;
+     network->height = tilemap->height;
+     network->interactives = interactives->elements;
+     network->interactive_count = interactives->count;
+     network->interactive_layout_hash = wire_interactive_layout_hash(interactives);
+
+     WireCompile_t compile {network, tilemap, interactives, interactive_qt};
+     wire_network_compile_sources(&compile);
+     return true;
+}
+
+void wire_network_edit(WireNetwork_t* network, TileMap_t* tilemap, ObjectArray_t<Interactive_t>* interactives,
+                       QuadTreeNode_t<Interactive_t>* interactive_qt, Coord_t coord){
+     if(!wire_network_matches(network, tilemap, interactives) ||
+        network->interactive_layout_hash != wire_interactive_layout_hash(interactives)){
+          wire_network_build(network, tilemap, interactives, interactive_qt);
+          return;
+     }
+
+     // a program only changes if it looked at the coord, programs that include a cluster program include its
+     // bounds, so they are thrown out along with it
+     bool invalidated = false;
+     for(S32 p = 0; p < network->program_count; p++){
+          WireProgram_t* program = network->programs + p;
+          if(!program->valid) continue;
+          if(coord.x < program->min.x || coord.x > program->max.x || coord.y < program->min.y || coord.y > program->max.y) continue;
+
+          program->valid = false;
+          network->live_step_count -= program->step_count;
+          invalidated = true;
+     }
+
+     if(!invalidated) return;
+
+     // the invalid programs are left behind in the step array, start over once they are most of it
+     if(network->step_count > network->live_step_count * 2 + 1024){
+          wire_network_build(network, tilemap, interactives, interactive_qt);
+          return;
+     }
+
+     S32 tile_count = network->width * network->height;
+     for(S32 i = 0; i < tile_count; i++){
+          S32* source = network->source_programs + i;
+          if(*source >= 0 && !network->programs[*source].valid) *source = -1;
+     }
+     for(S32 i = 0; i < tile_count * DIRECTION_COUNT; i++){
+          S32* cluster = network->cluster_programs + i;
+          if(*cluster >= 0 && !network->programs[*cluster].valid) *cluster = -1;
+     }
+
+     WireCompile_t compile {network, tilemap, interactives, interactive_qt};
+     wire_network_compile_sources(&compile);
+}
+
+static void wire_network_run(WireNetwork_t* network, TileMap_t* tilemap, ObjectArray_t<Interactive_t>* interactives,
+                             S32 program_index){
+     const WireProgram_t* program = network->programs + program_index;
+
+     for(S32 s = 0; s < program->step_count; s++){
+          const WireStep_t* step = network->steps + (program->first_step + s);
+          Tile_t* tile = tilemap->tiles[step->coord.y] + step->coord.x;
+          Interactive_t* interactive = (step->interactive_index >= 0) ? interactives->elements + step->interactive_index : nullptr;
+
+          tilemap_mark_flats_dirty(tilemap, step->coord);
+          tilemap_mark_changed(tilemap, step->coord);
+
+          switch(step->type){
+          default:
+               break;
+          case WIRE_STEP_POPUP:
+               interactive->popup.lift.up = !interactive->popup.lift.up;
+               if(tile->flags & TILE_FLAG_ICED){
+                    tile->flags &= ~TILE_FLAG_ICED;
+               }
+               break;
+          case WIRE_STEP_DOOR:
+               interactive->door.lift.up = !interactive->door.lift.up;
+               break;
+          case WIRE_STEP_PORTAL:
+               if(interactive->portal.has_block_inside){
+                    interactive->portal.wants_to_turn_off = true;
+               }else{
+                    interactive->portal.on = !interactive->portal.on;
+               }
+               break;
+          case WIRE_STEP_WIRE:
+               TOGGLE_BIT_FLAG(tile->flags, TILE_FLAG_WIRE_STATE);
+               break;
+          case WIRE_STEP_WIRE_CROSS:
+               interactive->wire_cross.on = !interactive->wire_cross.on;
+               break;
+          case WIRE_STEP_CLUSTER:
+          {
+               bool all_on_before = tile_flags_cluster_all_on(tile->flags);
+               tile_flags_toggle_cluster_input(&tile->flags, step->direction);
+               bool all_on_after = tile_flags_cluster_all_on(tile->flags);
+               if(all_on_before != all_on_after) wire_network_run(network, tilemap, interactives, step->program);
+          } break;
+          }
+     }
+}
+
+bool wire_network_activate(WireNetwork_t* network, TileMap_t* tilemap, ObjectArray_t<Interactive_t>* interactives,
+                           QuadTreeNode_t<Interactive_t>* interactive_qt, Coord_t coord){
+     // activating is rare enough that checking the interactives didn't move under us is cheap insurance
+     if(!wire_network_matches(network, tilemap, interactives) ||
+        network->interactive_layout_hash != wire_interactive_layout_hash(interactives)){
+          if(!wire_network_build(network, tilemap, interactives, interactive_qt)) return false;
+     }
+
+     if(!wire_coord_in_map(network, coord)) return false;
+
+     S32 program = network->source_programs[wire_tile_index(network, coord)];
+     if(program < 0 || !network->programs[program].valid) return false;
+
+     wire_network_run(network, tilemap, interactives, program);
+     return true;
+}
+
+void destroy(WireNetwork_t* network){
+     free(network->steps);
+     free(network->programs);
+     free(network->source_programs);
+     free(network->cluster_programs);
+     *network = WireNetwork_t{};
+}
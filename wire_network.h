@@ -0,0 +1,76 @@
+#pragma once
+
+#include "tile.h"
+#include "quad_tree.h"
+#include "interactive.h"
+#include "object_array.h"
+
+// the wires a source (lever, pressure plate, detector, portal) powers are compiled into a flat list of steps, in the
+// same order toggle_electricity() would have reached them, so activating only walks that list. clusters are the
+// only part that depends on state, whether they pass electricity on depends on what else is powering them, so a
+// cluster step runs its own program when it turns all the way on or off
+
+enum WireStepType_t : U8{
+     WIRE_STEP_POPUP,
+     WIRE_STEP_DOOR,
+     WIRE_STEP_PORTAL,
+     WIRE_STEP_WIRE,
+     WIRE_STEP_WIRE_CROSS,
+     WIRE_STEP_CLUSTER,
+};
+
+struct WireStep_t{
+     WireStepType_t type;
+     Direction_t direction; // the direction electricity entered a cluster from
+     Coord_t coord;
+     S16 interactive_index; // into the interactive array, -1 when there isn't one
+     S32 program; // what a cluster powers when it flips
+};
+
+struct WireProgram_t{
+     S32 first_step;
+     S32 step_count;
+
+     // every coord the program looks at, editing inside this invalidates it
+     Coord_t min;
+     Coord_t max;
+
+     bool valid;
+};
+
+struct WireNetwork_t{
+     WireStep_t* steps = nullptr;
+     S32 step_count = 0;
+     S32 step_allocated = 0;
+     S32 live_step_count = 0;
+
+     WireProgram_t* programs = nullptr;
+     S32 program_count = 0;
+     S32 program_allocated = 0;
+
+     // program index per tile, -1 when there is none
+     S32* source_programs = nullptr;
+     S32* cluster_programs = nullptr; // DIRECTION_COUNT per tile
+
+     // what the network was compiled against
+     Tile_t** tiles = nullptr;
+     S16 width = 0;
+     S16 height = 0;
+     Interactive_t* interactives = nullptr;
+     S16 interactive_count = 0;
+     U32 interactive_layout_hash = 0;
+};
+
+bool wire_network_build(WireNetwork_t* network, TileMap_t* tilemap, ObjectArray_t<Interactive_t>* interactives,
+                        QuadTreeNode_t<Interactive_t>* interactive_qt);
+
+// call after the editor changes the coord, only the programs that looked at the coord are recompiled unless the
+// interactives changed, in which case everything is
+void wire_network_edit(WireNetwork_t* network, TileMap_t* tilemap, ObjectArray_t<Interactive_t>* interactives,
+                       QuadTreeNode_t<Interactive_t>* interactive_qt, Coord_t coord);
+
+// returns false if the source has no program, the caller should fall back to walking the wires
+bool wire_network_activate(WireNetwork_t* network, TileMap_t* tilemap, ObjectArray_t<Interactive_t>* interactives,
+                           QuadTreeNode_t<Interactive_t>* interactive_qt, Coord_t coord);
+
+void destroy(WireNetwork_t* network);
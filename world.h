@@ -10,6 +10,28 @@
 #include "demo.h"
 #include "raw.h"
 #include "camera.h"
+#include "wire_network.h"
+#include "entangle.h"
+#include "block_sleep.h"
+#include "world_hash.h"
+
+// masses only change when blocks or players move, stack or get cut, so while pushes are being resolved the answer
+// for a block is the same every time we ask. entries are stamped with the generation they were computed in
+struct BlockMassCacheEntry_t{
+     U32 generation;
+     S16 mass;
+};
+
+struct BlockMassCache_t{
+     BlockMassCacheEntry_t* stack_masses = nullptr;     // one per block
+     BlockMassCacheEntry_t* direction_masses = nullptr; // DIRECTION_COUNT * 2 per block, with and without requiring ice
+     S16 allocated = 0;
+     U32 generation = 0;
+     bool active = false;
+
+     U64 hits = 0;
+     U64 misses = 0;
+};
 
 struct World_t{
      TileMap_t tilemap = {};
@@ -21,6 +43,17 @@ struct World_t{
      QuadTreeNode_t<Interactive_t>* interactive_qt = nullptr;
      QuadTreeNode_t<Block_t>* block_qt = nullptr;
 
+     // set when world_snapshot_restore() throws a tree out, see world_refresh_quad_trees()
+     bool interactive_qt_stale = false;
+     bool block_qt_stale = false;
+
+     WireNetwork_t wire_network = {};
+     EntangleTable_t block_entangle = {};
+     BlockMassCache_t block_mass_cache = {};
+     BlockSleep_t block_sleep = {};
+
+     WorldHash_t hash = {};
+
      S32 clone_instance = 0;
 };
 
@@ -115,9 +148,16 @@ struct LogMapNumberResult_t{
 void sort_blocks_by_ascending_height(Block_t** blocks, S16 block_count);
 void sort_blocks_by_descending_height(Block_t** blocks, S16 block_count);
 
+// finds content/<3 digit map number>*.bm
+bool map_number_filepath(S32 map_number, char* filepath, size_t size);
 LogMapNumberResult_t load_map_number(S32 map_number, Coord_t* player_start, World_t* world);
+LogMapNumberResult_t load_map_number_map(S16 map_number, World_t* world, Undo_t* undo, Coord_t* player_start,
+                                         PlayerAction_t* player_action, Camera_t* camera, bool* tags);
 void reset_map(Coord_t player_start, World_t* world, Undo_t* undo, Camera_t* camera);
 
+// frees everything the world owns, leaving it empty and ready to load another map into
+void destroy(World_t* world);
+
 void activate(World_t* world, Coord_t coord);
 
 MovePlayerThroughWorldResult_t move_player_through_world(Position_t player_pos, Vec_t player_vel, Vec_t player_pos_delta,
@@ -149,6 +189,9 @@ void describe_coord(Coord_t coord, World_t* world);
 bool test_map_end_state(World_t* world, Demo_t* demo);
 
 S16 get_block_index(World_t* world, Block_t* block);
+
+// rebuilds the quad trees a snapshot restore left out of date
+void world_refresh_quad_trees(World_t* world);
 bool setup_default_room(World_t* world);
 void reset_tilemap_light(World_t* world);
 
@@ -158,6 +201,13 @@ void get_block_stack(World_t* world, Block_t* block, BlockList_t* block_list, S8
 S16 get_block_stack_mass(World_t* world, Block_t* block);
 S16 get_block_mass_in_direction(World_t* world, Block_t* block, Direction_t direction, bool require_on_ice = true);
 
+// between begin and end, stack masses and masses in a direction are remembered per block, call invalidate after
+// anything that moves, cuts or restacks blocks or players
+void block_mass_cache_begin_pass(World_t* world);
+void block_mass_cache_invalidate(World_t* world);
+void block_mass_cache_end_pass(World_t* world);
+void destroy(BlockMassCache_t* cache);
+
 F32 momentum_term(F32 mass, F32 vel);
 F32 momentum_term(TransferMomentum_t* transfer_momentum);
 TransferMomentum_t get_block_momentum(World_t* world, Block_t* block, Direction_t direction);
@@ -0,0 +1,295 @@
+#include "world_hash.h"
+#include "world.h"
+#include "utils.h"
+#include "log.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+// arbitrary, just different per kind of thing so a tile and a block with the same index and state don't cancel
+#define WORLD_HASH_TILE_SEED 0x9e3779b97f4a7c15ULL
+#define WORLD_HASH_BLOCK_SEED 0xc2b2ae3d27d4eb4fULL
+#define WORLD_HASH_INTERACTIVE_SEED 0x165667b19e3779f9ULL
+#define WORLD_HASH_PLAYER_SEED 0x27d4eb2f165667c5ULL
+
+// splitmix64's finalizer. running the index and state through it stands in for the usual table of random keys,
+// which would need an entry for every possible state of every tile, block, interactive and player
+U64 world_hash_mix(U64 x){
+     x ^= x >> 30;
+     x *= 0xbf58476d1ce4e5b9ULL;
+     x ^= x >> 27;
+     x *= 0x94d049bb133111ebULL;
+     x ^= x >> 31;
+     return x;
+}
+
+static U64 hash_key(U64 seed, S32 index, U64 state_a, U64 state_b = 0){
+     U64 key = world_hash_mix(seed ^ (U64)(U32)(index));
+     key = world_hash_mix(key ^ state_a);
+     return world_hash_mix(key ^ state_b);
+}
+
+static U64 tile_key(S32 index, const Tile_t* tile){
+     return hash_key(WORLD_HASH_TILE_SEED, index, tile->flags);
+}
+
+static U64 block_key(S32 index, const Block_t* block){
+     U64 pos = (U64)(U16)(block->pos.pixel.x) | ((U64)(U16)(block->pos.pixel.y) << 16) |
+               ((U64)(U8)(block->pos.z) << 32);
+     U64 state = (U64)(U8)(block->element) | ((U64)(U8)(block->cut) << 8) |
+                 ((U64)(U16)(block->entangle_index) << 16);
+     return hash_key(WORLD_HASH_BLOCK_SEED, index, pos, state);
+}
+
+static U64 interactive_key(S32 index, const Interactive_t* interactive){
+     U64 state = 0;
+     switch(interactive->type){
+     default:
+          break;
+     case INTERACTIVE_TYPE_PRESSURE_PLATE:
+          state = (U64)(interactive->pressure_plate.down) | ((U64)(interactive->pressure_plate.iced_under) << 1);
+          break;
+     case INTERACTIVE_TYPE_LIGHT_DETECTOR:
+     case INTERACTIVE_TYPE_ICE_DETECTOR:
+          state = (U64)(interactive->detector.on);
+          break;
+     case INTERACTIVE_TYPE_POPUP:
+          state = (U64)(interactive->popup.lift.up) | ((U64)(interactive->popup.iced) << 1) |
+                  ((U64)(interactive->popup.lift.ticks) << 8);
+          break;
+     case INTERACTIVE_TYPE_DOOR:
+          state = (U64)(interactive->door.lift.up) | ((U64)(interactive->door.lift.ticks) << 8);
+          break;
+     case INTERACTIVE_TYPE_LEVER:
+          state = (U64)(U8)(interactive->lever.activated_from) | ((U64)(U8)(interactive->lever.ticks) << 8);
+          break;
+     case INTERACTIVE_TYPE_PORTAL:
+          state = (U64)(interactive->portal.on);
+          break;
+     case INTERACTIVE_TYPE_WIRE_CROSS:
+          state = (U64)(interactive->wire_cross.on);
+          break;
+     }
+
+     U64 identity = (U64)(U8)(interactive->type) | ((U64)(U16)(interactive->coord.x) << 16) |
+                    ((U64)(U16)(interactive->coord.y) << 32);
+     return hash_key(WORLD_HASH_INTERACTIVE_SEED, index, identity, state);
+}
+
+static U64 player_key(S32 index, const Player_t* player){
+     U64 pos = (U64)(U16)(player->pos.pixel.x) | ((U64)(U16)(player->pos.pixel.y) << 16) |
+               ((U64)(U8)(player->pos.z) << 32);
+     return hash_key(WORLD_HASH_PLAYER_SEED, index, pos, (U64)(U8)(player->face));
+}
+
+static U64 hash_tiles(TileMap_t* tilemap){
+     U64 value = 0;
+     for(S16 y = 0; y < tilemap->height; y++){
+          for(S16 x = 0; x < tilemap->width; x++){
+               value ^= tile_key((S32)(y) * tilemap->width + x, tilemap->tiles[y] + x);
+          }
+     }
+     return value;
+}
+
+static U64 hash_blocks(ObjectArray_t<Block_t>* blocks){
+     U64 value = 0;
+     for(S16 i = 0; i < blocks->count; i++) value ^= block_key(i, blocks->elements + i);
+     return value;
+}
+
+static U64 hash_interactives(ObjectArray_t<Interactive_t>* interactives){
+     U64 value = 0;
+     for(S16 i = 0; i < interactives->count; i++) value ^= interactive_key(i, interactives->elements + i);
+     return value;
+}
+
+static U64 hash_players(ObjectArray_t<Player_t>* players){
+     U64 value = 0;
+     for(S16 i = 0; i < players->count; i++) value ^= player_key(i, players->elements + i);
+     return value;
+}
+
+// xors the entry's old key out of value and its new one in
+static void rekey(U64* value, U64* entry, U64 key){
+     *value ^= *entry ^ key;
+     *entry = key;
+}
+
+template <typename T>
+static bool fit_keys(ObjectArray_t<U64>* keys, ObjectArray_t<T>* array){
+     if(keys->count == array->count) return true;
+     if(array->count == 0){
+          destroy(keys);
+          return true;
+     }
+     return resize(keys, array->count);
+}
+
+static void rekey_blocks(WorldHash_t* hash, World_t* world){
+     if(!fit_keys(&hash->block_keys, &world->blocks)){
+          hash->valid = false;
+          return;
+     }
+     hash->block_value = 0;
+     for(S16 i = 0; i < world->blocks.count; i++){
+          hash->block_keys.elements[i] = block_key(i, world->blocks.elements + i);
+          hash->block_value ^= hash->block_keys.elements[i];
+     }
+     hash->blocks_reordered = false;
+}
+
+static void rekey_players(WorldHash_t* hash, World_t* world){
+     if(!fit_keys(&hash->player_keys, &world->players)){
+          hash->valid = false;
+          return;
+     }
+     hash->player_value = 0;
+     for(S16 i = 0; i < world->players.count; i++){
+          hash->player_keys.elements[i] = player_key(i, world->players.elements + i);
+          hash->player_value ^= hash->player_keys.elements[i];
+     }
+}
+
+static void rekey_all(WorldHash_t* hash, World_t* world){
+     S32 tile_count = (S32)(world->tilemap.width) * (S32)(world->tilemap.height);
+     if(tile_count != hash->tile_key_count){
+          U64* tile_keys = (U64*)(realloc(hash->tile_keys, (size_t)(tile_count) * sizeof(*tile_keys)));
+          if(!tile_keys && tile_count > 0){
+               LOG("%s() failed to realloc %d tile keys\n", __FUNCTION__, tile_count);
+               return;
+          }
+          hash->tile_keys = tile_keys;
+          hash->tile_key_count = tile_count;
+     }
+
+     if(!fit_keys(&hash->interactive_keys, &world->interactives)) return;
+
+     hash->tile_value = 0;
+     for(S16 y = 0; y < world->tilemap.height; y++){
+          for(S16 x = 0; x < world->tilemap.width; x++){
+               S32 index = (S32)(y) * world->tilemap.width + x;
+               hash->tile_keys[index] = tile_key(index, world->tilemap.tiles[y] + x);
+               hash->tile_value ^= hash->tile_keys[index];
+          }
+     }
+
+     hash->interactive_value = 0;
+     for(S16 i = 0; i < world->interactives.count; i++){
+          hash->interactive_keys.elements[i] = interactive_key(i, world->interactives.elements + i);
+          hash->interactive_value ^= hash->interactive_keys.elements[i];
+     }
+
+     hash->valid = true;
+     rekey_blocks(hash, world);
+     rekey_players(hash, world);
+     tilemap_clear_changes(&world->tilemap);
+}
+
+U64 world_hash(World_t* world){
+     WorldHash_t* hash = &world->hash;
+     if(!hash->valid) rekey_all(hash, world);
+     hash->value = hash->tile_value ^ hash->block_value ^ hash->interactive_value ^ hash->player_value;
+     return hash->value;
+}
+
+U64 world_hash_map_state(World_t* world){
+     return world_hash(world) ^ world->hash.player_value;
+}
+
+U64 world_hash_map_state(TileMap_t* tilemap, ObjectArray_t<Block_t>* blocks, ObjectArray_t<Interactive_t>* interactives){
+     return hash_tiles(tilemap) ^ hash_blocks(blocks) ^ hash_interactives(interactives);
+}
+
+void world_hash_update(World_t* world){
+     WorldHash_t* hash = &world->hash;
+     if(!hash->valid){
+          world_hash(world);
+          return;
+     }
+
+     for(S32 i = 0; i < world->tilemap.changed_count; i++){
+          Coord_t coord = world->tilemap.changed_coords[i];
+          S32 index = (S32)(coord.y) * world->tilemap.width + coord.x;
+          rekey(&hash->tile_value, hash->tile_keys + index, tile_key(index, world->tilemap.tiles[coord.y] + coord.x));
+
+          Interactive_t* interactive = quad_tree_interactive_find_at(world->interactive_qt, coord);
+          if(interactive){
+               S16 interactive_index = (S16)(interactive - world->interactives.elements);
+               rekey(&hash->interactive_value, hash->interactive_keys.elements + interactive_index,
+                     interactive_key(interactive_index, interactive));
+          }
+     }
+     tilemap_clear_changes(&world->tilemap);
+
+     // blocks were rekeyed as they changed, only adding or removing one leaves them to be redone here
+     if(hash->blocks_reordered || hash->block_keys.count != world->blocks.count) rekey_blocks(hash, world);
+
+     // there are only ever a couple of players
+     rekey_players(hash, world);
+
+     world_hash(world);
+}
+
+void world_hash_block_changed(World_t* world, Block_t* block){
+     WorldHash_t* hash = &world->hash;
+     if(!hash->valid || hash->blocks_reordered) return;
+
+     S16 index = (S16)(block - world->blocks.elements);
+     if(index >= hash->block_keys.count){
+          hash->blocks_reordered = true;
+          return;
+     }
+
+     rekey(&hash->block_value, hash->block_keys.elements + index, block_key(index, block));
+}
+
+void world_hash_blocks_reordered(World_t* world){
+     world->hash.blocks_reordered = true;
+}
+
+void world_hash_invalidate(World_t* world){
+     world->hash.valid = false;
+     tilemap_clear_changes(&world->tilemap);
+}
+
+bool world_hash_check(World_t* world){
+     WorldHash_t* hash = &world->hash;
+     if(!hash->valid) return true;
+
+     U64 tile_value = hash_tiles(&world->tilemap);
+     U64 block_value = hash_blocks(&world->blocks);
+     U64 interactive_value = hash_interactives(&world->interactives);
+     U64 player_value = hash_players(&world->players);
+
+     bool matches = true;
+     if(tile_value != hash->tile_value){
+          LOG("world hash tiles are 0x%016" PRIx64 " but should be 0x%016" PRIx64 "\n", hash->tile_value, tile_value);
+          matches = false;
+     }
+     if(block_value != hash->block_value){
+          LOG("world hash blocks are 0x%016" PRIx64 " but should be 0x%016" PRIx64 "\n", hash->block_value, block_value);
+          matches = false;
+     }
+     if(interactive_value != hash->interactive_value){
+          LOG("world hash interactives are 0x%016" PRIx64 " but should be 0x%016" PRIx64 "\n", hash->interactive_value,
+              interactive_value);
+          matches = false;
+     }
+     if(player_value != hash->player_value){
+          LOG("world hash players are 0x%016" PRIx64 " but should be 0x%016" PRIx64 "\n", hash->player_value, player_value);
+          matches = false;
+     }
+
+     // start over from the right answer so one missed change doesn't get logged every frame after it
+     if(!matches) world_hash_invalidate(world);
+     return matches;
+}
+
+void destroy(WorldHash_t* hash){
+     free(hash->tile_keys);
+     destroy(&hash->block_keys);
+     destroy(&hash->interactive_keys);
+     destroy(&hash->player_keys);
+     *hash = WorldHash_t{};
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "types.h"
+#include "object_array.h"
+
+struct World_t;
+struct TileMap_t;
+struct Block_t;
+struct Interactive_t;
+
+// a 64 bit hash of everything that makes two worlds the same puzzle position: tile flags, block positions, elements
+// and cuts, interactive states and player positions and faces. it is zobrist style, every tile, block, interactive
+// and player contributes a pseudo random key made from its index and state and the hash is the xor of all of them,
+// so when one of them changes its old key is xored out and its new one xored in, nothing gets rescanned.
+//
+// blocks are rekeyed where they change, through world_hash_block_changed(). world_step() catches the rest up at the
+// end of every step: the tiles tilemap_mark_changed() listed (and the interactives on them) and the players. anything
+// that rewrites the world wholesale calls world_hash_invalidate() and the next update recomputes it all
+
+struct WorldHash_t{
+     U64 value = 0;
+
+     // the parts value is made of, the players are kept apart so the map state can be compared on its own
+     U64 tile_value = 0;
+     U64 block_value = 0;
+     U64 interactive_value = 0;
+     U64 player_value = 0;
+
+     // the key each tile, block, interactive and player is contributing right now
+     U64* tile_keys = nullptr;
+     S32 tile_key_count = 0;
+     ObjectArray_t<U64> block_keys = {};
+     ObjectArray_t<U64> interactive_keys = {};
+     ObjectArray_t<U64> player_keys = {};
+
+     bool valid = false;
+     bool blocks_reordered = false;
+};
+
+U64 world_hash(World_t* world);
+U64 world_hash_map_state(World_t* world); // world_hash() without the players
+
+// the same value world_hash_map_state() would give for a world made of these, without needing one
+U64 world_hash_map_state(TileMap_t* tilemap, ObjectArray_t<Block_t>* blocks, ObjectArray_t<Interactive_t>* interactives);
+
+// the mixing function the keys are made with, for anything that wants to fold more state into a world hash
+U64 world_hash_mix(U64 x);
+
+// call once at the end of a step
+void world_hash_update(World_t* world);
+
+// call whenever a block's position, element, cut or entangle index changes. removing a block moves the last block
+// into its place, so that is world_hash_blocks_reordered() instead
+void world_hash_block_changed(World_t* world, Block_t* block);
+void world_hash_blocks_reordered(World_t* world);
+
+// call after anything rewrites the world wholesale (loading, undo, snapshot restores, the editor)
+void world_hash_invalidate(World_t* world);
+
+// recomputes the hash from scratch and logs which parts the incremental hash got wrong, then resyncs it
+bool world_hash_check(World_t* world);
+
+void destroy(WorldHash_t* hash);
@@ -0,0 +1,155 @@
+#include "world_snapshot.h"
+#include "world.h"
+#include "tags.h"
+#include "log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// every section starts on an 8 byte boundary
+static U32 snapshot_section_size(U32 size){
+     return (size + 7u) & ~7u;
+}
+
+static U32 snapshot_size(World_t* world){
+     U32 size = 0;
+     size += snapshot_section_size((U32)(world->tilemap.width) * (U32)(world->tilemap.height) * sizeof(Tile_t));
+     size += snapshot_section_size((U32)(world->players.count) * sizeof(Player_t));
+     size += snapshot_section_size((U32)(world->blocks.count) * sizeof(Block_t));
+     size += snapshot_section_size((U32)(world->interactives.count) * sizeof(Interactive_t));
+     size += snapshot_section_size(sizeof(world->arrows));
+     size += snapshot_section_size(TAG_COUNT * sizeof(bool));
+     return size;
+}
+
+// the padding is zeroed so two captures of the same state compare equal byte for byte
+static void snapshot_write(U8** cursor, const void* src, U32 size){
+     U32 section_size = snapshot_section_size(size);
+     if(size) memcpy(*cursor, src, size);
+     memset(*cursor + size, 0, section_size - size);
+     *cursor += section_size;
+}
+
+static void snapshot_read(const U8** cursor, void* dst, U32 size){
+     if(size) memcpy(dst, *cursor, size);
+     *cursor += snapshot_section_size(size);
+}
+
+// resizes the array to count without caring what ends up in it, it is about to be overwritten
+template <typename T>
+static bool snapshot_fit(ObjectArray_t<T>* array, S16 count){
+     if(array->count == count) return true;
+     if(count == 0){
+          destroy(array);
+          return true;
+     }
+     return resize(array, count);
+}
+
+bool world_snapshot_capture(WorldSnapshot_t* snapshot, World_t* world){
+     U32 size = snapshot_size(world);
+     if(size > snapshot->allocated){
+          auto* buffer = (U8*)(realloc(snapshot->buffer, size));
+          if(!buffer){
+               LOG("%s() failed to realloc %u bytes\n", __FUNCTION__, size);
+               return false;
+          }
+
+          snapshot->buffer = buffer;
+          snapshot->allocated = size;
+     }
+
+     snapshot->size = size;
+     snapshot->tilemap_width = world->tilemap.width;
+     snapshot->tilemap_height = world->tilemap.height;
+     snapshot->player_count = world->players.count;
+     snapshot->block_count = world->blocks.count;
+     snapshot->interactive_count = world->interactives.count;
+     snapshot->clone_instance = world->clone_instance;
+
+     U8* cursor = snapshot->buffer;
+
+     // rows are allocated separately, but each one is contiguous
+     U32 row_size = (U32)(world->tilemap.width) * sizeof(Tile_t);
+     for(S16 y = 0; y < world->tilemap.height; y++){
+          memcpy(cursor, world->tilemap.tiles[y], row_size);
+          cursor += row_size;
+     }
+     U32 tiles_size = row_size * (U32)(world->tilemap.height);
+     memset(cursor, 0, snapshot_section_size(tiles_size) - tiles_size);
+     cursor = snapshot->buffer + snapshot_section_size(tiles_size);
+
+     snapshot_write(&cursor, world->players.elements, (U32)(world->players.count) * sizeof(Player_t));
+     snapshot_write(&cursor, world->blocks.elements, (U32)(world->blocks.count) * sizeof(Block_t));
+     snapshot_write(&cursor, world->interactives.elements, (U32)(world->interactives.count) * sizeof(Interactive_t));
+     snapshot_write(&cursor, &world->arrows, sizeof(world->arrows));
+     snapshot_write(&cursor, get_global_tags(), TAG_COUNT * sizeof(bool));
+     return true;
+}
+
+bool world_snapshot_restore(WorldSnapshot_t* snapshot, World_t* world){
+     if(!snapshot->buffer) return false;
+
+     if(world->tilemap.width != snapshot->tilemap_width || world->tilemap.height != snapshot->tilemap_height){
+          destroy(&world->tilemap);
+          if(!init(&world->tilemap, snapshot->tilemap_width, snapshot->tilemap_height)){
+               LOG("%s() failed to init %dx%d tilemap\n", __FUNCTION__, snapshot->tilemap_width, snapshot->tilemap_height);
+               return false;
+          }
+     }
+
+     Interactive_t* interactives_before = world->interactives.elements;
+     S16 interactive_count_before = world->interactives.count;
+
+     if(!snapshot_fit(&world->players, snapshot->player_count)) return false;
+     if(!snapshot_fit(&world->blocks, snapshot->block_count)) return false;
+     if(!snapshot_fit(&world->interactives, snapshot->interactive_count)) return false;
+
+     const U8* cursor = snapshot->buffer;
+
+     U32 row_size = (U32)(world->tilemap.width) * sizeof(Tile_t);
+     for(S16 y = 0; y < world->tilemap.height; y++){
+          memcpy(world->tilemap.tiles[y], cursor, row_size);
+          cursor += row_size;
+     }
+     cursor = snapshot->buffer + snapshot_section_size(row_size * (U32)(world->tilemap.height));
+
+     snapshot_read(&cursor, world->players.elements, (U32)(world->players.count) * sizeof(Player_t));
+     snapshot_read(&cursor, world->blocks.elements, (U32)(world->blocks.count) * sizeof(Block_t));
+
+     // interactives never move while the world steps, so unless the restore moved them the tree can stay
+     bool interactives_moved = world->interactives.elements != interactives_before ||
+                               world->interactives.count != interactive_count_before;
+     const auto* snapshot_interactives = (const Interactive_t*)(cursor);
+     for(S16 i = 0; i < world->interactives.count && !interactives_moved; i++){
+          if(world->interactives.elements[i].coord != snapshot_interactives[i].coord) interactives_moved = true;
+     }
+     snapshot_read(&cursor, world->interactives.elements, (U32)(world->interactives.count) * sizeof(Interactive_t));
+
+     snapshot_read(&cursor, &world->arrows, sizeof(world->arrows));
+     snapshot_read(&cursor, get_global_tags(), TAG_COUNT * sizeof(bool));
+
+     world->clone_instance = snapshot->clone_instance;
+
+     quad_tree_free(world->block_qt);
+     world->block_qt = nullptr;
+     world->block_qt_stale = true;
+
+     if(interactives_moved){
+          quad_tree_free(world->interactive_qt);
+          world->interactive_qt = nullptr;
+          world->interactive_qt_stale = true;
+     }
+
+     // portals and wires may have switched, and whatever draws the floor has to redraw it
+     tilemap_invalidate_portal_exits(&world->tilemap);
+     tilemap_mark_all_flats_dirty(&world->tilemap);
+     block_sleep_wake_all(world);
+     world_hash_invalidate(world);
+     return true;
+}
+
+void destroy(WorldSnapshot_t* snapshot){
+     free(snapshot->buffer);
+     *snapshot = WorldSnapshot_t{};
+}
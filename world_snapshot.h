@@ -0,0 +1,31 @@
+#pragma once
+
+#include "types.h"
+
+struct World_t;
+
+// the whole simulation state of a world (tiles, players, blocks, interactives, arrows and the global tags) packed
+// back to back in one buffer. the buffer is only reallocated when the world has grown since the last capture, so
+// capturing and restoring the same map over and over is a handful of memcpy()s, cheap enough to do every frame for
+// keyframes, solvers and fuzzers.
+//
+// caches that world_step() rebuilds or checks on its own (the entangle table, wire network, mass cache, block sleep
+// and portal exits) are not captured. the quad trees aren't either: restoring frees whichever of them the restore
+// made out of date and world_refresh_quad_trees() builds them again, which world_step() does before it starts
+
+struct WorldSnapshot_t{
+     U8* buffer = nullptr;
+     U32 size = 0;
+     U32 allocated = 0;
+
+     S16 tilemap_width = 0;
+     S16 tilemap_height = 0;
+     S16 player_count = 0;
+     S16 block_count = 0;
+     S16 interactive_count = 0;
+     S32 clone_instance = 0;
+};
+
+bool world_snapshot_capture(WorldSnapshot_t* snapshot, World_t* world);
+bool world_snapshot_restore(WorldSnapshot_t* snapshot, World_t* world);
+void destroy(WorldSnapshot_t* snapshot);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "world.h"
+#include "demo.h"
+#include "undo.h"
+#include "defines.h"
+
+struct JobSystem_t;
+
+// state that lives across world_step() calls but isn't part of the world itself
+struct FrameContext_t{
+     F32 dt = FRAME_TIME;
+     Undo_t* undo = nullptr; // activating, shooting, pushing and undoing all commit to this
+
+     // set when a player dies or leaves the map, it is up to the caller to reload the map once reset_timer reaches
+     // RESET_TIME. the rest of the time reset_timer counts down to 0, the game fades the screen in with it
+     bool resetting = false;
+     F32 reset_timer = 1.0f;
+
+     S8 collision_attempts = 0; // how many collision passes the last step took
+
+     // compare the incremental world hash against a full recompute after every step, debug builds turn it on
+     bool check_hash = false;
+
+     // let resting blocks sleep through the movement passes, turning it off steps every block every frame, which has
+     // to come out the same
+     bool block_sleep = true;
+
+     // when set, passes that only read the world are split across its workers. their results are used in block order,
+     // so the step comes out the same as without
+     JobSystem_t* jobs = nullptr;
+};
+
+// advances the world by one frame of context->dt. this is the whole simulation: it touches neither SDL nor GL, so
+// the game, the headless runner and anything else built against libgame_sim all step the world the same way.
+// a frame runs world_frame_begin(), plays the frame's input, then world_step() and world_frame_end(). trees a
+// snapshot restore threw out are rebuilt first
+void world_step(World_t* world, const PlayerAction_t* player_action, FrameContext_t* context);
+
+// rebuilds world->block_qt and lets go of last frame's activate and refacing, before the frame's input is played
+void world_frame_begin(World_t* world, PlayerAction_t* player_action);
+
+// clears the undo the step just did. true once a reset has run out its timer, resetting is cleared and it is up to
+// the caller to reload the map
+bool world_frame_end(PlayerAction_t* player_action, FrameContext_t* context);